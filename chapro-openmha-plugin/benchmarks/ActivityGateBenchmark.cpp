@@ -0,0 +1,84 @@
+#include "benchmarks.h"
+#include <hearing-aid/ActivityGate.h>
+#include <hearing-aid/ControlRateCompressor.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace hearing_aid::benchmarks {
+namespace {
+constexpr auto fragmentSize = 64;
+constexpr auto bandCount = 8;
+
+class BandCount : public SuperSignalProcessor {
+public:
+    void feedbackCancelInput(real_signal_type, real_signal_type, int) override {}
+    void compressInput(real_signal_type, real_signal_type, int) override {}
+    void compressChannel(complex_signal_type, complex_signal_type, int) override {}
+    void compressOutput(real_signal_type, real_signal_type, int) override {}
+    void feedbackCancelOutput(real_signal_type, int) override {}
+
+    int chunkSize() override {
+        return fragmentSize;
+    }
+
+    int channels() override {
+        return bandCount;
+    }
+};
+
+std::shared_ptr<SuperSignalProcessor> perSampleCompressor() {
+    ControlRateCompressor::Parameters p{};
+    p.compressionRatios.assign(bandCount, 2);
+    p.kneepoints.assign(bandCount, 40);
+    p.kneepointGains.assign(bandCount, 20);
+    p.broadbandOutputLimitingThresholds.assign(bandCount, 100);
+    p.broadband = {0, 105, 10, 105};
+    p.attack = 5;
+    p.release = 50;
+    p.broadbandAttack = 1;
+    p.broadbandRelease = 50;
+    p.sampleRate = 44100;
+    p.fullScaleLevel = 119;
+    p.controlInterval = 1;
+    return std::make_shared<ControlRateCompressor>(
+        std::make_shared<BandCount>(),
+        p
+    );
+}
+}
+
+// Channel compression cost on a near-silent input (about 30 dB SPL)
+// with and without the activity gate at several update intervals.
+void activityGate() {
+    constexpr auto fragments = 20000;
+    auto input = noise(fragmentSize, 1e-4F);
+    const auto bands = noise(2 * fragmentSize * bandCount, 1e-4F);
+    std::vector<float> buffer(bands.size());
+    std::cout << std::setw(10) << "update"
+        << std::setw(24) << "ns per fragment"
+        << std::setw(10) << "saving" << '\n';
+    double ungated = 0;
+    for (auto update : {0, 1, 2, 4, 8, 16}) {
+        auto processor = perSampleCompressor();
+        if (update > 0)
+            processor = std::make_shared<ActivityGate>(
+                std::move(processor),
+                ActivityGate::Parameters{50, 119, 1, update}
+            );
+        const auto start = clock_type::now();
+        for (int i = 0; i < fragments; ++i) {
+            buffer = bands;
+            processor->feedbackCancelInput(input, input, fragmentSize);
+            processor->compressChannel(buffer, buffer, fragmentSize);
+        }
+        const auto cost = nanoseconds(clock_type::now() - start) / fragments;
+        if (update == 0)
+            ungated = cost;
+        std::cout << std::setw(10) << (update > 0 ? std::to_string(update) : "off")
+            << std::setw(24) << std::fixed << std::setprecision(1) << cost
+            << std::setw(9) << std::setprecision(0)
+            << 100 * (1 - cost / ungated) << "%\n";
+    }
+}
+}
@@ -0,0 +1,158 @@
+#include "benchmarks.h"
+#include <hearing-aid/BandParallelCompressor.h>
+#include <hearing-aid/ControlRateCompressor.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace hearing_aid::benchmarks {
+namespace {
+class BandCount : public SuperSignalProcessor {
+    int chunkSize_;
+    int channels_;
+public:
+    BandCount(int chunkSize, int channels) :
+        chunkSize_{chunkSize},
+        channels_{channels} {}
+
+    void feedbackCancelInput(real_signal_type, real_signal_type, int) override {}
+    void compressInput(real_signal_type, real_signal_type, int) override {}
+    void compressChannel(complex_signal_type, complex_signal_type, int) override {}
+    void compressOutput(real_signal_type, real_signal_type, int) override {}
+    void feedbackCancelOutput(real_signal_type, int) override {}
+
+    int chunkSize() override {
+        return chunkSize_;
+    }
+
+    int channels() override {
+        return channels_;
+    }
+};
+
+// Per-sample gain updates: the most expensive compressChannel the tree has.
+std::shared_ptr<ControlRateCompressor> compressor(int chunkSize, int channels) {
+    ControlRateCompressor::Parameters p{};
+    p.compressionRatios.assign(channels, 2);
+    p.kneepoints.assign(channels, 40);
+    p.kneepointGains.assign(channels, 20);
+    p.broadbandOutputLimitingThresholds.assign(channels, 100);
+    p.broadband = {0, 105, 10, 105};
+    p.attack = 5;
+    p.release = 50;
+    p.broadbandAttack = 1;
+    p.broadbandRelease = 50;
+    p.sampleRate = 44100;
+    p.fullScaleLevel = 119;
+    p.controlInterval = 1;
+    return std::make_shared<ControlRateCompressor>(
+        std::make_shared<BandCount>(chunkSize, channels),
+        p
+    );
+}
+
+double nanosecondsPerFragment(SuperSignalProcessor &s, int chunkSize) {
+    const auto input = noise(2 * chunkSize * s.channels(), 0.1F);
+    std::vector<float> buffer(input.size());
+    const auto fragments = 2000000 / (chunkSize * s.channels()) + 100;
+    const auto start = clock_type::now();
+    for (int i = 0; i < fragments; ++i) {
+        buffer = input;
+        s.compressChannel(buffer, buffer, chunkSize);
+    }
+    return nanoseconds(clock_type::now() - start) / fragments;
+}
+
+// Calls compressChannel once per fragment period, as an audio callback
+// does, and times only the calls, so workers that park between fragments
+// pay for being woken.
+double pacedNanosecondsPerFragment(
+    SuperSignalProcessor &s,
+    int chunkSize,
+    std::chrono::nanoseconds period
+) {
+    const auto input = noise(2 * chunkSize * s.channels(), 0.1F);
+    std::vector<float> buffer(input.size());
+    constexpr auto fragments = 1000;
+    double total = 0;
+    auto next = clock_type::now();
+    for (int i = 0; i < fragments; ++i) {
+        next += period;
+        std::this_thread::sleep_until(next);
+        buffer = input;
+        const auto start = clock_type::now();
+        s.compressChannel(buffer, buffer, chunkSize);
+        total += nanoseconds(clock_type::now() - start);
+    }
+    return total / fragments;
+}
+}
+
+// Compares serial compressChannel against the band-parallel decorator so
+// the work threshold can be chosen where the speedup crosses one.
+void bandParallelCompressor() {
+    std::cout << std::setw(8) << "chunk"
+        << std::setw(10) << "channels"
+        << std::setw(14) << "band samples"
+        << std::setw(14) << "serial ns"
+        << std::setw(10) << "threads"
+        << std::setw(14) << "parallel ns"
+        << std::setw(10) << "speedup" << '\n';
+    for (auto chunkSize : {8, 32, 128, 512})
+        for (auto channels : {8, 32}) {
+            auto serial = compressor(chunkSize, channels);
+            const auto serialCost = nanosecondsPerFragment(*serial, chunkSize);
+            for (auto threads : {2, 4}) {
+                BandParallelCompressor parallel{
+                    compressor(chunkSize, channels),
+                    {{}, threads, 0, true}
+                };
+                const auto cost = nanosecondsPerFragment(parallel, chunkSize);
+                std::cout << std::setw(8) << chunkSize
+                    << std::setw(10) << channels
+                    << std::setw(14) << chunkSize * channels
+                    << std::setw(14) << std::fixed << std::setprecision(0)
+                    << serialCost
+                    << std::setw(10) << threads
+                    << std::setw(14) << cost
+                    << std::setw(10) << std::setprecision(2)
+                    << serialCost / cost << '\n';
+            }
+        }
+
+    std::cout << "\npaced at 44.1 kHz, " << Parking::defaultSpin.count()
+        << " us spin (parked) against one fragment period of spin\n"
+        << std::setw(8) << "chunk"
+        << std::setw(10) << "channels"
+        << std::setw(14) << "serial ns"
+        << std::setw(14) << "parked ns"
+        << std::setw(14) << "spinning ns" << '\n';
+    constexpr auto channels = 8;
+    constexpr auto threads = 2;
+    for (auto chunkSize : {32, 128}) {
+        const auto period =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::duration<double>{chunkSize / 44100.}
+            );
+        auto serial = compressor(chunkSize, channels);
+        BandParallelCompressor parked{
+            compressor(chunkSize, channels),
+            {{}, threads, 0, true}
+        };
+        BandParallelCompressor spinning{
+            compressor(chunkSize, channels),
+            {{}, threads, 0, true, period}
+        };
+        std::cout << std::setw(8) << chunkSize
+            << std::setw(10) << channels
+            << std::setw(14) << std::fixed << std::setprecision(0)
+            << pacedNanosecondsPerFragment(*serial, chunkSize, period)
+            << std::setw(14)
+            << pacedNanosecondsPerFragment(parked, chunkSize, period)
+            << std::setw(14)
+            << pacedNanosecondsPerFragment(spinning, chunkSize, period)
+            << '\n';
+    }
+}
+}
@@ -0,0 +1,83 @@
+#include "benchmarks.h"
+#include <hearing-aid/ControlRateCompressor.h>
+#include <iomanip>
+#include <iostream>
+
+namespace hearing_aid::benchmarks {
+namespace {
+class BandCount : public SuperSignalProcessor {
+    int chunkSize_;
+    int channels_;
+public:
+    BandCount(int chunkSize, int channels) :
+        chunkSize_{chunkSize},
+        channels_{channels} {}
+
+    void feedbackCancelInput(real_signal_type, real_signal_type, int) override {}
+    void compressInput(real_signal_type, real_signal_type, int) override {}
+    void compressChannel(complex_signal_type, complex_signal_type, int) override {}
+    void compressOutput(real_signal_type, real_signal_type, int) override {}
+    void feedbackCancelOutput(real_signal_type, int) override {}
+
+    int chunkSize() override {
+        return chunkSize_;
+    }
+
+    int channels() override {
+        return channels_;
+    }
+};
+
+// The chapro.cfg fitting with the broadband compressors of
+// HearingAidBuilder.
+ControlRateCompressor::Parameters fitting(int controlInterval) {
+    const auto f = chaproFitting();
+    ControlRateCompressor::Parameters p{};
+    p.compressionRatios = f.compressionRatios;
+    p.kneepoints = f.kneepoints;
+    p.kneepointGains = f.kneepointGains;
+    p.broadbandOutputLimitingThresholds =
+        f.broadbandOutputLimitingThresholds;
+    p.broadband = {0, 105, 10, 105};
+    p.attack = f.attack;
+    p.release = f.release;
+    p.broadbandAttack = 1;
+    p.broadbandRelease = 50;
+    p.sampleRate = f.sampleRate;
+    p.fullScaleLevel = f.fullScaleLevel;
+    p.controlInterval = controlInterval;
+    return p;
+}
+}
+
+void controlRateCompressor() {
+    constexpr auto chunkSize = 64;
+    constexpr auto channels = 8;
+    constexpr auto fragments = 20000;
+    const auto input = noise(2 * chunkSize * channels, 0.1F);
+    std::vector<float> buffer(input.size());
+    std::cout << std::setw(10) << "interval"
+        << std::setw(28) << "ns per band per fragment"
+        << std::setw(10) << "speedup" << '\n';
+    double perSample = 0;
+    for (auto interval : {1, 2, 4, 8, 16, 32, 64}) {
+        ControlRateCompressor compressor{
+            std::make_shared<BandCount>(chunkSize, channels),
+            fitting(interval)
+        };
+        const auto start = clock_type::now();
+        for (int i = 0; i < fragments; ++i) {
+            buffer = input;
+            compressor.compressChannel(buffer, buffer, chunkSize);
+        }
+        const auto cost =
+            nanoseconds(clock_type::now() - start) / fragments / channels;
+        if (interval == 1)
+            perSample = cost;
+        std::cout << std::setw(10) << interval
+            << std::setw(28) << std::fixed << std::setprecision(1) << cost
+            << std::setw(10) << std::setprecision(2) << perSample / cost
+            << '\n';
+    }
+}
+}
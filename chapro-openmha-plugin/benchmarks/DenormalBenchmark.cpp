@@ -0,0 +1,153 @@
+#include "benchmarks.h"
+#include <hearing-aid/ControlRateCompressor.h>
+#include <hearing-aid/DenormalProtection.h>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+namespace hearing_aid::benchmarks {
+namespace {
+constexpr auto sampleRate = 44100;
+constexpr auto fragmentSize = 64;
+constexpr auto bandCount = 8;
+
+// Bank of two-pole resonators standing in for the CHAPRO IIR filterbank:
+// after the input stops, its state decays exponentially through the
+// subnormal range.
+class ResonatorFilterbank : public SuperSignalProcessor, public Filter {
+    std::vector<real_type> a1;
+    std::vector<real_type> a2;
+    std::vector<real_type> y1;
+    std::vector<real_type> y2;
+public:
+    ResonatorFilterbank() :
+        a1(bandCount),
+        a2(bandCount),
+        y1(bandCount),
+        y2(bandCount)
+    {
+        const auto pi = std::acos(-1.);
+        for (int k = 0; k < bandCount; ++k) {
+            const auto frequency = 250. * std::pow(2., k * 0.6);
+            const auto radius = 0.995;
+            a1[k] = static_cast<real_type>(
+                2 * radius * std::cos(2 * pi * frequency / sampleRate)
+            );
+            a2[k] = static_cast<real_type>(-radius * radius);
+        }
+    }
+
+    void feedbackCancelInput(real_signal_type, real_signal_type, int) override {}
+    void compressInput(real_signal_type, real_signal_type, int) override {}
+    void compressChannel(complex_signal_type, complex_signal_type, int) override {}
+    void compressOutput(real_signal_type, real_signal_type, int) override {}
+    void feedbackCancelOutput(real_signal_type, int) override {}
+
+    void filterbankAnalyze(
+        real_signal_type x,
+        complex_signal_type z,
+        int c
+    ) override {
+        for (int k = 0; k < bandCount; ++k)
+            for (int i = 0; i < c; ++i) {
+                const auto y = 0.01F * x[i] + a1[k] * y1[k] + a2[k] * y2[k];
+                y2[k] = y1[k];
+                y1[k] = y;
+                z[2 * c * k + 2 * i] = y;
+                z[2 * c * k + 2 * i + 1] = 0;
+            }
+    }
+
+    void filterbankSynthesize(
+        complex_signal_type z,
+        real_signal_type x,
+        int c
+    ) override {
+        for (int i = 0; i < c; ++i) {
+            x[i] = 0;
+            for (int k = 0; k < bandCount; ++k)
+                x[i] += z[2 * c * k + 2 * i];
+        }
+    }
+
+    int chunkSize() override {
+        return fragmentSize;
+    }
+
+    int channels() override {
+        return bandCount;
+    }
+};
+
+std::unique_ptr<SignalProcessor> hearingAid() {
+    ControlRateCompressor::Parameters p{};
+    p.compressionRatios.assign(bandCount, 2);
+    p.kneepoints.assign(bandCount, 40);
+    p.kneepointGains.assign(bandCount, 20);
+    p.broadbandOutputLimitingThresholds.assign(bandCount, 100);
+    p.broadband = {0, 105, 10, 105};
+    p.attack = 5;
+    p.release = 50;
+    p.broadbandAttack = 1;
+    p.broadbandRelease = 50;
+    p.sampleRate = sampleRate;
+    p.fullScaleLevel = 119;
+    p.controlInterval = 1;
+    auto filterbank = std::make_shared<ResonatorFilterbank>();
+    return std::make_unique<AfcHearingAid>(
+        std::make_shared<ControlRateCompressor>(filterbank, p),
+        filterbank
+    );
+}
+
+// Mean fragment cost per second of audio: one second of noise, then
+// silence.
+std::vector<double> costPerSecond(SignalProcessor &processor, int seconds) {
+    const auto perSecond = sampleRate / fragmentSize;
+    const auto input = noise(fragmentSize, 0.3F);
+    std::vector<float> buffer(fragmentSize);
+    std::vector<double> costs;
+    for (int s = 0; s < seconds; ++s) {
+        const auto start = clock_type::now();
+        for (int n = 0; n < perSecond; ++n) {
+            if (s == 0)
+                buffer = input;
+            else
+                std::fill(buffer.begin(), buffer.end(), 0.F);
+            processor.process(buffer);
+        }
+        costs.push_back(nanoseconds(clock_type::now() - start) / perSecond);
+    }
+    return costs;
+}
+}
+
+// Fragment cost through a second of noise and the silence after it,
+// unprotected, with hardware flush-to-zero and with dither.
+void denormals() {
+    constexpr auto seconds = 30;
+    auto unprotected = hearingAid();
+    DenormalProtectedHearingAid flushed{
+        hearingAid(),
+        DenormalProtectedHearingAid::Mode::flush
+    };
+    DenormalProtectedHearingAid dithered{
+        hearingAid(),
+        DenormalProtectedHearingAid::Mode::dither
+    };
+    const auto none = costPerSecond(*unprotected, seconds);
+    const auto flush = costPerSecond(flushed, seconds);
+    const auto dither = costPerSecond(dithered, seconds);
+    std::cout << "hardware flush-to-zero: "
+        << FlushDenormalsToZero::supported() << '\n';
+    std::cout << std::setw(10) << "second"
+        << std::setw(14) << "unprotected"
+        << std::setw(14) << "flush"
+        << std::setw(14) << "dither" << "  (ns per fragment)\n";
+    for (int s = 0; s < seconds; ++s)
+        std::cout << std::setw(10) << s
+            << std::setw(14) << std::fixed << std::setprecision(0) << none[s]
+            << std::setw(14) << flush[s]
+            << std::setw(14) << dither[s] << '\n';
+}
+}
@@ -0,0 +1,104 @@
+#include "benchmarks.h"
+#include <hearing-aid/PartitionedBlockFeedbackCanceller.h>
+#include <iomanip>
+#include <iostream>
+
+namespace hearing_aid::benchmarks {
+namespace {
+class ChunkSize : public SuperSignalProcessor {
+    int chunkSize_;
+public:
+    explicit ChunkSize(int chunkSize) : chunkSize_{chunkSize} {}
+    void feedbackCancelInput(real_signal_type, real_signal_type, int) override {}
+    void compressInput(real_signal_type, real_signal_type, int) override {}
+    void compressChannel(complex_signal_type, complex_signal_type, int) override {}
+    void compressOutput(real_signal_type, real_signal_type, int) override {}
+    void feedbackCancelOutput(real_signal_type, int) override {}
+
+    int chunkSize() override {
+        return chunkSize_;
+    }
+
+    int channels() override {
+        return 1;
+    }
+};
+
+// Sample-by-sample normalized LMS, the update CHAPRO's time-domain
+// canceller performs per tap.
+class TimeDomainNlms {
+    std::vector<float> weights;
+    std::vector<float> history;
+    float power{};
+    float stepSize;
+    int head{};
+public:
+    TimeDomainNlms(int length, float stepSize) :
+        weights(length),
+        history(2 * length),
+        stepSize{stepSize} {}
+
+    void process(std::vector<float> &input, const std::vector<float> &output) {
+        const auto length = static_cast<int>(weights.size());
+        for (std::vector<float>::size_type i = 0; i < input.size(); ++i) {
+            const auto *x = &history[head];
+            float estimate = 0;
+            for (int j = 0; j < length; ++j)
+                estimate += weights[j] * x[j];
+            const auto error = input[i] - estimate;
+            input[i] = error;
+            const auto update = stepSize * error / (power + 1e-6F);
+            for (int j = 0; j < length; ++j)
+                weights[j] += update * x[j];
+            const auto oldest = x[length - 1];
+            head = head == 0 ? length - 1 : head - 1;
+            history[head] = history[head + length] = output[i];
+            power += output[i] * output[i] - oldest * oldest;
+        }
+    }
+};
+}
+
+void feedbackCanceller() {
+    constexpr auto chunkSize = 64;
+    constexpr auto fragments = 5000;
+    const auto input = noise(chunkSize, 0.1F);
+    const auto output = noise(chunkSize, 0.2F);
+    std::cout << std::setw(8) << "taps"
+        << std::setw(22) << "time-domain ns/sample"
+        << std::setw(24) << "partitioned ns/sample" << '\n';
+    for (auto taps : {64, 128, 256, 512, 1024}) {
+        TimeDomainNlms nlms{taps, 0.01F};
+        std::vector<float> x;
+        auto start = clock_type::now();
+        for (int i = 0; i < fragments; ++i) {
+            x = input;
+            nlms.process(x, output);
+        }
+        const auto timeDomain = nanoseconds(clock_type::now() - start) /
+            fragments / chunkSize;
+        PartitionedBlockFeedbackCanceller::Parameters p{};
+        p.filterEstimationForgettingFactor = 0.9;
+        p.filterEstimationPowerThreshold = 1e-6;
+        p.filterEstimationStepSize = 0.01;
+        p.adaptiveFilterLength = taps;
+        PartitionedBlockFeedbackCanceller canceller{
+            std::make_shared<ChunkSize>(chunkSize),
+            p
+        };
+        auto y = output;
+        start = clock_type::now();
+        for (int i = 0; i < fragments; ++i) {
+            x = input;
+            canceller.feedbackCancelInput(x, x, chunkSize);
+            canceller.feedbackCancelOutput(y, chunkSize);
+        }
+        const auto partitioned = nanoseconds(clock_type::now() - start) /
+            fragments / chunkSize;
+        std::cout << std::setw(8) << taps
+            << std::setw(22) << std::fixed << std::setprecision(1)
+            << timeDomain
+            << std::setw(24) << partitioned << '\n';
+    }
+}
+}
@@ -0,0 +1,93 @@
+#include "benchmarks.h"
+#include <chapro-backend/ChaproSweep.h>
+#include <hearing-aid/FeedbackLoopHost.h>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace hearing_aid::benchmarks {
+namespace {
+// The chapro.cfg fitting with the IIR filterbank and CHAPRO's own
+// simulated feedback off.
+HearingAidBuilder::Parameters fitting() {
+    auto p = chaproFitting();
+    p.filterType = "IIR";
+    p.feedbackGain = 0;
+    return p;
+}
+
+// Decaying resonance at 3 kHz, a crude behind-the-ear leakage path.
+std::vector<real_type> leakage(double gain, double frequency) {
+    std::vector<real_type> h(64);
+    for (std::vector<real_type>::size_type i = 0; i < h.size(); ++i)
+        h[i] = real_type(
+            gain * std::exp(-0.1 * i) *
+            std::sin(2 * 3.14159265 * frequency * i / 44100)
+        );
+    return h;
+}
+
+struct Configuration {
+    std::string name;
+    std::string engine;
+    double stepSize;
+    int filterLength;
+};
+}
+
+// Closes a 64-tap leakage path with 16 samples of hardware delay around
+// the chapro.cfg fitting for each AFC configuration, on two seconds of
+// noise; after one second the path changes (a phone brought to the ear)
+// over 50 ms. Reports convergence, reconvergence, maximum stable gain
+// and the cost per fragment.
+void feedbackLoop() {
+    FeedbackLoopHost::Parameters p{};
+    p.path.impulseResponse = leakage(0.2, 3000);
+    p.path.changedImpulseResponse = leakage(0.4, 2500);
+    p.path.hardwareDelay = 16;
+    p.path.changeFragment = 44100 / 64;
+    p.path.changeFragments = 34;
+    p.convergenceThreshold = -10;
+    p.convergenceWindow = 34;
+    p.howlMargin = 10;
+    p.minimumGain = -30;
+    p.maximumGain = 30;
+    p.gainResolution = 1;
+    const auto input = noise(2 * 44100, 0.01F);
+    ChaproSweepBackend backend;
+    FeedbackLoopHost host{&backend, p};
+    const auto time = name(FeedbackEngine::timeDomain);
+    const auto frequency = name(FeedbackEngine::frequencyDomain);
+    const std::vector<Configuration> configurations{
+        {"time mu 2e-4", time, 0.0002, 100},
+        {"time mu 2e-3", time, 0.002, 100},
+        {"freq mu 0.005", frequency, 0.005, 128},
+        {"freq mu 0.02", frequency, 0.02, 128},
+        {"freq mu 0.02 256", frequency, 0.02, 256}
+    };
+    std::cout << std::setw(18) << "configuration"
+        << std::setw(14) << "converge ms"
+        << std::setw(14) << "reconverge ms"
+        << std::setw(10) << "MSG dB"
+        << std::setw(12) << "mean us"
+        << std::setw(12) << "p99 us" << '\n';
+    const auto milliseconds = [&](int fragments) {
+        return fragments < 0 ? -1. : 1e3 * fragments * 64 / 44100;
+    };
+    for (const auto &c : configurations) {
+        auto fitted = fitting();
+        fitted.feedbackEngine = c.engine;
+        fitted.filterEstimationStepSize = c.stepSize;
+        fitted.adaptiveFeedbackFilterLength = c.filterLength;
+        const auto r = host.evaluate(fitted, input);
+        std::cout << std::setw(18) << c.name
+            << std::setw(14) << std::fixed << std::setprecision(0)
+            << milliseconds(r.convergence)
+            << std::setw(14) << milliseconds(r.reconvergence)
+            << std::setw(10) << std::setprecision(1) << r.maximumStableGain
+            << std::setw(12) << std::setprecision(2) << r.cost.mean() / 1e3
+            << std::setw(12) << r.cost.percentile(0.99) / 1e3 << '\n';
+    }
+}
+}
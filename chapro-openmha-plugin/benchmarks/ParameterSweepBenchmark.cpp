@@ -0,0 +1,64 @@
+#include "benchmarks.h"
+#include <chapro-backend/ChaproSweep.h>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace hearing_aid::benchmarks {
+namespace {
+// The chapro.cfg fitting with the IIR filterbank and no feedback
+// management.
+HearingAidBuilder::Parameters fitting() {
+    auto p = chaproFitting();
+    p.filterType = "IIR";
+    p.feedback = "off";
+    return p;
+}
+
+std::vector<std::vector<double>> scaled(
+    const std::vector<double> &v,
+    std::initializer_list<double> factors
+) {
+    std::vector<std::vector<double>> candidates;
+    for (auto factor : factors) {
+        candidates.push_back(v);
+        for (auto &x : candidates.back())
+            x *= factor;
+    }
+    return candidates;
+}
+}
+
+// Evaluates a 4 x 4 x 4 grid around the chapro.cfg fitting on one
+// second of noise plus a tone, with one thread and with every core.
+void parameterSweep() {
+    const auto p = fitting();
+    ParameterSweep::Grid grid;
+    grid.compressionRatios = scaled(p.compressionRatios, {1, 1.1, 1.2, 1.3});
+    grid.kneepoints = scaled(p.kneepoints, {0.9, 1, 1.1, 1.2});
+    grid.kneepointGains = scaled(p.kneepointGains, {0.8, 0.9, 1, 1.1});
+    ParameterSweep::Input input;
+    input.noise = noise(44100, 0.01F);
+    for (int i = 0; i < 44100; ++i)
+        input.signal.push_back(0.1F * std::sin(2 * 3.14159265F * i / 44.1F));
+    ChaproSweepBackend backend;
+    std::cout << std::setw(10) << "threads"
+        << std::setw(16) << "points per s"
+        << std::setw(16) << "ms per point" << '\n';
+    const auto cores = static_cast<int>(std::thread::hardware_concurrency());
+    for (auto threads : {1, cores > 1 ? cores : 1}) {
+        ParameterSweep sweep{&backend, threads};
+        const auto start = clock_type::now();
+        const auto results = sweep.run(p, grid, input, {true, true, false});
+        const auto seconds = nanoseconds(clock_type::now() - start) / 1e9;
+        std::cout << std::setw(10) << threads
+            << std::setw(16) << std::fixed << std::setprecision(1)
+            << results.size() / seconds
+            << std::setw(16) << std::setprecision(2)
+            << 1e3 * seconds / results.size() << '\n';
+        if (cores <= 1)
+            break;
+    }
+}
+}
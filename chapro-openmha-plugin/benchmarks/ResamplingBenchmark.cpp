@@ -0,0 +1,134 @@
+#include "benchmarks.h"
+#include <hearing-aid/ControlRateCompressor.h>
+#include <hearing-aid/ResamplingHearingAid.h>
+#include <iomanip>
+#include <iostream>
+
+namespace hearing_aid::benchmarks {
+namespace {
+constexpr auto bandCount = 8;
+
+// Copies the fragment into every band and averages the bands back,
+// standing in for a CHAPRO filterbank.
+class CopyingFilterbank : public SuperSignalProcessor, public Filter {
+    int chunkSize_;
+public:
+    explicit CopyingFilterbank(int chunkSize) : chunkSize_{chunkSize} {}
+
+    void feedbackCancelInput(real_signal_type, real_signal_type, int) override {}
+    void compressInput(real_signal_type, real_signal_type, int) override {}
+    void compressChannel(complex_signal_type, complex_signal_type, int) override {}
+    void compressOutput(real_signal_type, real_signal_type, int) override {}
+    void feedbackCancelOutput(real_signal_type, int) override {}
+
+    void filterbankAnalyze(
+        real_signal_type x,
+        complex_signal_type z,
+        int c
+    ) override {
+        for (int k = 0; k < bandCount; ++k)
+            for (int i = 0; i < c; ++i) {
+                z[2 * c * k + 2 * i] = x[i];
+                z[2 * c * k + 2 * i + 1] = 0;
+            }
+    }
+
+    void filterbankSynthesize(
+        complex_signal_type z,
+        real_signal_type x,
+        int c
+    ) override {
+        for (int i = 0; i < c; ++i) {
+            x[i] = 0;
+            for (int k = 0; k < bandCount; ++k)
+                x[i] += z[2 * c * k + 2 * i] / bandCount;
+        }
+    }
+
+    int chunkSize() override {
+        return chunkSize_;
+    }
+
+    int channels() override {
+        return bandCount;
+    }
+};
+
+std::unique_ptr<SignalProcessor> hearingAid(int sampleRate, int chunkSize) {
+    ControlRateCompressor::Parameters p{};
+    p.compressionRatios.assign(bandCount, 2);
+    p.kneepoints.assign(bandCount, 40);
+    p.kneepointGains.assign(bandCount, 20);
+    p.broadbandOutputLimitingThresholds.assign(bandCount, 100);
+    p.broadband = {0, 105, 10, 105};
+    p.attack = 5;
+    p.release = 50;
+    p.broadbandAttack = 1;
+    p.broadbandRelease = 50;
+    p.sampleRate = sampleRate;
+    p.fullScaleLevel = 119;
+    p.controlInterval = 1;
+    auto filterbank = std::make_shared<CopyingFilterbank>(chunkSize);
+    return std::make_unique<AfcHearingAid>(
+        std::make_shared<ControlRateCompressor>(filterbank, p),
+        filterbank
+    );
+}
+}
+
+// Compares running the hearing aid at the interface rate with running it
+// at a lower internal rate behind the polyphase converters. The stand-in
+// hearing aid is cheaper than CHAPRO, so the savings are a lower bound.
+void resampling() {
+    constexpr auto chunkSize = 32;
+    constexpr auto seconds = 5;
+    std::cout << std::setw(10) << "external"
+        << std::setw(10) << "internal"
+        << std::setw(12) << "ns/sample"
+        << std::setw(10) << "speedup"
+        << std::setw(18) << "latency samples" << '\n';
+    for (auto external : {44100, 48000}) {
+        const auto input = noise(chunkSize, 0.1F);
+        std::vector<float> buffer(chunkSize);
+        const auto fragments = seconds * external / chunkSize;
+        double direct = 0;
+        for (auto internal : {external, 24000, 16000}) {
+            std::unique_ptr<SignalProcessor> processor;
+            auto latency = 0;
+            if (internal == external) {
+                processor = hearingAid(external, chunkSize);
+            } else {
+                ResamplingHearingAid::Parameters p;
+                p.externalRate = external;
+                p.internalRate = internal;
+                p.externalChunkSize = chunkSize;
+                p.passband = 0.8;
+                p.stopbandAttenuation = 70;
+                auto resampling = std::make_unique<ResamplingHearingAid>(
+                    hearingAid(
+                        internal,
+                        ResamplingHearingAid::internalChunkSize(p)
+                    ),
+                    p
+                );
+                latency = resampling->latencySamples();
+                processor = std::move(resampling);
+            }
+            const auto start = clock_type::now();
+            for (int i = 0; i < fragments; ++i) {
+                buffer = input;
+                processor->process(buffer);
+            }
+            const auto cost = nanoseconds(clock_type::now() - start) /
+                (static_cast<double>(fragments) * chunkSize);
+            if (internal == external)
+                direct = cost;
+            std::cout << std::setw(10) << external
+                << std::setw(10) << internal
+                << std::setw(12) << std::fixed << std::setprecision(1) << cost
+                << std::setw(10) << std::setprecision(2) << direct / cost
+                << std::setw(18) << latency << '\n';
+        }
+    }
+}
+}
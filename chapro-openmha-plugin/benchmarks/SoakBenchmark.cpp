@@ -0,0 +1,167 @@
+#include "benchmarks.h"
+#include <chapro-backend/Chapro.h>
+#include <hearing-aid/LatencyHistogram.h>
+#include <hearing-aid/ThreadAffinity.h>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace hearing_aid::benchmarks {
+namespace {
+constexpr auto sampleRate = 44100;
+constexpr auto chunkSize = 64;
+constexpr auto realtimePriority = 80;
+constexpr auto windowSeconds = 10;
+// Flags raised when the last window departs this far from the first.
+constexpr auto costDriftRatio = 1.5;
+constexpr auto levelDriftDecibels = 20.;
+
+int environment(const char *name, int fallback) {
+    const auto value = std::getenv(name);
+    return value == nullptr ? fallback : std::atoi(value);
+}
+
+// The chapro.cfg fitting with the FIR filterbank and feedback management.
+HearingAidBuilder::Parameters fitting() {
+    auto p = chaproFitting();
+    p.filterType = "FIR";
+    p.feedback = "yes";
+    p.sampleRate = sampleRate;
+    p.chunkSize = chunkSize;
+    return p;
+}
+
+struct Window {
+    LatencyHistogram cost;
+    double outputPower{};
+    int nonFinite{};
+};
+
+double decibels(double power) {
+    return 10 * std::log10(power + 1e-20);
+}
+
+void report(const std::string &label, const LatencyHistogram &h) {
+    std::cout << std::setw(10) << label
+        << std::setw(10) << h.percentile(0.5)
+        << std::setw(10) << h.percentile(0.99)
+        << std::setw(10) << h.percentile(0.999)
+        << std::setw(10) << h.max();
+}
+
+// Runs minutes of audio (SOAK_MINUTES, default 1) through the CHAPRO
+// pipeline on a pinned (SOAK_CORE, default 0), SCHED_FIFO thread with
+// memory locked. Input alternates 10 s of noise with 5 s of silence so
+// denormal slowdowns show up. Reports per-window and overall fragment
+// cost percentiles in nanoseconds and flags drift in cost or output level.
+void run() {
+    const auto minutes = environment("SOAK_MINUTES", 1);
+    const auto core = environment("SOAK_CORE", 0);
+    std::cout << "pinned: " << pinCurrentThreadToCore(core)
+        << ", SCHED_FIFO: " << makeCurrentThreadRealtime(realtimePriority)
+        << ", mlockall: " << lockMemory() << '\n';
+
+    void *cha_pointer[NPTR]{};
+    ChaproInitializer initializer{cha_pointer};
+    ChaproFilterFactory filterFactory{cha_pointer};
+    HearingAidBuilder builder{&initializer, &filterFactory};
+    const auto p = fitting();
+    builder.build(p);
+    SuperSignalProcessor::Parameters s;
+    s.chunkSize = chunkSize;
+    s.channels = static_cast<int>(p.crossFrequencies.size()) + 1;
+    auto hearingAid = std::make_unique<AfcHearingAid>(
+        builder.processor(std::make_shared<Chapro>(cha_pointer, s)),
+        builder.filter()
+    );
+
+    const auto period = 15 * sampleRate / chunkSize;
+    const auto sound = 10 * sampleRate / chunkSize;
+    const auto fragments = 60LL * minutes * sampleRate / chunkSize;
+    const auto windowFragments = windowSeconds * sampleRate / chunkSize;
+    const auto noiseSource = noise(chunkSize * 997, 0.05F);
+    std::vector<float> buffer(chunkSize);
+    // Windows are built before the measured loop, whose allocations would
+    // show up as latency.
+    std::vector<Window> windows(
+        static_cast<std::size_t>(
+            (fragments + windowFragments - 1) / windowFragments
+        )
+    );
+    LatencyHistogram overall;
+    for (long long n = 0; n < fragments; ++n) {
+        if (n % period < sound)
+            std::copy(
+                noiseSource.begin() + (n % 997) * chunkSize,
+                noiseSource.begin() + (n % 997 + 1) * chunkSize,
+                buffer.begin()
+            );
+        else
+            std::fill(buffer.begin(), buffer.end(), 0.F);
+        const auto start = clock_type::now();
+        hearingAid->process(buffer);
+        const auto cost = clock_type::now() - start;
+        auto &window = windows[static_cast<std::size_t>(n / windowFragments)];
+        window.cost.record(static_cast<std::uint64_t>(nanoseconds(cost)));
+        for (auto x : buffer)
+            if (std::isfinite(x))
+                window.outputPower += x * x;
+            else
+                ++window.nonFinite;
+    }
+    hearingAid.reset();
+    cha_cleanup(cha_pointer);
+
+    std::cout << std::setw(10) << "window s"
+        << std::setw(10) << "p50"
+        << std::setw(10) << "p99"
+        << std::setw(10) << "p99.9"
+        << std::setw(10) << "max"
+        << std::setw(12) << "output dB" << '\n';
+    for (std::size_t i = 0; i < windows.size(); ++i) {
+        auto &w = windows[i];
+        w.outputPower /= static_cast<double>(w.cost.count()) * chunkSize;
+        report(std::to_string(i * windowSeconds), w.cost);
+        std::cout << std::setw(12) << std::fixed << std::setprecision(1)
+            << decibels(w.outputPower) << '\n';
+        overall.merge(w.cost);
+    }
+    report("overall", overall);
+    std::cout << '\n';
+
+    // Compares the first window with the last complete one starting at the
+    // same point of the 15 s noise/silence cycle (every third window).
+    const auto &first = windows.front();
+    auto lastIndex = windows.size() - 1;
+    while (lastIndex > 0 &&
+        (lastIndex % 3 != 0 ||
+            windows[lastIndex].cost.count() <
+                static_cast<std::uint64_t>(windowFragments)))
+        --lastIndex;
+    const auto &last = windows[lastIndex];
+    auto nonFinite = 0;
+    for (const auto &w : windows)
+        nonFinite += w.nonFinite;
+    if (nonFinite > 0)
+        std::cout << "drift: " << nonFinite << " non-finite output samples\n";
+    if (last.cost.percentile(0.5) > costDriftRatio * first.cost.percentile(0.5))
+        std::cout << "drift: median fragment cost grew from "
+            << first.cost.percentile(0.5) << " to "
+            << last.cost.percentile(0.5) << " ns\n";
+    if (decibels(last.outputPower) - decibels(first.outputPower) >
+        levelDriftDecibels)
+        std::cout << "drift: output level grew by "
+            << decibels(last.outputPower) - decibels(first.outputPower)
+            << " dB (feedback canceller divergence?)\n";
+}
+}
+
+void soak() {
+    // Scheduling changes stay confined to a thread of our own.
+    std::thread thread{run};
+    thread.join();
+}
+}
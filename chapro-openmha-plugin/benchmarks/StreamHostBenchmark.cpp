@@ -0,0 +1,115 @@
+#include "benchmarks.h"
+#include <hearing-aid/ControlRateCompressor.h>
+#include <hearing-aid/StreamHost.h>
+#include <iomanip>
+#include <iostream>
+
+namespace hearing_aid::benchmarks {
+namespace {
+constexpr auto fragmentSize = 64;
+constexpr auto bandCount = 8;
+constexpr auto sampleRate = 44100;
+
+// Copies the fragment into every band and sums the bands back, standing
+// in for a CHAPRO filterbank.
+class CopyingFilterbank : public SuperSignalProcessor, public Filter {
+public:
+    void feedbackCancelInput(real_signal_type, real_signal_type, int) override {}
+    void compressInput(real_signal_type, real_signal_type, int) override {}
+    void compressChannel(complex_signal_type, complex_signal_type, int) override {}
+    void compressOutput(real_signal_type, real_signal_type, int) override {}
+    void feedbackCancelOutput(real_signal_type, int) override {}
+
+    void filterbankAnalyze(
+        real_signal_type x,
+        complex_signal_type z,
+        int c
+    ) override {
+        for (int k = 0; k < bandCount; ++k)
+            for (int i = 0; i < c; ++i) {
+                z[2 * c * k + 2 * i] = x[i];
+                z[2 * c * k + 2 * i + 1] = 0;
+            }
+    }
+
+    void filterbankSynthesize(
+        complex_signal_type z,
+        real_signal_type x,
+        int c
+    ) override {
+        for (int i = 0; i < c; ++i) {
+            x[i] = 0;
+            for (int k = 0; k < bandCount; ++k)
+                x[i] += z[2 * c * k + 2 * i] / bandCount;
+        }
+    }
+
+    int chunkSize() override {
+        return fragmentSize;
+    }
+
+    int channels() override {
+        return bandCount;
+    }
+};
+
+std::unique_ptr<SignalProcessor> stream() {
+    ControlRateCompressor::Parameters p{};
+    p.compressionRatios.assign(bandCount, 2);
+    p.kneepoints.assign(bandCount, 40);
+    p.kneepointGains.assign(bandCount, 20);
+    p.broadbandOutputLimitingThresholds.assign(bandCount, 100);
+    p.broadband = {0, 105, 10, 105};
+    p.attack = 5;
+    p.release = 50;
+    p.broadbandAttack = 1;
+    p.broadbandRelease = 50;
+    p.sampleRate = sampleRate;
+    p.fullScaleLevel = 119;
+    p.controlInterval = 1;
+    auto filterbank = std::make_shared<CopyingFilterbank>();
+    return std::make_unique<AfcHearingAid>(
+        std::make_shared<ControlRateCompressor>(filterbank, p),
+        filterbank
+    );
+}
+}
+
+// Serves streams whose deadline is one fragment period and reports the
+// busy fraction of that period and the share of missed deadlines.
+void streamHost() {
+    constexpr auto fragments = 2000;
+    const StreamHost::duration_type period{
+        1000000000LL * fragmentSize / sampleRate
+    };
+    std::cout << std::setw(10) << "streams"
+        << std::setw(10) << "threads"
+        << std::setw(18) << "busy of period"
+        << std::setw(18) << "missed fraction" << '\n';
+    for (auto count : {4, 16, 64})
+        for (auto threads : {1, 2, 4}) {
+            StreamHost host{{{}, threads}};
+            for (int i = 0; i < count; ++i)
+                host.add(stream(), period);
+            std::vector<std::vector<float>> buffers(count);
+            const auto input = noise(fragmentSize, 0.1F);
+            const auto start = clock_type::now();
+            for (int n = 0; n < fragments; ++n) {
+                for (auto &buffer : buffers)
+                    buffer = input;
+                host.process({buffers.begin(), buffers.end()});
+            }
+            const auto busy = nanoseconds(clock_type::now() - start) /
+                fragments / nanoseconds(period);
+            auto misses = 0;
+            for (int i = 0; i < count; ++i)
+                misses += host.statistics(i).deadlineMisses;
+            std::cout << std::setw(10) << count
+                << std::setw(10) << threads
+                << std::setw(18) << std::fixed << std::setprecision(3) << busy
+                << std::setw(18) << static_cast<double>(misses) /
+                    (static_cast<double>(count) * fragments)
+                << '\n';
+        }
+}
+}
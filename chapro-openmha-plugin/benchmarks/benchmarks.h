@@ -0,0 +1,44 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_BENCHMARKS_BENCHMARKS_H_
+#define CHAPRO_OPENMHA_PLUGIN_BENCHMARKS_BENCHMARKS_H_
+
+#include <hearing-aid/FittingConfiguration.h>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace hearing_aid::benchmarks {
+using clock_type = std::chrono::steady_clock;
+
+inline double nanoseconds(clock_type::duration d) {
+    return std::chrono::duration<double, std::nano>(d).count();
+}
+
+// Deterministic white noise so runs are comparable.
+inline std::vector<float> noise(std::vector<float>::size_type n, float level) {
+    std::vector<float> x(n);
+    std::uint32_t state = 1;
+    for (auto &sample : x) {
+        state = 1664525 * state + 1013904223;
+        sample = level * (static_cast<float>(state >> 8) / (1 << 23) - 1);
+    }
+    return x;
+}
+
+// The fitting of the repository's chapro.cfg.
+inline HearingAidBuilder::Parameters chaproFitting() {
+    return readFitting(std::string{CHAPRO_CONFIGURATION});
+}
+
+void activityGate();
+void bandParallelCompressor();
+void controlRateCompressor();
+void denormals();
+void feedbackCanceller();
+void feedbackLoop();
+void parameterSweep();
+void resampling();
+void soak();
+void streamHost();
+}
+
+#endif
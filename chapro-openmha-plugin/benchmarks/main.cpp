@@ -0,0 +1,35 @@
+#include "benchmarks.h"
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+
+int main(int argc, char *argv[]) {
+    namespace benchmarks = hearing_aid::benchmarks;
+    const std::map<std::string, std::function<void()>> all{
+        {"activity-gate", benchmarks::activityGate},
+        {"band-parallel-compressor", benchmarks::bandParallelCompressor},
+        {"control-rate-compressor", benchmarks::controlRateCompressor},
+        {"denormals", benchmarks::denormals},
+        {"feedback-canceller", benchmarks::feedbackCanceller},
+        {"feedback-loop", benchmarks::feedbackLoop},
+        {"parameter-sweep", benchmarks::parameterSweep},
+        {"resampling", benchmarks::resampling},
+        {"soak", benchmarks::soak},
+        {"stream-host", benchmarks::streamHost}
+    };
+    if (argc < 2) {
+        for (const auto &benchmark : all) {
+            std::cout << "# " << benchmark.first << '\n';
+            benchmark.second();
+        }
+        return 0;
+    }
+    const auto benchmark = all.find(argv[1]);
+    if (benchmark == all.end()) {
+        std::cerr << "unknown benchmark: " << argv[1] << '\n';
+        return 1;
+    }
+    benchmark->second();
+    return 0;
+}
@@ -0,0 +1,126 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_CHAPRO_BACKEND_INCLUDE_CHAPRO_BACKEND_CHAPRO_H_
+#define CHAPRO_OPENMHA_PLUGIN_CHAPRO_BACKEND_INCLUDE_CHAPRO_BACKEND_CHAPRO_H_
+
+#include <hearing-aid/AfcHearingAid.h>
+#include <hearing-aid/FeedbackQualityTap.h>
+#include <hearing-aid/HearingAidBuilder.h>
+extern "C" {
+#include <chapro.h>
+}
+
+// These are defined in chapro.h but appear in some standard headers
+#undef _size
+#undef fmin
+#undef fmove
+#undef fcopy
+#undef fzero
+#undef dcopy
+#undef dzero
+#undef round
+#undef log2
+
+#include <memory>
+#include <vector>
+
+// Each component's state is the slots of cha_pointer its prepare function
+// allocated, so it can be released without cha_cleanup and the other
+// components keep theirs.
+class ChaproInitializer : public hearing_aid::HearingAidInitializer {
+    CHA_PTR cha_pointer;
+    std::vector<int> filterSlots;
+    std::vector<int> feedbackSlots;
+    std::vector<int> automaticGainControlSlots;
+public:
+    explicit ChaproInitializer(CHA_PTR cha_pointer) :
+        cha_pointer{cha_pointer} {}
+
+    void initializeFirFilter(const FirParameters &) override;
+    void initializeIirFilter(const IirParameters &) override;
+    void initializeFeedbackManagement(const FeedbackManagement &) override;
+    void initializeAutomaticGainControl(
+        const AutomaticGainControl &
+    ) override;
+    void releaseFilter() override;
+    void releaseFeedbackManagement() override;
+    void releaseAutomaticGainControl() override;
+private:
+    template<typename Prepare>
+    void allocate(std::vector<int> &slots, Prepare);
+    void free(std::vector<int> &slots);
+};
+
+class ChaproFirFilter : public hearing_aid::Filter {
+    CHA_PTR cha_pointer;
+public:
+    explicit ChaproFirFilter(CHA_PTR cha_pointer) : cha_pointer{cha_pointer} {}
+    using real_signal_type = hearing_aid::real_signal_type;
+    using complex_signal_type = hearing_aid::complex_signal_type;
+    void filterbankAnalyze(real_signal_type, complex_signal_type, int) override;
+    void filterbankSynthesize(complex_signal_type, real_signal_type, int) override;
+};
+
+class ChaproIirFilter : public hearing_aid::Filter {
+    CHA_PTR cha_pointer;
+public:
+    explicit ChaproIirFilter(CHA_PTR cha_pointer) : cha_pointer{cha_pointer} {}
+    using real_signal_type = hearing_aid::real_signal_type;
+    using complex_signal_type = hearing_aid::complex_signal_type;
+    void filterbankAnalyze(real_signal_type, complex_signal_type, int) override;
+    void filterbankSynthesize(complex_signal_type, real_signal_type, int) override;
+};
+
+class ChaproFilterFactory : public hearing_aid::FilterFactory {
+    CHA_PTR cha_pointer;
+public:
+    explicit ChaproFilterFactory(CHA_PTR cha_pointer) :
+        cha_pointer{cha_pointer} {}
+
+    std::shared_ptr<hearing_aid::Filter> makeIir() override {
+        return std::make_shared<ChaproIirFilter>(cha_pointer);
+    }
+
+    std::shared_ptr<hearing_aid::Filter> makeFir() override {
+        return std::make_shared<ChaproFirFilter>(cha_pointer);
+    }
+};
+
+class Chapro : public hearing_aid::SuperSignalProcessor {
+    CHA_PTR cha_pointer;
+    const int channels_;
+    const int chunkSize_;
+public:
+    using real_signal_type = hearing_aid::real_signal_type;
+    using complex_signal_type = hearing_aid::complex_signal_type;
+    Chapro(CHA_PTR cha_pointer, const Parameters &);
+    void feedbackCancelInput(real_signal_type, real_signal_type, int) override;
+    void compressInput(real_signal_type, real_signal_type, int) override;
+    void compressChannel(complex_signal_type, complex_signal_type, int) override;
+    void compressOutput(real_signal_type, real_signal_type, int) override;
+    void feedbackCancelOutput(real_signal_type, int) override;
+    int chunkSize() override;
+    int channels() override;
+};
+
+// Reads the quality metric CHAPRO's time-domain AFC saves when sqm is
+// set and, when feedback is simulated, the misalignment of the estimated
+// against the simulated feedback path; without simulated feedback there
+// is no true path and the misalignment is NaN.
+//
+// CHAPRO stores each fragment's metric at qm[*iqmp] and advances *iqmp
+// until it reaches nqm. feedbackQuality() reads the latest entry and
+// rewinds *iqmp to 0, so a buffer of one fragment serves an unbounded
+// stream. That write is only safe because it is made between fragments
+// on the thread that runs cha_afc_input and cha_afc_output, which is
+// where FeedbackQualityTap calls it; nothing else may read qm meanwhile.
+class ChaproFeedbackMonitor : public hearing_aid::FeedbackMonitor {
+    CHA_PTR cha_pointer;
+    bool simulatedFeedback;
+public:
+    ChaproFeedbackMonitor(CHA_PTR cha_pointer, bool simulatedFeedback) :
+        cha_pointer{cha_pointer},
+        simulatedFeedback{simulatedFeedback} {}
+
+    hearing_aid::FeedbackQuality feedbackQuality() override;
+};
+
+#endif
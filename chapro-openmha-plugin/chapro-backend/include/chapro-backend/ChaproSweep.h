@@ -0,0 +1,36 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_CHAPRO_BACKEND_INCLUDE_CHAPRO_BACKEND_CHAPROSWEEP_H_
+#define CHAPRO_OPENMHA_PLUGIN_CHAPRO_BACKEND_INCLUDE_CHAPRO_BACKEND_CHAPROSWEEP_H_
+
+#include "Chapro.h"
+#include <hearing-aid/ParameterSweep.h>
+
+// A CHAPRO instance with its own memory, built for one sweep point.
+// Each point designs its own filterbank: cha_firfb_prepare and
+// cha_iirfb_prepare design into slots of the instance whose layout is
+// private to CHAPRO, so a design cannot be shared between instances.
+// ParameterSweep builds points one at a time, which makes the design cost
+// part of a short serial build phase rather than of processing.
+class ChaproSweepPipeline : public hearing_aid::SweepPipeline {
+    void *cha_pointer[NPTR]{};
+    std::unique_ptr<hearing_aid::SignalProcessor> hearingAid;
+public:
+    explicit ChaproSweepPipeline(
+        const hearing_aid::HearingAidBuilder::Parameters &
+    );
+    ~ChaproSweepPipeline() override;
+    ChaproSweepPipeline(const ChaproSweepPipeline &) = delete;
+    ChaproSweepPipeline &operator=(const ChaproSweepPipeline &) = delete;
+    void process(hearing_aid::real_signal_type) override;
+    std::vector<hearing_aid::real_type> qualityMetric() override;
+};
+
+class ChaproSweepBackend : public hearing_aid::SweepBackend {
+public:
+    std::unique_ptr<hearing_aid::SweepPipeline> make(
+        const hearing_aid::HearingAidBuilder::Parameters &p
+    ) override {
+        return std::make_unique<ChaproSweepPipeline>(p);
+    }
+};
+
+#endif
@@ -0,0 +1,258 @@
+#include "Chapro.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+static void copy(const std::vector<double> &source, double *destination) {
+    using size_type = std::vector<double>::size_type;
+    for (size_type i = 0; i < source.size(); ++i)
+        destination[i] = source.at(i);
+}
+
+// CHAPRO's first slots hold the size of every slot and the variables all
+// components share; cha_cleanup frees them.
+constexpr auto sizesSlot = 0;
+constexpr auto sharedSlots = 3;
+
+// CHAPRO's prepare functions allocate into their slots of cha_pointer
+// without freeing what is there, so the slots a prepare function fills
+// are recorded as its component's.
+template<typename Prepare>
+void ChaproInitializer::allocate(std::vector<int> &slots, Prepare prepare) {
+    std::array<bool, NPTR> allocated{};
+    for (auto i = 0; i < NPTR; ++i)
+        allocated[i] = cha_pointer[i] != nullptr;
+    prepare();
+    slots.clear();
+    for (auto i = sharedSlots; i < NPTR; ++i)
+        if (!allocated[i] && cha_pointer[i] != nullptr)
+            slots.push_back(i);
+}
+
+void ChaproInitializer::free(std::vector<int> &slots) {
+    const auto sizes = static_cast<int *>(cha_pointer[sizesSlot]);
+    for (auto i : slots) {
+        std::free(cha_pointer[i]);
+        cha_pointer[i] = nullptr;
+        if (sizes != nullptr)
+            sizes[i] = 0;
+    }
+    slots.clear();
+}
+
+void ChaproInitializer::initializeFirFilter(const FirParameters &p) {
+    const auto hamming = 0;
+    auto mutableCrossFrequencies = p.crossFrequencies;
+    allocate(filterSlots, [&] {
+        cha_firfb_prepare(
+            cha_pointer,
+            mutableCrossFrequencies.data(),
+            p.channels,
+            p.sampleRate,
+            p.windowSize,
+            hamming,
+            p.chunkSize
+        );
+    });
+}
+
+void ChaproInitializer::initializeIirFilter(const IirParameters &p) {
+    int zerosCount = 4;
+    auto size_ = 2*p.channels*zerosCount;
+    std::vector<float> zeros(size_);
+    std::vector<float> poles(size_);
+    std::vector<float> gain(p.channels);
+    std::vector<int> delay(p.channels);
+    double ir_delay_ms = 2.5;
+    auto mutableCrossFrequencies = p.crossFrequencies;
+    cha_iirfb_design(
+        zeros.data(),
+        poles.data(),
+        gain.data(),
+        delay.data(),
+        mutableCrossFrequencies.data(),
+        p.channels,
+        zerosCount,
+        p.sampleRate,
+        ir_delay_ms
+    );
+    allocate(filterSlots, [&] {
+        cha_iirfb_prepare(
+            cha_pointer,
+            zeros.data(),
+            poles.data(),
+            gain.data(),
+            delay.data(),
+            p.channels,
+            zerosCount,
+            p.sampleRate,
+            p.chunkSize
+        );
+    });
+}
+
+void ChaproInitializer::initializeFeedbackManagement(
+    const FeedbackManagement &parameters
+) {
+    CHA_AFC afc;
+    afc.rho = parameters.filterEstimationForgettingFactor;
+    afc.eps = parameters.filterEstimationPowerThreshold;
+    afc.mu = parameters.filterEstimationStepSize;
+    afc.afl = parameters.adaptiveFilterLength;
+    afc.wfl = parameters.signalWhiteningFilterLength;
+    afc.pfl = parameters.persistentFeedbackFilterLength;
+    afc.hdel = parameters.hardwareLatency;
+    afc.sqm = parameters.saveQualityMetric;
+    afc.fbg = parameters.gain;
+    afc.nqm = parameters.qualityMetricLength;
+    allocate(feedbackSlots, [&] { cha_afc_prepare(cha_pointer, &afc); });
+}
+
+void ChaproInitializer::initializeAutomaticGainControl(
+    const AutomaticGainControl &parameters
+) {
+    CHA_DSL dsl{};
+    dsl.attack = parameters.attack;
+    dsl.release = parameters.release;
+    dsl.nchannel = parameters.channels;
+    copy(parameters.crossFrequencies, dsl.cross_freq);
+    copy(parameters.compressionRatios, dsl.cr);
+    copy(parameters.kneepoints, dsl.tk);
+    copy(parameters.kneepointGains, dsl.tkgain);
+    copy(parameters.broadbandOutputLimitingThresholds, dsl.bolt);
+    CHA_WDRC wdrc;
+    wdrc.attack = 1;
+    wdrc.release = 50;
+    wdrc.fs = parameters.sampleRate;
+    wdrc.maxdB = parameters.fullScaleLevel;
+    wdrc.tkgain = 0;
+    wdrc.tk = 105;
+    wdrc.cr = 10;
+    wdrc.bolt = 105;
+    allocate(automaticGainControlSlots, [&] {
+        cha_agc_prepare(cha_pointer, &dsl, &wdrc);
+    });
+}
+
+void ChaproInitializer::releaseFilter() {
+    free(filterSlots);
+}
+
+void ChaproInitializer::releaseFeedbackManagement() {
+    free(feedbackSlots);
+}
+
+void ChaproInitializer::releaseAutomaticGainControl() {
+    free(automaticGainControlSlots);
+}
+
+void ChaproFirFilter::filterbankAnalyze(
+    real_signal_type input,
+    complex_signal_type output,
+    int chunkSize
+) {
+    cha_firfb_analyze(cha_pointer, input.data(), output.data(), chunkSize);
+}
+
+void ChaproFirFilter::filterbankSynthesize(
+    complex_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    cha_firfb_synthesize(cha_pointer, input.data(), output.data(), chunkSize);
+}
+
+void ChaproIirFilter::filterbankAnalyze(
+    real_signal_type input,
+    complex_signal_type output,
+    int chunkSize
+) {
+    cha_iirfb_analyze(cha_pointer, input.data(), output.data(), chunkSize);
+}
+
+void ChaproIirFilter::filterbankSynthesize(
+    complex_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    cha_iirfb_synthesize(cha_pointer, input.data(), output.data(), chunkSize);
+}
+
+Chapro::Chapro(CHA_PTR cha_pointer, const Parameters &parameters) :
+    cha_pointer{cha_pointer},
+    channels_{ parameters.channels },
+    chunkSize_{ parameters.chunkSize }
+{
+}
+
+void Chapro::feedbackCancelInput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    cha_afc_input(cha_pointer, input.data(), output.data(), chunkSize);
+}
+
+void Chapro::compressInput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    cha_agc_input(cha_pointer, input.data(), output.data(), chunkSize);
+}
+
+void Chapro::compressChannel(
+    complex_signal_type input,
+    complex_signal_type output,
+    int chunkSize
+) {
+    cha_agc_channel(cha_pointer, input.data(), output.data(), chunkSize);
+}
+
+void Chapro::compressOutput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    cha_agc_output(cha_pointer, input.data(), output.data(), chunkSize);
+}
+
+void Chapro::feedbackCancelOutput(real_signal_type input, int chunkSize) {
+    cha_afc_output(cha_pointer, input.data(), chunkSize);
+}
+
+int Chapro::chunkSize() {
+    return chunkSize_;
+}
+
+int Chapro::channels() {
+    return channels_;
+}
+
+hearing_aid::FeedbackQuality ChaproFeedbackMonitor::feedbackQuality() {
+    constexpr auto nan =
+        std::numeric_limits<hearing_aid::real_type>::quiet_NaN();
+    hearing_aid::FeedbackQuality quality{nan, nan, 0};
+    CHA_AFC afc{};
+    cha_afc_filters(cha_pointer, &afc);
+    if (afc.qm != nullptr && afc.iqmp != nullptr && *afc.iqmp > 0) {
+        quality.qualityMetric = afc.qm[*afc.iqmp - 1];
+        *afc.iqmp = 0;
+    }
+    if (!simulatedFeedback || afc.efbp == nullptr || afc.sfbp == nullptr)
+        return quality;
+    double error = 0;
+    double path = 0;
+    for (int i = 0; i < afc.afl; ++i) {
+        const auto difference = double{afc.efbp[i]} - afc.sfbp[i];
+        error += difference * difference;
+        path += double{afc.sfbp[i]} * afc.sfbp[i];
+    }
+    if (path > 0)
+        quality.misalignment = static_cast<hearing_aid::real_type>(
+            10 * std::log10(std::max(error / path, 1e-20))
+        );
+    return quality;
+}
@@ -0,0 +1,34 @@
+#include "ChaproSweep.h"
+
+ChaproSweepPipeline::ChaproSweepPipeline(
+    const hearing_aid::HearingAidBuilder::Parameters &p
+) {
+    ChaproInitializer initializer{cha_pointer};
+    ChaproFilterFactory filterFactory{cha_pointer};
+    hearing_aid::HearingAidBuilder builder{&initializer, &filterFactory};
+    builder.build(p);
+    hearing_aid::SuperSignalProcessor::Parameters chapro;
+    chapro.chunkSize = p.chunkSize;
+    chapro.channels = gsl::narrow<int>(p.crossFrequencies.size() + 1);
+    hearingAid = std::make_unique<hearing_aid::AfcHearingAid>(
+        builder.processor(std::make_shared<Chapro>(cha_pointer, chapro)),
+        builder.filter()
+    );
+}
+
+ChaproSweepPipeline::~ChaproSweepPipeline() {
+    hearingAid.reset();
+    cha_cleanup(cha_pointer);
+}
+
+void ChaproSweepPipeline::process(hearing_aid::real_signal_type x) {
+    hearingAid->process(x);
+}
+
+std::vector<hearing_aid::real_type> ChaproSweepPipeline::qualityMetric() {
+    CHA_AFC afc{};
+    cha_afc_filters(cha_pointer, &afc);
+    if (afc.qm == nullptr || afc.iqmp == nullptr)
+        return {};
+    return {afc.qm, afc.qm + *afc.iqmp};
+}
@@ -1,260 +1,22 @@
 #include "mha_plugin.hh"
 #include <hearing-aid/AfcHearingAid.h>
+#include <hearing-aid/BandParallelCompressor.h>
+#include <hearing-aid/BandTelemetryTap.h>
+#include <hearing-aid/DenormalProtection.h>
+#include <hearing-aid/FeedbackQualityTap.h>
+#include <hearing-aid/Fft.h>
+#include <hearing-aid/FlightRecorder.h>
 #include <hearing-aid/HearingAidBuilder.h>
-extern "C" {
-#include <chapro.h>
-}
-
-// These are defined in chapro.h but appear in some standard headers
-#undef _size
-#undef fmin
-#undef fmove
-#undef fcopy
-#undef fzero
-#undef dcopy
-#undef dzero
-#undef round
-#undef log2
-
+#include <hearing-aid/Kernels.h>
+#include <hearing-aid/PipelinedHearingAid.h>
+#include <hearing-aid/ResamplingHearingAid.h>
+#include <chapro-backend/Chapro.h>
 #include <gsl/gsl>
-
-static void copy(const std::vector<double> &source, double *destination) {
-    using size_type = std::vector<double>::size_type;
-    for (size_type i = 0; i < source.size(); ++i)
-        destination[i] = source.at(i);
-}
-
-class ChaproInitializer : public hearing_aid::HearingAidInitializer {
-    CHA_PTR cha_pointer;
-public:
-    explicit ChaproInitializer(CHA_PTR cha_pointer) :
-        cha_pointer{cha_pointer} {}
-
-    void initializeFirFilter(const FirParameters &p) override {
-        const auto hamming = 0;
-        auto mutableCrossFrequencies = p.crossFrequencies;
-        cha_firfb_prepare(
-            cha_pointer,
-            mutableCrossFrequencies.data(),
-            p.channels,
-            p.sampleRate,
-            p.windowSize,
-            hamming,
-            p.chunkSize
-        );
-    }
-
-    void initializeIirFilter(const IirParameters &p) override {
-        int zerosCount = 4;
-        auto size_ = 2*p.channels*zerosCount;
-        std::vector<float> zeros(size_);
-        std::vector<float> poles(size_);
-        std::vector<float> gain(p.channels);
-        std::vector<int> delay(p.channels);
-        double ir_delay_ms = 2.5;
-        auto mutableCrossFrequencies = p.crossFrequencies;
-        cha_iirfb_design(
-            zeros.data(),
-            poles.data(),
-            gain.data(),
-            delay.data(),
-            mutableCrossFrequencies.data(),
-            p.channels,
-            zerosCount,
-            p.sampleRate,
-            ir_delay_ms
-        );
-        cha_iirfb_prepare(
-            cha_pointer,
-            zeros.data(),
-            poles.data(),
-            gain.data(),
-            delay.data(),
-            p.channels,
-            zerosCount,
-            p.sampleRate,
-            p.chunkSize
-        );
-    }
-
-    void initializeFeedbackManagement(
-        const FeedbackManagement &parameters
-    ) override {
-        CHA_AFC afc;
-        afc.rho = parameters.filterEstimationForgettingFactor;
-        afc.eps = parameters.filterEstimationPowerThreshold;
-        afc.mu = parameters.filterEstimationStepSize;
-        afc.afl = parameters.adaptiveFilterLength;
-        afc.wfl = parameters.signalWhiteningFilterLength;
-        afc.pfl = parameters.persistentFeedbackFilterLength;
-        afc.hdel = parameters.hardwareLatency;
-        afc.sqm = parameters.saveQualityMetric;
-        afc.fbg = parameters.gain;
-        afc.nqm = 0;
-        cha_afc_prepare(cha_pointer, &afc);
-    }
-
-    void initializeAutomaticGainControl(
-        const AutomaticGainControl &parameters
-    ) override {
-        CHA_DSL dsl{};
-        dsl.attack = parameters.attack;
-        dsl.release = parameters.release;
-        dsl.nchannel = parameters.channels;
-        copy(parameters.crossFrequencies, dsl.cross_freq);
-        copy(parameters.compressionRatios, dsl.cr);
-        copy(parameters.kneepoints, dsl.tk);
-        copy(parameters.kneepointGains, dsl.tkgain);
-        copy(parameters.broadbandOutputLimitingThresholds, dsl.bolt);
-        CHA_WDRC wdrc;
-        wdrc.attack = 1;
-        wdrc.release = 50;
-        wdrc.fs = parameters.sampleRate;
-        wdrc.maxdB = parameters.fullScaleLevel;
-        wdrc.tkgain = 0;
-        wdrc.tk = 105;
-        wdrc.cr = 10;
-        wdrc.bolt = 105;
-        cha_agc_prepare(cha_pointer, &dsl, &wdrc);
-    }
-};
-
-class ChaproFirFilter : public hearing_aid::Filter {
-    CHA_PTR cha_pointer;
-public:
-    explicit ChaproFirFilter(CHA_PTR cha_pointer) : cha_pointer{cha_pointer} {}
-    using real_signal_type = hearing_aid::real_signal_type;
-    using complex_signal_type = hearing_aid::complex_signal_type;
-    void filterbankAnalyze(real_signal_type, complex_signal_type, int) override;
-    void filterbankSynthesize(complex_signal_type, real_signal_type, int) override;
-};
-
-void ChaproFirFilter::filterbankAnalyze(
-    real_signal_type input,
-    complex_signal_type output,
-    int chunkSize
-) {
-    cha_firfb_analyze(cha_pointer, input.data(), output.data(), chunkSize);
-}
-
-void ChaproFirFilter::filterbankSynthesize(
-    complex_signal_type input,
-    real_signal_type output,
-    int chunkSize
-) {
-    cha_firfb_synthesize(cha_pointer, input.data(), output.data(), chunkSize);
-}
-
-class ChaproIirFilter : public hearing_aid::Filter {
-    CHA_PTR cha_pointer;
-public:
-    explicit ChaproIirFilter(CHA_PTR cha_pointer) : cha_pointer{cha_pointer} {}
-    using real_signal_type = hearing_aid::real_signal_type;
-    using complex_signal_type = hearing_aid::complex_signal_type;
-    void filterbankAnalyze(real_signal_type, complex_signal_type, int) override;
-    void filterbankSynthesize(complex_signal_type, real_signal_type, int) override;
-};
-
-void ChaproIirFilter::filterbankAnalyze(
-    real_signal_type input,
-    complex_signal_type output,
-    int chunkSize
-) {
-    cha_iirfb_analyze(cha_pointer, input.data(), output.data(), chunkSize);
-}
-
-void ChaproIirFilter::filterbankSynthesize(
-    complex_signal_type input,
-    real_signal_type output,
-    int chunkSize
-) {
-    cha_iirfb_synthesize(cha_pointer, input.data(), output.data(), chunkSize);
-}
-
-class ChaproFilterFactory : public hearing_aid::FilterFactory {
-    CHA_PTR cha_pointer;
-public:
-    explicit ChaproFilterFactory(CHA_PTR cha_pointer) :
-        cha_pointer{cha_pointer} {}
-
-    std::shared_ptr<hearing_aid::Filter> makeIir() override {
-        return std::make_shared<ChaproIirFilter>(cha_pointer);
-    }
-
-    std::shared_ptr<hearing_aid::Filter> makeFir() override {
-        return std::make_shared<ChaproFirFilter>(cha_pointer);
-    }
-};
-
-class Chapro : public hearing_aid::SuperSignalProcessor {
-    CHA_PTR cha_pointer;
-    const int channels_;
-    const int chunkSize_;
-public:
-    using real_signal_type = hearing_aid::real_signal_type;
-    using complex_signal_type = hearing_aid::complex_signal_type;
-    Chapro(CHA_PTR cha_pointer, const Parameters &);
-    void feedbackCancelInput(real_signal_type, real_signal_type, int) override;
-    void compressInput(real_signal_type, real_signal_type, int) override;
-    void compressChannel(complex_signal_type, complex_signal_type, int) override;
-    void compressOutput(real_signal_type, real_signal_type, int) override;
-    void feedbackCancelOutput(real_signal_type, int) override;
-    int chunkSize() override;
-    int channels() override;
-};
-
-Chapro::Chapro(CHA_PTR cha_pointer, const Parameters &parameters) :
-    cha_pointer{cha_pointer},
-    channels_{ parameters.channels },
-    chunkSize_{ parameters.chunkSize }
-{
-}
-
-void Chapro::feedbackCancelInput(
-    real_signal_type input,
-    real_signal_type output,
-    int chunkSize
-) {
-    cha_afc_input(cha_pointer, input.data(), output.data(), chunkSize);
-}
-
-void Chapro::compressInput(
-    real_signal_type input,
-    real_signal_type output,
-    int chunkSize
-) {
-    cha_agc_input(cha_pointer, input.data(), output.data(), chunkSize);
-}
-
-void Chapro::compressChannel(
-    complex_signal_type input,
-    complex_signal_type output,
-    int chunkSize
-) {
-    cha_agc_channel(cha_pointer, input.data(), output.data(), chunkSize);
-}
-
-void Chapro::compressOutput(
-    real_signal_type input,
-    real_signal_type output,
-    int chunkSize
-) {
-    cha_agc_output(cha_pointer, input.data(), output.data(), chunkSize);
-}
-
-void Chapro::feedbackCancelOutput(real_signal_type input, int chunkSize) {
-    cha_afc_output(cha_pointer, input.data(), chunkSize);
-}
-
-int Chapro::chunkSize() {
-    return chunkSize_;
-}
-
-int Chapro::channels() {
-    return channels_;
-}
+#include <chrono>
+#include <cmath>
 
 class ChaproOpenMhaPlugin : public MHAPlugin::plugin_t<int> {
+    static constexpr auto qualityRingFragments = 8192;
     void *cha_pointer[NPTR]{};
     MHAParser::vfloat_t cross_freq;
     MHAParser::vfloat_t cr;
@@ -263,6 +25,7 @@ class ChaproOpenMhaPlugin : public MHAPlugin::plugin_t<int> {
     MHAParser::vfloat_t bolt;
     MHAParser::string_t feedback_management;
     MHAParser::string_t filter_type;
+    MHAParser::string_t afc_engine;
     MHAParser::float_t attack;
     MHAParser::float_t release;
     MHAParser::float_t maxdB;
@@ -276,7 +39,54 @@ class ChaproOpenMhaPlugin : public MHAPlugin::plugin_t<int> {
     MHAParser::int_t pfl;
     MHAParser::int_t hdel;
     MHAParser::int_t nw;
-    std::unique_ptr<hearing_aid::AfcHearingAid> hearingAid;
+    MHAParser::int_t agc_interval;
+    MHAParser::string_t pipeline;
+    MHAParser::int_t band_threads;
+    MHAParser::int_t band_threshold;
+    MHAParser::vint_t pipeline_cores;
+    MHAParser::int_mon_t pipeline_latency;
+    MHAParser::int_t internal_srate;
+    MHAParser::int_mon_t resampling_latency;
+    MHAParser::string_t denormal_protection;
+    MHAParser::float_t silence_level;
+    MHAParser::float_t silence_hold;
+    MHAParser::int_t silence_update;
+    MHAParser::vfloat_mon_t afc_qm;
+    MHAParser::vfloat_mon_t afc_misalignment;
+    MHAParser::int_mon_t afc_dropped;
+    MHAParser::string_t band_export;
+    MHAParser::string_mon_t kernels;
+    MHAParser::string_t band_telemetry;
+    MHAParser::float_t band_telemetry_interval;
+    MHAParser::vfloat_mon_t band_level;
+    MHAParser::vfloat_mon_t band_gain;
+    MHAParser::string_t flight_recorder;
+    MHAParser::float_t flight_seconds;
+    MHAParser::float_t flight_deadline;
+    MHAParser::float_t flight_clip;
+    MHAParser::string_t flight_path;
+    MHAParser::int_t flight_max_dumps;
+    MHAParser::int_mon_t flight_events;
+    MHAParser::int_mon_t flight_dumps;
+    MHAParser::int_mon_t flight_suppressed;
+    MHAParser::string_mon_t flight_last;
+    MHAEvents::patchbay_t<ChaproOpenMhaPlugin> patchbay;
+    std::vector<float> pendingQualityMetric;
+    std::vector<float> pendingMisalignment;
+    std::shared_ptr<hearing_aid::FeedbackQualityTap> feedbackQualityTap;
+    std::shared_ptr<hearing_aid::BandTelemetryTap> bandTelemetry;
+    bool bandsExported{};
+    // outermost stage of hearingAid when recording
+    hearing_aid::FlightRecorder *flightRecorder{};
+    std::unique_ptr<hearing_aid::SignalProcessor> hearingAid;
+    ChaproInitializer chaproInitializer{cha_pointer};
+    ChaproFilterFactory filterFactory{cha_pointer};
+    // kept across prepares so CHAPRO is only reinitialized when its
+    // parameters change
+    hearing_aid::HearingAidBuilder builder{
+        &chaproInitializer,
+        &filterFactory
+    };
 public:
     ChaproOpenMhaPlugin(
         algo_comm_t &ac,
@@ -290,7 +100,8 @@ public:
         tkgain{"compression-start gain", "[0]", "[,]"},
         bolt{"broadband output limiting threshold", "[0]", "[,]"},
         feedback_management{"enable feedback management (yes, no)", "yes"},
-        filter_type{"filter type (FIR, IIR)", "IIR"},
+        filter_type{"filter type (FIR, FIR-MP, IIR)", "IIR"},
+        afc_engine{"feedback canceller engine (time, frequency)", "time"},
         attack{"attack time (ms)", "0", "[,]"},
         release{"release time (ms)", "0", "[,]"},
         maxdB{"maximum output (dB SPL)", "0", "[,]"},
@@ -302,8 +113,99 @@ public:
         afl{"length of adaptive-feedback-filter response", "0", "[,]"},
         wfl{"length of signal-whitening-filter response", "0", "[,]"},
         pfl{"length of persistent-feedback-filter response", "0", "[,]"},
-        hdel{"output-to-input hardware delay (samples)", "0", "[,]"},
-        nw{"window size (samples)", "0", "[,]"}
+        hdel{"output-to-input hardware delay (samples at srate)", "0", "[,]"},
+        nw{"window size (samples)", "0", "[,]"},
+        agc_interval{
+            "AGC control interval (samples), 0 for per-sample CHAPRO AGC",
+            "0",
+            "[0,]"
+        },
+        pipeline{"run stages on separate cores (yes, no)", "no"},
+        band_threads{"threads sharing channel compression", "1", "[1,]"},
+        band_threshold{
+            "fewest band samples (fragsize times channels) compressed in parallel",
+            "1024",
+            "[0,]"
+        },
+        pipeline_cores{"cores for compress, synthesize and band threads", "[]"},
+        pipeline_latency{"latency added by the pipeline (samples)"},
+        internal_srate{
+            "internal sample rate (Hz), 0 to process at the interface rate",
+            "0",
+            "[0,]"
+        },
+        resampling_latency{"latency added by resampling (samples)"},
+        denormal_protection{
+            "keep subnormal floats out of the processing state (yes, no)",
+            "yes"
+        },
+        silence_level{
+            "input level (dB SPL) below which compression is decimated, "
+            "0 to disable; needs pipeline = no",
+            "0",
+            "[0,]"
+        },
+        silence_hold{"time below silence_level before decimating (ms)", "100", "[0,]"},
+        silence_update{
+            "fragments per channel compression update during silence",
+            "8",
+            "[1,]"
+        },
+        afc_qm{
+            "AFC quality metric per fragment since the last read "
+            "(sqm, afc_engine = time)"
+        },
+        afc_misalignment{
+            "AFC misalignment (dB) per fragment since the last read; "
+            "NaN unless feedback is simulated (fbg > 0)"
+        },
+        afc_dropped{"AFC quality entries dropped while unread"},
+        band_export{
+            "publish chapro_bands and chapro_band_levels as AC variables "
+            "(yes, no; needs pipeline = no)",
+            "no"
+        },
+        kernels{
+            "instruction-set level of the filterbank, AGC and AFC kernels"
+        },
+        band_telemetry{
+            "measure band levels and compressor gains for band_level and band_gain (yes, no)",
+            "no"
+        },
+        band_telemetry_interval{
+            "time between band telemetry updates (ms)",
+            "50",
+            "[0,]"
+        },
+        band_level{"band input level (dB SPL) at the last telemetry update"},
+        band_gain{"band compressor gain (dB) at the last telemetry update"},
+        flight_recorder{
+            "keep recent fragments and dump them on overruns, NaN or clipping (yes, no)",
+            "no"
+        },
+        flight_seconds{"seconds of history in a dump", "10", "[0,]"},
+        flight_deadline{
+            "processing time, as a fraction of the fragment duration, counted as an overrun",
+            "1",
+            "[0,]"
+        },
+        flight_clip{
+            "output level (full scale) counted as clipping",
+            "1",
+            "[0,]"
+        },
+        flight_path{
+            "dump file prefix; <n>.wav and <n>.csv are appended",
+            "chapro-flight-"
+        },
+        flight_max_dumps{"most dumps written after each prepare", "10", "[0,]"},
+        flight_events{"overruns, NaN and clipping fragments recorded"},
+        flight_dumps{"dumps written"},
+        flight_suppressed{
+            "events that did not trigger a dump (pending, within one history "
+            "of the last, or past flight_max_dumps)"
+        },
+        flight_last{"last dump written, without extension"}
     {
         insert_item("cross_freq", &cross_freq);
         insert_item("cr", &cr);
@@ -312,6 +214,7 @@ public:
         insert_item("bolt", &bolt);
         insert_item("feedback_management", &feedback_management);
         insert_item("filter_type", &filter_type);
+        insert_item("afc_engine", &afc_engine);
         insert_item("attack", &attack);
         insert_item("release", &release);
         insert_item("maxdB", &maxdB);
@@ -325,6 +228,152 @@ public:
         insert_item("pfl", &pfl);
         insert_item("hdel", &hdel);
         insert_item("nw", &nw);
+        insert_item("agc_interval", &agc_interval);
+        insert_item("pipeline", &pipeline);
+        insert_item("band_threads", &band_threads);
+        insert_item("band_threshold", &band_threshold);
+        insert_item("pipeline_cores", &pipeline_cores);
+        insert_item("pipeline_latency", &pipeline_latency);
+        insert_item("internal_srate", &internal_srate);
+        insert_item("resampling_latency", &resampling_latency);
+        insert_item("denormal_protection", &denormal_protection);
+        insert_item("silence_level", &silence_level);
+        insert_item("silence_hold", &silence_hold);
+        insert_item("silence_update", &silence_update);
+        insert_item("afc_qm", &afc_qm);
+        insert_item("afc_misalignment", &afc_misalignment);
+        insert_item("afc_dropped", &afc_dropped);
+        insert_item("band_export", &band_export);
+        insert_item("kernels", &kernels);
+        kernels.data = hearing_aid::kernels().level;
+        insert_item("band_telemetry", &band_telemetry);
+        insert_item("band_telemetry_interval", &band_telemetry_interval);
+        insert_item("band_level", &band_level);
+        insert_item("band_gain", &band_gain);
+        insert_item("flight_recorder", &flight_recorder);
+        insert_item("flight_seconds", &flight_seconds);
+        insert_item("flight_deadline", &flight_deadline);
+        insert_item("flight_clip", &flight_clip);
+        insert_item("flight_path", &flight_path);
+        insert_item("flight_max_dumps", &flight_max_dumps);
+        insert_item("flight_events", &flight_events);
+        insert_item("flight_dumps", &flight_dumps);
+        insert_item("flight_suppressed", &flight_suppressed);
+        insert_item("flight_last", &flight_last);
+        patchbay.connect(
+            &afc_qm.prereadaccess,
+            this,
+            &ChaproOpenMhaPlugin::readQualityMetric
+        );
+        patchbay.connect(
+            &afc_misalignment.prereadaccess,
+            this,
+            &ChaproOpenMhaPlugin::readMisalignment
+        );
+        for (auto monitor : {&band_level, &band_gain})
+            patchbay.connect(
+                &monitor->prereadaccess,
+                this,
+                &ChaproOpenMhaPlugin::readBandTelemetry
+            );
+        for (auto monitor : {
+            static_cast<MHAParser::monitor_t *>(&flight_events),
+            static_cast<MHAParser::monitor_t *>(&flight_dumps),
+            static_cast<MHAParser::monitor_t *>(&flight_suppressed),
+            static_cast<MHAParser::monitor_t *>(&flight_last)
+        })
+            patchbay.connect(
+                &monitor->prereadaccess,
+                this,
+                &ChaproOpenMhaPlugin::readFlightRecorder
+            );
+    }
+
+    void readBandTelemetry() {
+        band_level.data.clear();
+        band_gain.data.clear();
+        if (!bandTelemetry)
+            return;
+        for (const auto &band : bandTelemetry->read()) {
+            band_level.data.push_back(band.level);
+            band_gain.data.push_back(band.gain);
+        }
+    }
+
+    void readFlightRecorder() {
+        if (!flightRecorder)
+            return;
+        flight_events.data = flightRecorder->events();
+        flight_dumps.data = flightRecorder->dumps();
+        flight_suppressed.data = flightRecorder->suppressed();
+        flight_last.data = flightRecorder->lastDump();
+    }
+
+    // Entries are drained on reading either variable and handed out by
+    // the one read; the other keeps its share for its next read.
+    void readQualityMetric() {
+        drainFeedbackQuality();
+        afc_qm.data = std::move(pendingQualityMetric);
+        pendingQualityMetric.clear();
+    }
+
+    void readMisalignment() {
+        drainFeedbackQuality();
+        afc_misalignment.data = std::move(pendingMisalignment);
+        pendingMisalignment.clear();
+    }
+
+    void drainFeedbackQuality() {
+        if (!feedbackQualityTap)
+            return;
+        feedbackQualityTap->drain([&](const hearing_aid::FeedbackQuality &q) {
+            pendingQualityMetric.push_back(q.qualityMetric);
+            pendingMisalignment.push_back(q.misalignment);
+        });
+        keepLatest(pendingQualityMetric);
+        keepLatest(pendingMisalignment);
+        afc_dropped.data = feedbackQualityTap->dropped();
+    }
+
+    static void keepLatest(std::vector<float> &v) {
+        if (v.size() > qualityRingFragments)
+            v.erase(v.begin(), v.end() - qualityRingFragments);
+    }
+
+    // The variables point into the hearing aid's analysis bands and
+    // levels, which are rewritten every fragment; nothing is copied.
+    void exportBands(hearing_aid::AfcHearingAid &afcHearingAid, int chunkSize) {
+        afcHearingAid.measureBandLevels(maxdB.data);
+        const auto bands = afcHearingAid.bands();
+        const auto levels = afcHearingAid.bandLevels();
+        comm_var_t bandsVariable{};
+        bandsVariable.data_type = MHA_AC_MHACOMPLEX;
+        bandsVariable.num_entries = gsl::narrow<unsigned int>(bands.size() / 2);
+        bandsVariable.stride = gsl::narrow<unsigned int>(chunkSize);
+        bandsVariable.data = bands.data();
+        ac.insert_var(ac.handle, "chapro_bands", bandsVariable);
+        comm_var_t levelsVariable{};
+        levelsVariable.data_type = MHA_AC_MHAREAL;
+        levelsVariable.num_entries = gsl::narrow<unsigned int>(levels.size());
+        levelsVariable.stride = levelsVariable.num_entries;
+        levelsVariable.data = levels.data();
+        ac.insert_var(ac.handle, "chapro_band_levels", levelsVariable);
+        bandsExported = true;
+    }
+
+    void removeBandVariables() {
+        if (!bandsExported)
+            return;
+        ac.remove_var(ac.handle, "chapro_bands");
+        ac.remove_var(ac.handle, "chapro_band_levels");
+        bandsExported = false;
+    }
+
+    ~ChaproOpenMhaPlugin() override {
+        removeBandVariables();
+        hearingAid.reset();
+        bandTelemetry.reset();
+        cha_cleanup(cha_pointer);
     }
 
     mha_wave_t *process(mha_wave_t * signal) {
@@ -337,10 +386,77 @@ public:
         return signal;
     }
 
+    // The frequency-domain canceller's partitions are one fragment long
+    // and transformed by a power-of-two FFT. With resampling the fragment
+    // is the internal one.
+    void validateFeedbackCanceller(int chunkSize, bool resample) {
+        using hearing_aid::FeedbackEngine;
+        if (feedback_management.data != "yes" ||
+            afc_engine.data != name(FeedbackEngine::frequencyDomain) ||
+            afl.data <= 0 ||
+            hearing_aid::isPowerOfTwo(chunkSize))
+            return;
+        if (resample)
+            throw MHA_Error(
+                __FILE__,
+                __LINE__,
+                "afc_engine = frequency needs a power-of-two internal "
+                "fragment size, not %d; use afc_engine = time or choose "
+                "fragsize and internal_srate so that fragsize * "
+                "internal_srate / srate is a power of two",
+                chunkSize
+            );
+        throw MHA_Error(
+            __FILE__,
+            __LINE__,
+            "afc_engine = frequency needs a power-of-two fragment size, "
+            "not %d; use afc_engine = time or change fragsize",
+            chunkSize
+        );
+    }
+
+    // The pipelined hearing aid hands band buffers between threads, so
+    // there is no fragment's analysis to publish.
+    void validateBandExport() {
+        if (band_export.data == "yes" && pipeline.data == "yes")
+            throw MHA_Error(
+                __FILE__,
+                __LINE__,
+                "band_export = yes needs pipeline = no"
+            );
+    }
+
+    // The activity gate decides on the calling thread and publishes one
+    // mode that the pipeline's compress stage would read for another
+    // fragment.
+    void validateActivityGate() {
+        if (silence_level.data > 0 && pipeline.data == "yes")
+            throw MHA_Error(
+                __FILE__,
+                __LINE__,
+                "silence_level > 0 needs pipeline = no"
+            );
+    }
+
     void prepare(mhaconfig_t &configuration) override {
+        hearing_aid::ResamplingHearingAid::Parameters resampling;
+        resampling.externalRate = gsl::narrow_cast<int>(configuration.srate);
+        resampling.internalRate = internal_srate.data;
+        resampling.externalChunkSize = configuration.fragsize;
+        // flat to 6.4 kHz at 16 kHz, nothing aliased above 70 dB down
+        resampling.passband = 0.8;
+        resampling.stopbandAttenuation = 70;
+        const auto resample = internal_srate.data > 0 &&
+            internal_srate.data != resampling.externalRate;
+        const auto chunkSize = resample ?
+            hearing_aid::ResamplingHearingAid::internalChunkSize(resampling) :
+            gsl::narrow_cast<int>(configuration.fragsize);
+        validateFeedbackCanceller(chunkSize, resample);
+        validateBandExport();
+        validateActivityGate();
         hearing_aid::HearingAidBuilder::Parameters q;
-        q.sampleRate = configuration.srate;
-        q.chunkSize = configuration.fragsize;
+        q.sampleRate = resample ? internal_srate.data : configuration.srate;
+        q.chunkSize = chunkSize;
         q.attack = attack.data;
         q.release = release.data;
         q.fullScaleLevel = maxdB.data;
@@ -348,14 +464,35 @@ public:
         q.filterEstimationForgettingFactor = rho.data;
         q.filterEstimationPowerThreshold = eps.data;
         q.feedbackGain = fbg.data;
-        q.saveQualityMetric = sqm.data;
+        // Only CHAPRO's time-domain canceller saves a quality metric.
+        const auto monitorFeedback = sqm.data != 0 &&
+            feedback_management.data == name(hearing_aid::Feedback::on) &&
+            afc_engine.data == name(hearing_aid::FeedbackEngine::timeDomain);
+        q.saveQualityMetric = monitorFeedback ? sqm.data : 0;
+        // rewound by the feedback monitor after every fragment
+        q.qualityMetricLength = monitorFeedback ? 1 : 0;
         q.adaptiveFeedbackFilterLength = afl.data;
         q.signalWhiteningFilterLength = wfl.data;
         q.persistentFeedbackFilterLength = pfl.data;
-        q.hardwareLatency = hdel.data;
+        // The loop the canceller sees also runs through the converters.
+        q.hardwareLatency = resample ?
+            gsl::narrow_cast<int>(std::lround(
+                (hdel.data +
+                    hearing_aid::ResamplingHearingAid::latencySamples(
+                        resampling
+                    )) *
+                static_cast<double>(internal_srate.data) /
+                resampling.externalRate
+            )) :
+            hdel.data;
         q.windowSize = nw.data;
+        q.controlInterval = agc_interval.data;
+        q.silenceLevel = silence_level.data;
+        q.silenceHold = silence_hold.data;
+        q.silenceUpdateInterval = silence_update.data;
         q.filterType = filter_type.data;
         q.feedback = feedback_management.data;
+        q.feedbackEngine = afc_engine.data;
         q.compressionRatios = {cr.data.begin(), cr.data.end()};
         q.broadbandOutputLimitingThresholds =
             {bolt.data.begin(), bolt.data.end()};
@@ -366,19 +503,131 @@ public:
         q.kneepoints =
             {tk.data.begin(), tk.data.end()};
         hearing_aid::SuperSignalProcessor::Parameters p;
-        p.chunkSize = configuration.fragsize;
+        p.chunkSize = chunkSize;
         p.channels = cross_freq.data.size() + 1;
-        cha_cleanup(cha_pointer); // releases memory, assumes double cleanup is safe
-        ChaproInitializer chaproInitializer{cha_pointer};
-        ChaproFilterFactory filterFactory{cha_pointer};
-        hearing_aid::HearingAidBuilder builder{
-            &chaproInitializer,
-            &filterFactory
-        };
-        builder.build(q); // acquires memory
-        hearingAid = std::make_unique<hearing_aid::AfcHearingAid>(
-            std::make_unique<Chapro>(cha_pointer, p), builder.filter()
-        );
+        removeBandVariables();
+        flightRecorder = nullptr;
+        bandTelemetry.reset();
+        hearingAid.reset(); // stops pipeline threads before reinitializing
+        builder.build(q); // reinitializes only the changed components
+        std::shared_ptr<hearing_aid::SuperSignalProcessor> backend =
+            std::make_shared<Chapro>(cha_pointer, p);
+        drainFeedbackQuality();
+        feedbackQualityTap.reset();
+        if (monitorFeedback) {
+            feedbackQualityTap =
+                std::make_shared<hearing_aid::FeedbackQualityTap>(
+                    std::move(backend),
+                    std::make_shared<ChaproFeedbackMonitor>(
+                        cha_pointer,
+                        fbg.data > 0
+                    ),
+                    qualityRingFragments
+                );
+            backend = feedbackQualityTap;
+        }
+        auto processor = builder.processor(std::move(backend));
+        if (band_telemetry.data == "yes") {
+            hearing_aid::BandTelemetryTap::Parameters telemetry;
+            telemetry.fullScaleLevel = maxdB.data;
+            telemetry.interval = gsl::narrow_cast<int>(std::lround(
+                band_telemetry_interval.data * q.sampleRate / 1000 / chunkSize
+            ));
+            bandTelemetry = hearing_aid::BandTelemetryTap::make(
+                std::move(processor),
+                telemetry
+            );
+            processor = bandTelemetry;
+        }
+        const auto protectFromDenormals = denormal_protection.data == "yes";
+        const auto record = flight_recorder.data == "yes";
+        // worker threads stay awake between fragments
+        const auto fragmentPeriod =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::duration<double>{chunkSize / q.sampleRate}
+            );
+        std::shared_ptr<hearing_aid::StageTimer> stageTimer;
+        pipeline_latency.data = 0;
+        if (pipeline.data == "yes") {
+            hearing_aid::PipelinedHearingAid::Parameters pipelined;
+            pipelined.cores = pipeline_cores.data;
+            pipelined.bandThreads = band_threads.data;
+            pipelined.flushDenormals = protectFromDenormals;
+            pipelined.spin = fragmentPeriod;
+            auto pipelinedHearingAid =
+                std::make_unique<hearing_aid::PipelinedHearingAid>(
+                    std::move(processor),
+                    builder.filter(),
+                    pipelined
+                );
+            pipeline_latency.data = pipelinedHearingAid->latencySamples();
+            hearingAid = std::move(pipelinedHearingAid);
+        } else {
+            if (band_threads.data > 1)
+                processor =
+                    std::make_shared<hearing_aid::BandParallelCompressor>(
+                        std::move(processor),
+                        hearing_aid::BandParallelCompressor::Parameters{
+                            {},
+                            band_threads.data,
+                            band_threshold.data,
+                            protectFromDenormals,
+                            fragmentPeriod
+                        }
+                    );
+            auto filter = builder.filter();
+            // Stages of the pipelined hearing aid run on several threads
+            // and are not timed.
+            if (record) {
+                stageTimer = std::make_shared<hearing_aid::StageTimer>(
+                    std::move(processor),
+                    std::move(filter)
+                );
+                processor = stageTimer;
+                filter = stageTimer;
+            }
+            auto afcHearingAid =
+                std::make_unique<hearing_aid::AfcHearingAid>(
+                    std::move(processor),
+                    std::move(filter)
+                );
+            if (band_export.data == "yes")
+                exportBands(*afcHearingAid, chunkSize);
+            hearingAid = std::move(afcHearingAid);
+        }
+        resampling_latency.data = 0;
+        if (resample) {
+            auto resamplingHearingAid =
+                std::make_unique<hearing_aid::ResamplingHearingAid>(
+                    std::move(hearingAid),
+                    resampling
+                );
+            resampling_latency.data = resamplingHearingAid->latencySamples();
+            hearingAid = std::move(resamplingHearingAid);
+        }
+        if (protectFromDenormals)
+            hearingAid =
+                std::make_unique<hearing_aid::DenormalProtectedHearingAid>(
+                    std::move(hearingAid)
+                );
+        if (record) {
+            hearing_aid::FlightRecorder::Parameters recording;
+            recording.path = flight_path.data;
+            recording.seconds = flight_seconds.data;
+            recording.sampleRate = configuration.srate;
+            recording.deadline = flight_deadline.data;
+            recording.clippingLevel = flight_clip.data;
+            recording.chunkSize =
+                gsl::narrow_cast<int>(configuration.fragsize);
+            recording.maxDumps = flight_max_dumps.data;
+            auto recorder = std::make_unique<hearing_aid::FlightRecorder>(
+                std::move(hearingAid),
+                std::move(stageTimer),
+                recording
+            );
+            flightRecorder = recorder.get();
+            hearingAid = std::move(recorder);
+        }
     }
 };
 
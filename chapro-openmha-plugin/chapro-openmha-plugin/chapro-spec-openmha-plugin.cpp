@@ -0,0 +1,105 @@
+#include "mha_plugin.hh"
+#include <hearing-aid/SpectralCompressor.h>
+#include <gsl/gsl>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// Channel compression on openMHA's own STFT, for chains where the
+// neighbouring plugins are spectral too. Bins are grouped into bands at
+// cross_freq, so no second filterbank analysis and synthesis is run.
+// Feedback management and broadband compression need the time signal
+// and are only available in the chapro plugin.
+class ChaproSpectralOpenMhaPlugin : public MHAPlugin::plugin_t<int> {
+    MHAParser::vfloat_t cross_freq;
+    MHAParser::vfloat_t cr;
+    MHAParser::vfloat_t tk;
+    MHAParser::vfloat_t tkgain;
+    MHAParser::vfloat_t bolt;
+    MHAParser::float_t attack;
+    MHAParser::float_t release;
+    MHAParser::float_t maxdB;
+    MHAParser::string_t wndtype;
+    MHAParser::float_t wndexp;
+    std::vector<hearing_aid::SpectralCompressor> compressors;
+public:
+    ChaproSpectralOpenMhaPlugin(
+        algo_comm_t &ac,
+        const std::string &,
+        const std::string &
+    ) :
+        MHAPlugin::plugin_t<int>{{}, ac},
+        cross_freq{"cross frequencies (Hz)", "[0]", "[,]"},
+        cr{"compression ratio", "[0]", "[,]"},
+        tk{"compression-start kneepoint", "[0]", "[,]"},
+        tkgain{"compression-start gain", "[0]", "[,]"},
+        bolt{"broadband output limiting threshold", "[0]", "[,]"},
+        attack{"attack time (ms)", "0", "[,]"},
+        release{"release time (ms)", "0", "[,]"},
+        maxdB{"maximum output (dB SPL)", "0", "[,]"},
+        wndtype{"analysis window type, as set in wave2spec", "hanning"},
+        wndexp{"analysis window exponent, as set in wave2spec", "1", "[0,]"}
+    {
+        insert_item("cross_freq", &cross_freq);
+        insert_item("cr", &cr);
+        insert_item("tk", &tk);
+        insert_item("tkgain", &tkgain);
+        insert_item("bolt", &bolt);
+        insert_item("attack", &attack);
+        insert_item("release", &release);
+        insert_item("maxdB", &maxdB);
+        insert_item("wndtype", &wndtype);
+        insert_item("wndexp", &wndexp);
+    }
+
+    mha_spec_t *process(mha_spec_t *signal) {
+        const auto frames = signal->num_frames;
+        const auto channels = signal->num_channels;
+        for (unsigned int channel = 0; channel < channels; ++channel)
+            compressors[channel].process({
+                &signal->buf[channel * frames].re,
+                gsl::narrow<hearing_aid::complex_signal_type::index_type>(
+                    2 * frames
+                )
+            });
+        return signal;
+    }
+
+    void prepare(mhaconfig_t &configuration) override {
+        if (configuration.domain != MHA_SPECTRUM)
+            throw MHA_Error(
+                __FILE__,
+                __LINE__,
+                "chapro_spec processes spectra; use chapro for waveforms"
+            );
+        hearing_aid::SpectralCompressor::Parameters p{};
+        p.fitting.compressionRatios = {cr.data.begin(), cr.data.end()};
+        p.fitting.kneepoints = {tk.data.begin(), tk.data.end()};
+        p.fitting.kneepointGains = {tkgain.data.begin(), tkgain.data.end()};
+        p.fitting.broadbandOutputLimitingThresholds =
+            {bolt.data.begin(), bolt.data.end()};
+        p.fitting.attack = attack.data;
+        p.fitting.release = release.data;
+        p.fitting.sampleRate = configuration.srate;
+        p.fitting.fullScaleLevel = maxdB.data;
+        p.crossFrequencies = {cross_freq.data.begin(), cross_freq.data.end()};
+        try {
+            p.window = hearing_aid::analysisWindow(
+                wndtype.data,
+                gsl::narrow<int>(configuration.wndlen),
+                wndexp.data
+            );
+        } catch (const std::invalid_argument &e) {
+            throw MHA_Error(__FILE__, __LINE__, e.what());
+        }
+        p.fftLength = gsl::narrow<int>(configuration.fftlen);
+        p.hopSize = gsl::narrow<int>(configuration.fragsize);
+        compressors.assign(
+            configuration.channels,
+            hearing_aid::SpectralCompressor{p}
+        );
+    }
+};
+
+MHAPLUGIN_CALLBACKS(chapro_spec, ChaproSpectralOpenMhaPlugin, spec, spec)
+MHAPLUGIN_DOCUMENTATION(chapro_spec, "text", "here")
@@ -0,0 +1,123 @@
+#include <chapro-backend/ChaproSweep.h>
+#include <hearing-aid/CostExplorer.h>
+#include <hearing-aid/FittingConfiguration.h>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Searches the fittings around an openMHA configuration (for example
+// chapro.cfg) for the ones that cost the most per fragment on this
+// machine, and prints them as JSON, costliest first. Load is the 99th
+// percentile fragment time over the fragment duration; at 1 the
+// fitting misses its deadline one fragment in a hundred. With --budget
+// the exit status is 2 when any fitting's load exceeds it.
+namespace {
+using hearing_aid::CostExplorer;
+
+std::string quoted(const std::string &s) {
+    std::string q{"\""};
+    for (auto c : s) {
+        if (c == '"' || c == '\\')
+            q += '\\';
+        q += c;
+    }
+    return q + '"';
+}
+
+void print(
+    const std::string &configuration,
+    const std::vector<CostExplorer::Result> &results,
+    std::size_t top,
+    double budget
+) {
+    const auto microseconds = [](std::uint64_t nanoseconds) {
+        return nanoseconds / 1e3;
+    };
+    std::cout << "{\n"
+        << "  \"configuration\": " << quoted(configuration) << ",\n"
+        << "  \"evaluated\": " << results.size() << ",\n"
+        << "  \"fittings\": [";
+    for (std::size_t i = 0; i < std::min(top, results.size()); ++i) {
+        const auto &r = results[i];
+        const auto &f = r.fitting;
+        std::cout << (i ? ",\n" : "\n")
+            << "    {\"rank\": " << i + 1
+            << ", \"load\": " << r.load
+            << ", \"p50Microseconds\": " << microseconds(r.cost.percentile(0.5))
+            << ", \"p99Microseconds\": "
+            << microseconds(r.cost.percentile(0.99))
+            << ", \"maxMicroseconds\": " << microseconds(r.cost.max())
+            << ",\n     \"bands\": " << f.crossFrequencies.size() + 1
+            << ", \"nw\": " << f.windowSize
+            << ", \"afl\": " << f.adaptiveFeedbackFilterLength
+            << ", \"wfl\": " << f.signalWhiteningFilterLength
+            << ", \"pfl\": " << f.persistentFeedbackFilterLength
+            << ", \"chunkSize\": " << f.chunkSize
+            << ", \"filterType\": " << quoted(f.filterType);
+        if (budget > 0)
+            std::cout << ", \"overBudget\": "
+                << (r.load > budget ? "true" : "false");
+        std::cout << "}";
+    }
+    std::cout << "\n  ]";
+    if (budget > 0)
+        std::cout << ",\n  \"budget\": " << budget
+            << ",\n  \"pass\": "
+            << (results.empty() || results.front().load <= budget
+                ? "true" : "false");
+    std::cout << "\n}\n";
+}
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || argc % 2 != 0) {
+        std::cerr << "usage: cost-explorer config.cfg [--seconds s]"
+            " [--level dB] [--rounds n] [--top n] [--budget load]\n";
+        return 1;
+    }
+    CostExplorer::Parameters parameters{};
+    parameters.seconds = 2;
+    parameters.level = 65;
+    parameters.rounds = 3;
+    std::size_t top = 10;
+    double budget = 0;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        const std::string option{argv[i]};
+        if (option == "--seconds")
+            parameters.seconds = std::atof(argv[i + 1]);
+        else if (option == "--level")
+            parameters.level = std::atof(argv[i + 1]);
+        else if (option == "--rounds")
+            parameters.rounds = std::atoi(argv[i + 1]);
+        else if (option == "--top")
+            top = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (option == "--budget")
+            budget = std::atof(argv[i + 1]);
+        else {
+            std::cerr << "unknown option: " << option << '\n';
+            return 1;
+        }
+    }
+    std::ifstream file{argv[1]};
+    if (!file) {
+        std::cerr << "cannot read " << argv[1] << '\n';
+        return 1;
+    }
+    const auto fitting = hearing_aid::readFitting(file);
+    CostExplorer::Space space{};
+    space.bands = {4, 8, 16, 32};
+    space.windowSizes = {64, 128, 256, 512};
+    space.adaptiveFeedbackFilterLengths = {0, 64, 128, 256};
+    space.signalWhiteningFilterLengths = {0, 16, 32};
+    space.persistentFeedbackFilterLengths = {0, 32, 64};
+    space.chunkSizes = {16, 32, 64, 128};
+    space.filterTypes = {"FIR", "FIR-MP", "IIR"};
+    ChaproSweepBackend backend;
+    CostExplorer explorer{&backend, parameters};
+    const auto results = explorer.explore(fitting, space);
+    print(argv[1], results, top, budget);
+    return budget > 0 && !results.empty() && results.front().load > budget
+        ? 2 : 0;
+}
@@ -0,0 +1,196 @@
+#include <chapro-backend/Chapro.h>
+#include <hearing-aid/FittingConfiguration.h>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+// Runs the CHAPRO-backed hearing aid over the reference input for every
+// filter type with and without feedback management and compares the
+// output with the golden output, both kept under golden/. A missing file,
+// or a golden output equal to the input, is a failure. Run with
+// CHAPRO_GOLDEN_UPDATE=1 against CHAPRO to record the golden outputs, and
+// again after an intended change in output.
+namespace hearing_aid::golden_tests { namespace {
+constexpr auto sampleRate = 44100;
+constexpr auto chunkSize = 64;
+constexpr auto fragments = 345;
+constexpr auto minimumSnrDecibels = 60.;
+
+struct Configuration {
+    std::string filterType;
+    std::string feedback;
+};
+
+std::string name(const Configuration &c) {
+    return c.filterType + "-afc-" + (c.feedback == "yes" ? "on" : "off");
+}
+
+// The chapro.cfg fitting with the configuration's filter type and
+// feedback management, at the rate and fragment size of the input.
+HearingAidBuilder::Parameters parameters(const Configuration &c) {
+    auto p = readFitting(std::string{CHAPRO_CONFIGURATION});
+    p.filterType = c.filterType;
+    p.feedback = c.feedback;
+    p.sampleRate = sampleRate;
+    p.chunkSize = chunkSize;
+    return p;
+}
+
+// Deterministic noise plus an amplitude-modulated 1 kHz tone, loud
+// enough to reach every compressor's kneepoint.
+std::vector<real_type> generatedInput() {
+    std::vector<real_type> x(chunkSize * fragments);
+    std::uint32_t state = 1;
+    const auto pi = std::acos(-1.);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        state = 1664525 * state + 1013904223;
+        const auto noise = static_cast<double>(state >> 8) / (1 << 23) - 1;
+        const auto envelope = 0.5 + 0.5 * std::sin(2 * pi * 4 * i / sampleRate);
+        const auto tone = std::sin(2 * pi * 1000 * i / sampleRate);
+        x[i] = static_cast<real_type>(0.01 * noise + 0.05 * envelope * tone);
+    }
+    return x;
+}
+
+std::vector<real_type> process(
+    const Configuration &c,
+    std::vector<real_type> signal
+) {
+    void *cha_pointer[NPTR]{};
+    ChaproInitializer initializer{cha_pointer};
+    ChaproFilterFactory filterFactory{cha_pointer};
+    HearingAidBuilder builder{&initializer, &filterFactory};
+    const auto p = parameters(c);
+    builder.build(p);
+    SuperSignalProcessor::Parameters s;
+    s.chunkSize = chunkSize;
+    s.channels = static_cast<int>(p.crossFrequencies.size()) + 1;
+    {
+        AfcHearingAid hearingAid{
+            builder.processor(std::make_shared<Chapro>(cha_pointer, s)),
+            builder.filter()
+        };
+        for (int i = 0; i < fragments; ++i)
+            hearingAid.process({signal.data() + i * chunkSize, chunkSize});
+    }
+    cha_cleanup(cha_pointer);
+    return signal;
+}
+
+std::string goldenPath(const Configuration &c) {
+    return std::string{GOLDEN_DIRECTORY} + "/" + name(c) + ".f32";
+}
+
+std::string inputPath() {
+    return std::string{GOLDEN_DIRECTORY} + "/input.f32";
+}
+
+bool updating() {
+    return std::getenv("CHAPRO_GOLDEN_UPDATE") != nullptr;
+}
+
+// The input and golden outputs are raw native-endian 32-bit floats.
+bool read(const std::string &path, std::vector<real_type> &x) {
+    std::ifstream file{path, std::ios::binary};
+    if (!file)
+        return false;
+    file.seekg(0, std::ios::end);
+    x.resize(static_cast<std::size_t>(file.tellg()) / sizeof(real_type));
+    file.seekg(0);
+    file.read(
+        reinterpret_cast<char *>(x.data()),
+        static_cast<std::streamsize>(x.size() * sizeof(real_type))
+    );
+    return static_cast<bool>(file);
+}
+
+void write(const std::string &path, const std::vector<real_type> &x) {
+    std::ofstream file{path, std::ios::binary};
+    file.write(
+        reinterpret_cast<const char *>(x.data()),
+        static_cast<std::streamsize>(x.size() * sizeof(real_type))
+    );
+}
+
+double snrDecibels(
+    const std::vector<real_type> &reference,
+    const std::vector<real_type> &x
+) {
+    double signal = 0;
+    double error = 0;
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+        signal += reference[i] * reference[i];
+        const auto e = static_cast<double>(reference[i]) - x[i];
+        error += e * e;
+    }
+    if (error == 0)
+        return INFINITY;
+    return 10 * std::log10(signal / error);
+}
+
+class GoldenOutputTests : public ::testing::TestWithParam<Configuration> {
+protected:
+    std::vector<real_type> input;
+
+    void SetUp() override {
+        if (updating()) {
+            input = generatedInput();
+            write(inputPath(), input);
+        } else {
+            ASSERT_TRUE(read(inputPath(), input))
+                << "no reference input at " << inputPath()
+                << "; record one with CHAPRO_GOLDEN_UPDATE=1";
+            ASSERT_EQ(std::size_t{chunkSize * fragments}, input.size());
+        }
+    }
+};
+
+TEST_P(GoldenOutputTests, matchesGoldenOutput) {
+    const auto output = process(GetParam(), input);
+    const auto path = goldenPath(GetParam());
+    // A hearing aid that returns its input would make the comparison
+    // meaningless; such an output is neither recorded nor accepted.
+    if (updating()) {
+        ASSERT_NE(input, output)
+            << "the output equals the input; record with a CHAPRO that "
+            "processes the signal";
+        write(path, output);
+        return;
+    }
+    std::vector<real_type> golden;
+    ASSERT_TRUE(read(path, golden))
+        << "no golden output at " << path
+        << "; record one with CHAPRO_GOLDEN_UPDATE=1";
+    ASSERT_NE(input, golden)
+        << path << " equals the input and was not recorded with CHAPRO";
+    ASSERT_EQ(golden.size(), output.size());
+    for (const auto x : output)
+        ASSERT_TRUE(std::isfinite(x));
+    EXPECT_GE(snrDecibels(golden, output), minimumSnrDecibels);
+}
+
+TEST_P(GoldenOutputTests, isDeterministic) {
+    EXPECT_EQ(process(GetParam(), input), process(GetParam(), input));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ChaproConfigurations,
+    GoldenOutputTests,
+    ::testing::Values(
+        Configuration{"FIR", "no"},
+        Configuration{"FIR", "yes"},
+        Configuration{"IIR", "no"},
+        Configuration{"IIR", "yes"}
+    ),
+    [](const ::testing::TestParamInfo<Configuration> &info) {
+        auto n = name(info.param);
+        for (auto &c : n)
+            if (c == '-')
+                c = '_';
+        return n;
+    }
+);
+}}
@@ -0,0 +1,231 @@
+#include "LogString.h"
+#include "assert-utility.h"
+#include <hearing-aid/ActivityGate.h>
+#include <gtest/gtest.h>
+
+namespace hearing_aid::tests { namespace {
+class ScalingProcessor : public SuperSignalProcessor {
+    LogString log_;
+    real_type gain_{1};
+    int compressions_{};
+    int chunkSize_;
+    int channels_;
+public:
+    ScalingProcessor(int chunkSize, int channels) :
+        chunkSize_{chunkSize},
+        channels_{channels} {}
+
+    auto &log() const {
+        return log_;
+    }
+
+    void setGain(real_type g) {
+        gain_ = g;
+    }
+
+    int compressions() const {
+        return compressions_;
+    }
+
+    void feedbackCancelInput(
+        real_signal_type,
+        real_signal_type,
+        int
+    ) override {
+        log_.insert("feedbackCancelInput");
+    }
+
+    void compressInput(real_signal_type, real_signal_type, int) override {
+        log_.insert("compressInput");
+    }
+
+    void compressChannel(
+        complex_signal_type input,
+        complex_signal_type output,
+        int
+    ) override {
+        ++compressions_;
+        for (decltype(input.size()) i = 0; i < input.size(); ++i)
+            output[i] = gain_ * input[i];
+    }
+
+    void compressOutput(real_signal_type, real_signal_type, int) override {
+        log_.insert("compressOutput");
+    }
+
+    void feedbackCancelOutput(real_signal_type, int) override {
+        log_.insert("feedbackCancelOutput");
+    }
+
+    int chunkSize() override {
+        return chunkSize_;
+    }
+
+    int channels() override {
+        return channels_;
+    }
+};
+
+// Counts the bands each range call compressed.
+class BandScalingProcessor : public ScalingProcessor, public BandCompressor {
+public:
+    std::vector<int> bandCompressions;
+
+    BandScalingProcessor(int chunkSize, int channels) :
+        ScalingProcessor{chunkSize, channels},
+        bandCompressions(channels) {}
+
+    void compressChannels(
+        complex_signal_type input,
+        complex_signal_type output,
+        int chunkSize,
+        int first,
+        int n
+    ) override {
+        for (int k = first; k < first + n; ++k) {
+            ++bandCompressions[k];
+            for (int i = 2 * chunkSize * k; i < 2 * chunkSize * (k + 1); ++i)
+                output[i] = 2 * input[i];
+        }
+    }
+};
+
+class ActivityGateTests : public ::testing::Test {
+protected:
+    using buffer_type = std::vector<real_type>;
+    static constexpr auto chunkSize = 4;
+    static constexpr auto quiet = real_type{1e-4};
+    static constexpr auto loud = real_type{0.1};
+    std::shared_ptr<ScalingProcessor> processor =
+        std::make_shared<ScalingProcessor>(chunkSize, 2);
+    ActivityGate::Parameters p{};
+
+    ActivityGateTests() {
+        p.silenceLevel = 40;
+        p.fullScaleLevel = 100;
+        p.holdFragments = 2;
+        p.updateInterval = 4;
+    }
+
+    ActivityGate make() {
+        return ActivityGate{processor, p};
+    }
+
+    buffer_type process(ActivityGate &gate, real_type level, int fragments = 1) {
+        buffer_type input(chunkSize, level);
+        buffer_type bands(2 * chunkSize * 2);
+        for (int n = 0; n < fragments; ++n) {
+            std::fill(bands.begin(), bands.end(), real_type{1});
+            gate.feedbackCancelInput(input, input, chunkSize);
+            gate.compressChannel(bands, bands, chunkSize);
+        }
+        return bands;
+    }
+};
+
+TEST_F(ActivityGateTests, forwardsFeedbackCancellationAndBroadbandCompression) {
+    auto gate = make();
+    buffer_type x(chunkSize);
+    gate.feedbackCancelInput(x, x, chunkSize);
+    gate.compressInput(x, x, chunkSize);
+    gate.compressOutput(x, x, chunkSize);
+    gate.feedbackCancelOutput(x, chunkSize);
+    assertEqual(
+        "feedbackCancelInput"
+        "compressInput"
+        "compressOutput"
+        "feedbackCancelOutput",
+        processor->log()
+    );
+}
+
+TEST_F(ActivityGateTests, activeInputCompressesEveryFragment) {
+    auto gate = make();
+    process(gate, loud, 10);
+    assertFalse(gate.reduced());
+    assertEqual(10, processor->compressions());
+}
+
+TEST_F(ActivityGateTests, entersReducedModeAfterHoldFragments) {
+    auto gate = make();
+    process(gate, quiet);
+    assertFalse(gate.reduced());
+    process(gate, quiet);
+    assertTrue(gate.reduced());
+}
+
+TEST_F(ActivityGateTests, reducedModeCompressesEveryUpdateInterval) {
+    auto gate = make();
+    process(gate, quiet, 2 + 8);
+    assertEqual(1 + 2, processor->compressions());
+}
+
+TEST_F(ActivityGateTests, reducedModeAppliesHeldBandGains) {
+    p.holdFragments = 1;
+    processor->setGain(2);
+    auto gate = make();
+    process(gate, loud);
+    processor->setGain(5);
+    auto bands = process(gate, quiet, 3);
+    assertEqual(1, processor->compressions());
+    for (auto x : bands)
+        EXPECT_NEAR(2, x, 1e-6);
+}
+
+TEST_F(ActivityGateTests, resumesWithinOneFragment) {
+    processor->setGain(2);
+    auto gate = make();
+    process(gate, quiet, 3);
+    processor->setGain(3);
+    auto bands = process(gate, loud);
+    assertFalse(gate.reduced());
+    EXPECT_NEAR(2.25, bands.front(), 1e-6);
+    EXPECT_NEAR(3, bands.back(), 1e-6);
+    bands = process(gate, loud);
+    EXPECT_NEAR(3, bands.front(), 1e-6);
+}
+
+TEST_F(ActivityGateTests, isBandCompressorOnlyWhenDecoratedOneIs) {
+    assertTrue(
+        std::dynamic_pointer_cast<BandCompressor>(
+            ActivityGate::make(processor, p)
+        ) == nullptr
+    );
+    assertTrue(
+        std::dynamic_pointer_cast<BandCompressor>(ActivityGate::make(
+            std::make_shared<BandScalingProcessor>(chunkSize, 2),
+            p
+        )) != nullptr
+    );
+}
+
+TEST_F(ActivityGateTests, gatesBandRanges) {
+    p.holdFragments = 1;
+    auto bandProcessor = std::make_shared<BandScalingProcessor>(chunkSize, 2);
+    auto gate = ActivityGate::make(bandProcessor, p);
+    auto bandGate = std::dynamic_pointer_cast<BandCompressor>(gate);
+    buffer_type input(chunkSize, loud);
+    buffer_type bands(2 * chunkSize * 2, 1);
+    gate->feedbackCancelInput(input, input, chunkSize);
+    bandGate->compressChannels(bands, bands, chunkSize, 1, 1);
+    assertEqual(std::vector<int>{0, 1}, bandProcessor->bandCompressions);
+    EXPECT_NEAR(1, bands.front(), 1e-6);
+    EXPECT_NEAR(2, bands.back(), 1e-6);
+    std::fill(input.begin(), input.end(), quiet);
+    std::fill(bands.begin(), bands.end(), real_type{1});
+    gate->feedbackCancelInput(input, input, chunkSize);
+    for (int k = 0; k < 2; ++k)
+        bandGate->compressChannels(bands, bands, chunkSize, k, 1);
+    assertTrue(gate->reduced());
+    assertEqual(std::vector<int>{0, 1}, bandProcessor->bandCompressions);
+    EXPECT_NEAR(2, bands.back(), 1e-6);
+}
+
+TEST_F(ActivityGateTests, zeroSilenceLevelNeverReduces) {
+    p.silenceLevel = 0;
+    auto gate = make();
+    process(gate, 0, 10);
+    assertFalse(gate.reduced());
+    assertEqual(10, processor->compressions());
+}
+}}
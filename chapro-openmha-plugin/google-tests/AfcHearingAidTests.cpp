@@ -2,6 +2,8 @@
 #include "assert-utility.h"
 #include <hearing-aid/AfcHearingAid.h>
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
 
 namespace hearing_aid::tests { namespace {
 class SuperSignalProcessorStub : public SuperSignalProcessor, public Filter {
@@ -19,7 +21,8 @@ class SuperSignalProcessorStub : public SuperSignalProcessor, public Filter {
     real_signal_type compressOutputInput_;
     real_signal_type compressOutputOutput_;
     real_signal_type feedbackCancelOutputInput_;
-    int chunkSize_;
+    complex_type analysisValue_{};
+    int chunkSize_{};
     int feedbackCancelInputChunkSize_;
     int compressInputChunkSize_;
     int filterbankAnalyzeChunkSize_;
@@ -27,8 +30,12 @@ class SuperSignalProcessorStub : public SuperSignalProcessor, public Filter {
     int filterbankSynthesizeChunkSize_;
     int compressOutputChunkSize_;
     int feedbackCancelOutputChunkSize_;
-    int channels_;
+    int channels_{};
 public:
+    void setAnalysisValue(complex_type x) {
+        analysisValue_ = x;
+    }
+
     auto feedbackCancelInputInput() {
         return feedbackCancelInputInput_;
     }
@@ -136,6 +143,7 @@ public:
         complex_signal_type b,
         int c
     ) override {
+        std::fill(b.begin(), b.end(), analysisValue_);
         filterbankAnalyzeInput_ = a;
         filterbankAnalyzeOutput_ = b;
         filterbankAnalyzeChunkSize_ = c;
@@ -247,15 +255,11 @@ protected:
         assertEqual(c, superSignalProcessor->filterbankSynthesizeInput().size());
     }
 
-    void assertEachComplexBufferEqual() {
+    void assertComplexBuffersHandedOn() {
         assertEqual(
             superSignalProcessor->compressChannelInput(),
             superSignalProcessor->filterbankAnalyzeOutput()
         );
-        assertEqual(
-            superSignalProcessor->compressChannelOutput(),
-            superSignalProcessor->compressChannelInput()
-        );
         assertEqual(
             superSignalProcessor->filterbankSynthesizeInput(),
             superSignalProcessor->compressChannelOutput()
@@ -315,12 +319,12 @@ TEST_F(
 
 TEST_F(
     AfcHearingAidTests,
-    eachComplexBufferIsEqual
+    complexBuffersAreHandedOn
 ) {
     setChunkSize(3);
     setChannels(5);
     process();
-    assertEachComplexBufferEqual();
+    assertComplexBuffersHandedOn();
 }
 
 TEST_F(
@@ -332,4 +336,63 @@ TEST_F(
     process(x);
     assertEachRealBufferEquals(x);
 }
+
+TEST_F(AfcHearingAidTests, bandsAreTheAnalysisBuffer) {
+    setChunkSize(3);
+    setChannels(5);
+    AfcHearingAid hearingAid{superSignalProcessor, superSignalProcessor};
+    buffer_type x(3);
+    hearingAid.process(x);
+    assertEqual(
+        superSignalProcessor->filterbankAnalyzeOutput().data(),
+        hearingAid.bands().data()
+    );
+    assertEqual(
+        complex_signal_type::index_type{2 * 3 * 5},
+        hearingAid.bands().size()
+    );
+}
+
+TEST_F(AfcHearingAidTests, compressesOutOfTheAnalysisBuffer) {
+    setChunkSize(3);
+    setChannels(5);
+    AfcHearingAid hearingAid{superSignalProcessor, superSignalProcessor};
+    buffer_type x(3);
+    hearingAid.process(x);
+    assertEqual(
+        hearingAid.bands().data(),
+        superSignalProcessor->compressChannelInput().data()
+    );
+    assertEqual(
+        hearingAid.bands().size(),
+        superSignalProcessor->compressChannelOutput().size()
+    );
+    assertTrue(
+        superSignalProcessor->compressChannelOutput().data() !=
+            hearingAid.bands().data()
+    );
+}
+
+TEST_F(AfcHearingAidTests, measuresBandLevelsOfAnalysisOutput) {
+    setChunkSize(3);
+    setChannels(2);
+    superSignalProcessor->setAnalysisValue(0.1F);
+    AfcHearingAid hearingAid{superSignalProcessor, superSignalProcessor};
+    hearingAid.measureBandLevels(100);
+    const auto levels = hearingAid.bandLevels();
+    buffer_type x(3);
+    hearingAid.process(x);
+    assertEqual(real_signal_type::index_type{2}, levels.size());
+    EXPECT_NEAR(100 + 10 * std::log10(2 * 0.01), levels[1], 1e-4);
+}
+
+TEST_F(AfcHearingAidTests, bandLevelsStayZeroUntilEnabled) {
+    setChunkSize(3);
+    setChannels(2);
+    superSignalProcessor->setAnalysisValue(0.1F);
+    AfcHearingAid hearingAid{superSignalProcessor, superSignalProcessor};
+    buffer_type x(3);
+    hearingAid.process(x);
+    assertEqual(real_type{0}, hearingAid.bandLevels()[0]);
+}
 }}
@@ -0,0 +1,151 @@
+#include "assert-utility.h"
+#include <hearing-aid/ActivityGate.h>
+#include <hearing-aid/BandParallelCompressor.h>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <set>
+
+namespace hearing_aid::tests { namespace {
+class SuperSignalProcessorStub : public SuperSignalProcessor {
+    std::mutex mutex;
+    std::multiset<int> compressedChannels_;
+    int chunkSize_{};
+    int channels_{};
+    bool compressChannelCalled_{};
+public:
+    void setChunkSize(int c) {
+        chunkSize_ = c;
+    }
+
+    void setChannels(int c) {
+        channels_ = c;
+    }
+
+    auto compressChannelCalled() const {
+        return compressChannelCalled_;
+    }
+
+    auto compressedChannels() {
+        std::lock_guard<std::mutex> lock{mutex};
+        return compressedChannels_;
+    }
+
+    void insertChannels(int first, int count) {
+        std::lock_guard<std::mutex> lock{mutex};
+        for (int c = first; c < first + count; ++c)
+            compressedChannels_.insert(c);
+    }
+
+    void feedbackCancelInput(real_signal_type, real_signal_type, int) override {}
+    void compressInput(real_signal_type, real_signal_type, int) override {}
+
+    void compressChannel(complex_signal_type, complex_signal_type, int) override {
+        compressChannelCalled_ = true;
+    }
+
+    void compressOutput(real_signal_type, real_signal_type, int) override {}
+    void feedbackCancelOutput(real_signal_type, int) override {}
+
+    int chunkSize() override {
+        return chunkSize_;
+    }
+
+    int channels() override {
+        return channels_;
+    }
+};
+
+class BandCompressorStub :
+    public SuperSignalProcessorStub,
+    public BandCompressor
+{
+public:
+    void compressChannels(
+        complex_signal_type,
+        complex_signal_type,
+        int,
+        int first,
+        int count
+    ) override {
+        insertChannels(first, count);
+    }
+};
+
+class BandParallelCompressorTests : public ::testing::Test {
+protected:
+    using buffer_type = std::vector<complex_type>;
+    std::shared_ptr<BandCompressorStub> processor =
+        std::make_shared<BandCompressorStub>();
+    BandParallelCompressor::Parameters p{};
+    buffer_type bands;
+
+    BandParallelCompressorTests() {
+        processor->setChunkSize(4);
+        processor->setChannels(8);
+        bands.resize(2 * 4 * 8);
+        p.threads = 3;
+        p.threshold = 32;
+    }
+
+    void compressChannel(std::shared_ptr<SuperSignalProcessor> s) {
+        BandParallelCompressor compressor{std::move(s), p};
+        compressor.compressChannel(bands, bands, 4);
+    }
+};
+
+TEST_F(BandParallelCompressorTests, compressesEachChannelOnceAtThreshold) {
+    compressChannel(processor);
+    auto channels = processor->compressedChannels();
+    assertEqual(std::multiset<int>::size_type{8}, channels.size());
+    for (int c = 0; c < 8; ++c)
+        assertEqual(std::multiset<int>::size_type{1}, channels.count(c));
+    assertFalse(processor->compressChannelCalled());
+}
+
+TEST_F(BandParallelCompressorTests, compressesInParallelThroughActivityGate) {
+    ActivityGate::Parameters gate{};
+    gate.silenceLevel = 40;
+    gate.fullScaleLevel = 100;
+    gate.holdFragments = 1;
+    gate.updateInterval = 1;
+    compressChannel(ActivityGate::make(processor, gate));
+    assertEqual(
+        std::multiset<int>::size_type{8},
+        processor->compressedChannels().size()
+    );
+    assertFalse(processor->compressChannelCalled());
+}
+
+TEST_F(BandParallelCompressorTests, fallsBackBelowThreshold) {
+    p.threshold = 33;
+    compressChannel(processor);
+    assertTrue(processor->compressChannelCalled());
+    assertTrue(processor->compressedChannels().empty());
+}
+
+TEST_F(BandParallelCompressorTests, fallsBackWithSingleThread) {
+    p.threads = 1;
+    compressChannel(processor);
+    assertTrue(processor->compressChannelCalled());
+}
+
+TEST_F(BandParallelCompressorTests, fallsBackWithoutBandCompressor) {
+    auto plain = std::make_shared<SuperSignalProcessorStub>();
+    plain->setChunkSize(4);
+    plain->setChannels(8);
+    compressChannel(plain);
+    assertTrue(plain->compressChannelCalled());
+}
+
+TEST_F(BandParallelCompressorTests, parallelWhenAboveThreshold) {
+    BandParallelCompressor compressor{processor, p};
+    assertTrue(compressor.parallel(4));
+    assertFalse(compressor.parallel(3));
+}
+
+TEST_F(BandParallelCompressorTests, forwardsChunkSizeAndChannels) {
+    BandParallelCompressor compressor{processor, p};
+    assertEqual(4, compressor.chunkSize());
+    assertEqual(8, compressor.channels());
+}
+}}
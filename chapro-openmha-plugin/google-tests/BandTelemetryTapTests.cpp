@@ -0,0 +1,157 @@
+#include "assert-utility.h"
+#include <hearing-aid/BandTelemetryTap.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace hearing_aid::tests { namespace {
+// Scales band k by k + 1, or to a fixed amplitude when normalizing.
+class BandScaler : public SuperSignalProcessor {
+public:
+    real_type normalized{};
+    int compressed{};
+
+    void feedbackCancelInput(
+        real_signal_type,
+        real_signal_type,
+        int
+    ) override {}
+    void compressInput(real_signal_type, real_signal_type, int) override {}
+
+    void compressChannel(
+        complex_signal_type input,
+        complex_signal_type output,
+        int chunkSize
+    ) override {
+        scale(input, output, chunkSize, 0, channels());
+        ++compressed;
+    }
+
+    void compressOutput(real_signal_type, real_signal_type, int) override {}
+    void feedbackCancelOutput(real_signal_type, int) override {}
+    int chunkSize() override { return 4; }
+    int channels() override { return 3; }
+protected:
+    void scale(
+        complex_signal_type input,
+        complex_signal_type output,
+        int chunkSize,
+        int first,
+        int n
+    ) {
+        for (int k = first; k < first + n; ++k)
+            for (int i = 2 * chunkSize * k; i < 2 * chunkSize * (k + 1); ++i)
+                output[i] = normalized > 0
+                    ? std::copysign(normalized, input[i])
+                    : input[i] * (k + 1);
+    }
+};
+
+class BandScalingCompressor : public BandScaler, public BandCompressor {
+public:
+    void compressChannels(
+        complex_signal_type input,
+        complex_signal_type output,
+        int chunkSize,
+        int first,
+        int n
+    ) override {
+        scale(input, output, chunkSize, first, n);
+    }
+};
+
+class BandTelemetryTapTests : public ::testing::Test {
+protected:
+    std::shared_ptr<BandScaler> scaler =
+        std::make_shared<BandScalingCompressor>();
+    BandTelemetryTap::Parameters parameters{100, 2};
+    std::vector<complex_type> bands = std::vector<complex_type>(2 * 4 * 3);
+
+    std::shared_ptr<BandTelemetryTap> make() {
+        return BandTelemetryTap::make(scaler, parameters);
+    }
+
+    void fill(real_type amplitude) {
+        std::fill(bands.begin(), bands.end(), amplitude);
+    }
+};
+
+TEST_F(BandTelemetryTapTests, publishesNothingBeforeFirstInterval) {
+    auto tap = make();
+    fill(0.1F);
+    tap->compressChannel(bands, bands, 4);
+    const auto read = tap->read();
+    assertEqual(std::size_t{3}, read.size());
+    for (const auto &band : read)
+        assertEqual(std::uint32_t{0}, band.updates);
+}
+
+TEST_F(BandTelemetryTapTests, publishesLevelAndGainEveryInterval) {
+    auto tap = make();
+    for (int fragment = 0; fragment < 4; ++fragment) {
+        fill(0.1F);
+        tap->compressChannel(bands, bands, 4);
+    }
+    assertEqual(4, scaler->compressed);
+    const auto read = tap->read();
+    for (int k = 0; k < 3; ++k) {
+        assertEqual(std::uint32_t{2}, read[k].updates);
+        // Two components of amplitude 0.1 per sample.
+        EXPECT_NEAR(100 + 10 * std::log10(0.02), read[k].level, 1e-4);
+        EXPECT_NEAR(20 * std::log10(k + 1.), read[k].gain, 1e-4);
+    }
+}
+
+TEST_F(BandTelemetryTapTests, keepsGainDuringSilence) {
+    parameters.interval = 1;
+    auto tap = make();
+    fill(0.1F);
+    tap->compressChannel(bands, bands, 4);
+    fill(0);
+    tap->compressChannel(bands, bands, 4);
+    EXPECT_NEAR(20 * std::log10(3.), tap->read()[2].gain, 1e-4);
+    EXPECT_LT(tap->read()[2].level, -50);
+}
+
+TEST_F(BandTelemetryTapTests, measuresBandRangesOfBandCompressor) {
+    parameters.interval = 1;
+    auto tap = make();
+    auto bandCompressor = std::dynamic_pointer_cast<BandCompressor>(tap);
+    ASSERT_TRUE(bandCompressor != nullptr);
+    fill(0.1F);
+    bandCompressor->compressChannels(bands, bands, 4, 1, 1);
+    const auto read = tap->read();
+    assertEqual(std::uint32_t{0}, read[0].updates);
+    assertEqual(std::uint32_t{1}, read[1].updates);
+    assertEqual(std::uint32_t{0}, read[2].updates);
+    EXPECT_NEAR(20 * std::log10(2.), read[1].gain, 1e-4);
+}
+
+TEST_F(BandTelemetryTapTests, isBandCompressorOnlyWhenDecoratedOneIs) {
+    scaler = std::make_shared<BandScaler>();
+    assertTrue(std::dynamic_pointer_cast<BandCompressor>(make()) == nullptr);
+}
+
+TEST_F(BandTelemetryTapTests, readsAreConsistentWhileCompressing) {
+    parameters.interval = 1;
+    scaler->normalized = 0.5F;
+    auto tap = make();
+    std::atomic<bool> done{false};
+    std::thread compressing{[&] {
+        for (int fragment = 0; fragment < 20000; ++fragment) {
+            fill(0.001F * (1 + fragment % 100));
+            tap->compressChannel(bands, bands, 4);
+        }
+        done = true;
+    }};
+    // Level plus gain is the output level, the same every fragment.
+    const auto output = 100 + 10 * std::log10(2 * 0.25);
+    while (!done)
+        for (const auto &band : tap->read())
+            if (band.updates > 0) {
+                EXPECT_NEAR(output, band.level + band.gain, 1e-3);
+            }
+    compressing.join();
+}
+}}
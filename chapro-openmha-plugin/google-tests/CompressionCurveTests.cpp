@@ -0,0 +1,68 @@
+#include "assert-utility.h"
+#include <hearing-aid/CompressionCurve.h>
+#include <gtest/gtest.h>
+
+namespace hearing_aid::tests { namespace {
+class CompressionCurveTests : public ::testing::Test {
+protected:
+    CompressionCurve curve{};
+
+    void setKneepointGain(double x) {
+        curve.kneepointGain = x;
+    }
+
+    void setKneepoint(double x) {
+        curve.kneepoint = x;
+    }
+
+    void setCompressionRatio(double x) {
+        curve.compressionRatio = x;
+    }
+
+    void setBroadbandOutputLimitingThreshold(double x) {
+        curve.broadbandOutputLimitingThreshold = x;
+    }
+
+    double gain(double level) {
+        return gainDecibels(curve, level);
+    }
+
+    double output(double level) {
+        return level + gain(level);
+    }
+};
+
+TEST_F(CompressionCurveTests, belowKneepointAppliesKneepointGain) {
+    setKneepointGain(10);
+    setKneepoint(40);
+    setCompressionRatio(2);
+    setBroadbandOutputLimitingThreshold(100);
+    assertEqual(10., gain(20));
+    assertEqual(10., gain(39));
+}
+
+TEST_F(CompressionCurveTests, aboveKneepointCompressesByRatio) {
+    setKneepointGain(10);
+    setKneepoint(40);
+    setCompressionRatio(2);
+    setBroadbandOutputLimitingThreshold(100);
+    EXPECT_NEAR(10, output(60) - output(40), 1e-9);
+}
+
+TEST_F(CompressionCurveTests, isContinuousAtKneepoint) {
+    setKneepointGain(10);
+    setKneepoint(40);
+    setCompressionRatio(3);
+    setBroadbandOutputLimitingThreshold(100);
+    EXPECT_NEAR(10, gain(40), 1e-9);
+}
+
+TEST_F(CompressionCurveTests, limitsOutputAboveThreshold) {
+    setKneepointGain(0);
+    setKneepoint(40);
+    setCompressionRatio(2);
+    setBroadbandOutputLimitingThreshold(80);
+    EXPECT_NEAR(80, output(120), 1e-9);
+    EXPECT_NEAR(81, output(130), 1e-9);
+}
+}}
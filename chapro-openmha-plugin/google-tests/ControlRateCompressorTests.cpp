@@ -0,0 +1,184 @@
+#include "LogString.h"
+#include "assert-utility.h"
+#include <hearing-aid/ControlRateCompressor.h>
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace hearing_aid::tests { namespace {
+class SuperSignalProcessorStub : public SuperSignalProcessor {
+    LogString log_;
+    int chunkSize_{};
+    int channels_{};
+public:
+    auto &log() const {
+        return log_;
+    }
+
+    void setChunkSize(int c) {
+        chunkSize_ = c;
+    }
+
+    void setChannels(int c) {
+        channels_ = c;
+    }
+
+    void feedbackCancelInput(
+        real_signal_type,
+        real_signal_type,
+        int
+    ) override {
+        log_.insert("feedbackCancelInput");
+    }
+
+    void compressInput(real_signal_type, real_signal_type, int) override {
+        log_.insert("compressInput");
+    }
+
+    void compressChannel(
+        complex_signal_type,
+        complex_signal_type,
+        int
+    ) override {
+        log_.insert("compressChannel");
+    }
+
+    void compressOutput(real_signal_type, real_signal_type, int) override {
+        log_.insert("compressOutput");
+    }
+
+    void feedbackCancelOutput(real_signal_type, int) override {
+        log_.insert("feedbackCancelOutput");
+    }
+
+    int chunkSize() override {
+        return chunkSize_;
+    }
+
+    int channels() override {
+        return channels_;
+    }
+};
+
+class ControlRateCompressorTests : public ::testing::Test {
+protected:
+    using buffer_type = std::vector<real_type>;
+    std::shared_ptr<SuperSignalProcessorStub> processor =
+        std::make_shared<SuperSignalProcessorStub>();
+    ControlRateCompressor::Parameters p{};
+
+    ControlRateCompressorTests() {
+        p.sampleRate = 1000;
+        p.fullScaleLevel = 100;
+        p.broadband.kneepoint = 200;
+        p.broadband.compressionRatio = 1;
+        p.broadband.broadbandOutputLimitingThreshold = 300;
+        p.controlInterval = 1;
+    }
+
+    void setChannelCurve(double kneepointGain, double kneepoint, double ratio) {
+        p.kneepointGains.push_back(kneepointGain);
+        p.kneepoints.push_back(kneepoint);
+        p.compressionRatios.push_back(ratio);
+        p.broadbandOutputLimitingThresholds.push_back(300);
+    }
+
+    ControlRateCompressor make() {
+        return ControlRateCompressor{processor, p};
+    }
+
+    buffer_type compressChannelConstant(
+        ControlRateCompressor &compressor,
+        real_type x,
+        int chunkSize,
+        int fragments = 1
+    ) {
+        buffer_type buffer(2 * chunkSize * processor->channels());
+        for (int n = 0; n < fragments; ++n) {
+            std::fill(buffer.begin(), buffer.end(), x);
+            compressor.compressChannel(buffer, buffer, chunkSize);
+        }
+        return buffer;
+    }
+
+    real_type finalInputGain(int interval, int fragments) {
+        p.controlInterval = interval;
+        p.broadband.kneepoint = 40;
+        p.broadband.compressionRatio = 4;
+        p.broadbandAttack = 5;
+        p.broadbandRelease = 50;
+        auto compressor = make();
+        buffer_type x(16);
+        for (int n = 0; n < fragments; ++n) {
+            std::fill(x.begin(), x.end(), real_type{0.1});
+            compressor.compressInput(x, x, 16);
+        }
+        return x.back() / real_type{0.1};
+    }
+};
+
+TEST_F(ControlRateCompressorTests, forwardsFeedbackCancellation) {
+    auto compressor = make();
+    buffer_type x(1);
+    compressor.feedbackCancelInput(x, x, 1);
+    compressor.feedbackCancelOutput(x, 1);
+    assertEqual(
+        "feedbackCancelInput"
+        "feedbackCancelOutput",
+        processor->log()
+    );
+}
+
+TEST_F(ControlRateCompressorTests, doesNotForwardCompression) {
+    processor->setChannels(1);
+    setChannelCurve(0, 200, 1);
+    auto compressor = make();
+    buffer_type x(1);
+    buffer_type z(2);
+    compressor.compressInput(x, x, 1);
+    compressor.compressChannel(z, z, 1);
+    compressor.compressOutput(x, x, 1);
+    assertTrue(processor->log().isEmpty());
+}
+
+TEST_F(ControlRateCompressorTests, forwardsChunkSizeAndChannels) {
+    processor->setChunkSize(3);
+    processor->setChannels(5);
+    auto compressor = make();
+    assertEqual(3, compressor.chunkSize());
+    assertEqual(5, compressor.channels());
+}
+
+TEST_F(ControlRateCompressorTests, belowKneepointAppliesKneepointGainPerBand) {
+    processor->setChannels(2);
+    setChannelCurve(0, 200, 1);
+    setChannelCurve(20, 200, 1);
+    auto compressor = make();
+    auto y = compressChannelConstant(compressor, 0.01F, 4);
+    EXPECT_NEAR(0.01, y.at(0), 1e-6);
+    EXPECT_NEAR(0.01, y.at(7), 1e-6);
+    EXPECT_NEAR(0.1, y.at(8), 1e-6);
+    EXPECT_NEAR(0.1, y.at(15), 1e-6);
+}
+
+TEST_F(ControlRateCompressorTests, gainIsLinearlyInterpolatedBetweenUpdates) {
+    processor->setChannels(1);
+    setChannelCurve(0, 20, 4);
+    p.attack = 1;
+    p.release = 1;
+    p.controlInterval = 4;
+    auto compressor = make();
+    compressChannelConstant(compressor, 0.5F, 4);
+    auto y = compressChannelConstant(compressor, 0.5F, 4);
+    const auto step = y.at(2) - y.at(0);
+    EXPECT_NEAR(step, y.at(4) - y.at(2), 1e-6);
+    EXPECT_NEAR(step, y.at(6) - y.at(4), 1e-6);
+    assertTrue(step < 0);
+}
+
+TEST_F(ControlRateCompressorTests, controlIntervalConvergesToSameGain) {
+    const auto perSample = finalInputGain(1, 200);
+    const auto decimated = finalInputGain(8, 200);
+    EXPECT_NEAR(perSample, decimated, 1e-3);
+    assertTrue(perSample < 1);
+}
+}}
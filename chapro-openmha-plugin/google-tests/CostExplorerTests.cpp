@@ -0,0 +1,131 @@
+#include "assert-utility.h"
+#include <hearing-aid/CostExplorer.h>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+namespace hearing_aid::tests { namespace {
+// Spins for the given time per fragment.
+class SpinningPipeline : public SweepPipeline {
+    std::chrono::microseconds cost;
+public:
+    explicit SpinningPipeline(std::chrono::microseconds cost) : cost{cost} {}
+
+    void process(real_signal_type) override {
+        const auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < cost)
+            ;
+    }
+
+    std::vector<real_type> qualityMetric() override {
+        return {};
+    }
+};
+
+// Costs 10 us per adaptive feedback filter tap per fragment; cannot
+// build the "bad" filter type.
+class SpinningBackend : public SweepBackend {
+public:
+    std::vector<HearingAidBuilder::Parameters> made;
+
+    std::unique_ptr<SweepPipeline> make(
+        const HearingAidBuilder::Parameters &p
+    ) override {
+        made.push_back(p);
+        if (p.filterType == "bad")
+            throw std::runtime_error{"bad filter type"};
+        return std::make_unique<SpinningPipeline>(
+            std::chrono::microseconds{10 * p.adaptiveFeedbackFilterLength}
+        );
+    }
+};
+
+class CostExplorerTests : public ::testing::Test {
+protected:
+    SpinningBackend backend;
+    CostExplorer::Parameters parameters{0.1, 65, 4};
+    HearingAidBuilder::Parameters fitting{};
+    CostExplorer::Space space{};
+
+    CostExplorerTests() {
+        fitting.sampleRate = 1000;
+        fitting.chunkSize = 4;
+        fitting.fullScaleLevel = 119;
+        fitting.filterType = "IIR";
+    }
+
+    std::vector<CostExplorer::Result> explore() {
+        CostExplorer explorer{&backend, parameters};
+        return explorer.explore(fitting, space);
+    }
+};
+
+TEST_F(CostExplorerTests, ranksHighestLoadFirst) {
+    // 500 fragments, so that the 99th percentile leaves out the few
+    // that were preempted.
+    parameters.seconds = 2;
+    space.adaptiveFeedbackFilterLengths = {0, 40, 10};
+    const auto results = explore();
+    assertEqual(std::size_t{3}, results.size());
+    assertEqual(40, results[0].fitting.adaptiveFeedbackFilterLength);
+    assertEqual(10, results[1].fitting.adaptiveFeedbackFilterLength);
+    assertEqual(0, results[2].fitting.adaptiveFeedbackFilterLength);
+    EXPECT_GT(results[0].load, results[1].load);
+    EXPECT_GT(results[1].load, results[2].load);
+}
+
+TEST_F(CostExplorerTests, loadIsTailCostOverFragmentDuration) {
+    fitting.adaptiveFeedbackFilterLength = 100;
+    CostExplorer explorer{&backend, parameters};
+    const auto result = explorer.evaluate(fitting);
+    // 25 fragments less the first tenth.
+    assertEqual(std::uint64_t{23}, result.cost.count());
+    EXPECT_NEAR(result.cost.percentile(0.99) / 4e6, result.load, 1e-12);
+    EXPECT_GT(result.load, 0.25);
+}
+
+TEST_F(CostExplorerTests, keepsCostliestCandidateWhileSearchingOthers) {
+    space.adaptiveFeedbackFilterLengths = {0, 100};
+    space.windowSizes = {64, 128};
+    explore();
+    assertEqual(100, backend.made.back().adaptiveFeedbackFilterLength);
+}
+
+TEST_F(CostExplorerTests, evaluatesEachFittingOnce) {
+    space.adaptiveFeedbackFilterLengths = {0, 100};
+    space.windowSizes = {64, 128};
+    const auto results = explore();
+    assertEqual(results.size(), backend.made.size());
+}
+
+TEST_F(CostExplorerTests, holdsEmptyDimensions) {
+    fitting.windowSize = 256;
+    space.adaptiveFeedbackFilterLengths = {0, 100};
+    explore();
+    for (const auto &made : backend.made)
+        assertEqual(256, made.windowSize);
+}
+
+TEST_F(CostExplorerTests, skipsFittingsBackendCannotBuild) {
+    space.filterTypes = {"bad", "FIR"};
+    const auto results = explore();
+    assertEqual(std::size_t{2}, results.size());
+    for (const auto &result : results)
+        assertTrue(result.fitting.filterType != "bad");
+}
+
+TEST_F(CostExplorerTests, spacesCrossFrequenciesLogarithmically) {
+    fitting.sampleRate = 16000;
+    fitting.compressionRatios = {2, 3};
+    fitting.kneepoints = {45};
+    const auto banded = CostExplorer::withBands(fitting, 4);
+    assertEqual(std::size_t{3}, banded.crossFrequencies.size());
+    EXPECT_NEAR(250, banded.crossFrequencies[0], 1e-9);
+    EXPECT_NEAR(1000, banded.crossFrequencies[1], 1e-9);
+    EXPECT_NEAR(4000, banded.crossFrequencies[2], 1e-9);
+    assertEqual(std::vector<double>{2, 2, 2, 2}, banded.compressionRatios);
+    assertEqual(std::vector<double>{45, 45, 45, 45}, banded.kneepoints);
+    assertTrue(banded.kneepointGains.empty());
+}
+}}
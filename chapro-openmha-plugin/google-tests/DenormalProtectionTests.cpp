@@ -0,0 +1,98 @@
+#include "assert-utility.h"
+#include <hearing-aid/DenormalProtection.h>
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace hearing_aid::tests { namespace {
+// Multiplies two normal floats whose product is subnormal.
+real_type subnormalProduct() {
+    volatile real_type a = 1e-30F;
+    volatile real_type b = 1e-10F;
+    return a * b;
+}
+
+class SignalProcessorStub : public SignalProcessor {
+    std::vector<real_type> signal_;
+    real_type product_{};
+public:
+    auto signal() const {
+        return signal_;
+    }
+
+    auto product() const {
+        return product_;
+    }
+
+    void process(real_signal_type s) override {
+        signal_.assign(s.begin(), s.end());
+        product_ = subnormalProduct();
+    }
+};
+
+class DenormalProtectionTests : public ::testing::Test {
+protected:
+    using buffer_type = std::vector<real_type>;
+    SignalProcessorStub *processor{};
+
+    std::unique_ptr<SignalProcessor> stub() {
+        auto s = std::make_unique<SignalProcessorStub>();
+        processor = s.get();
+        return s;
+    }
+};
+
+TEST_F(DenormalProtectionTests, guardFlushesSubnormalsWhileAlive) {
+    if (!FlushDenormalsToZero::supported())
+        GTEST_SKIP() << "no hardware flush-to-zero";
+    FlushDenormalsToZero guard;
+    assertEqual(0.F, subnormalProduct());
+}
+
+TEST_F(DenormalProtectionTests, guardRestoresPreviousMode) {
+    {
+        FlushDenormalsToZero guard;
+    }
+    assertTrue(subnormalProduct() != 0);
+}
+
+TEST_F(DenormalProtectionTests, flushModeProcessesWithSubnormalsFlushed) {
+    if (!FlushDenormalsToZero::supported())
+        GTEST_SKIP() << "no hardware flush-to-zero";
+    DenormalProtectedHearingAid hearingAid{
+        stub(),
+        DenormalProtectedHearingAid::Mode::flush
+    };
+    buffer_type x(4);
+    hearingAid.process(x);
+    assertEqual(0.F, processor->product());
+    assertEqual(buffer_type(4), processor->signal());
+    assertTrue(subnormalProduct() != 0);
+}
+
+TEST_F(DenormalProtectionTests, ditherModeKeepsSilenceAboveSubnormalRange) {
+    DenormalProtectedHearingAid hearingAid{
+        stub(),
+        DenormalProtectedHearingAid::Mode::dither
+    };
+    buffer_type x(64);
+    hearingAid.process(x);
+    for (auto y : processor->signal()) {
+        assertTrue(std::abs(y) < 1e-14F);
+        assertTrue(y == 0 || std::isnormal(y));
+    }
+    auto nonzero = 0;
+    for (auto y : processor->signal())
+        if (y != 0)
+            ++nonzero;
+    assertTrue(nonzero > 60);
+}
+
+TEST_F(DenormalProtectionTests, defaultsToFlushWhereSupported) {
+    DenormalProtectedHearingAid hearingAid{stub()};
+    assertTrue(
+        hearingAid.mode() == (FlushDenormalsToZero::supported() ?
+            DenormalProtectedHearingAid::Mode::flush :
+            DenormalProtectedHearingAid::Mode::dither)
+    );
+}
+}}
@@ -0,0 +1,191 @@
+#include "assert-utility.h"
+#include <hearing-aid/FeedbackLoopHost.h>
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace hearing_aid::tests { namespace {
+// Passes its input through and, with feedback management on and from a
+// given fragment, subtracts the feedback of a known path as an ideal
+// canceller would (assuming no extra gain).
+class ModelPipeline : public SweepPipeline {
+    std::vector<real_type> played;
+    std::vector<real_type> path;
+    std::vector<real_type> changedPath;
+    int delay;
+    int cancelFrom;
+    int changeAt;
+    int fragment{};
+public:
+    ModelPipeline(
+        std::vector<real_type> path,
+        std::vector<real_type> changedPath,
+        int delay,
+        int cancelFrom,
+        int changeAt
+    ) :
+        path{std::move(path)},
+        changedPath{std::move(changedPath)},
+        delay{delay},
+        cancelFrom{cancelFrom},
+        changeAt{changeAt} {}
+
+    void process(real_signal_type x) override {
+        const auto &h = fragment < changeAt ? path : changedPath;
+        for (auto &sample : x) {
+            const auto i = static_cast<int>(played.size());
+            real_type feedback = 0;
+            for (int j = 0; j < static_cast<int>(h.size()); ++j)
+                if (i - delay - j >= 0)
+                    feedback += h[j] * played[i - delay - j];
+            if (fragment >= cancelFrom)
+                sample -= feedback;
+            played.push_back(sample);
+        }
+        ++fragment;
+    }
+
+    std::vector<real_type> qualityMetric() override {
+        return {};
+    }
+};
+
+class ModelBackend : public SweepBackend {
+public:
+    std::vector<real_type> path;
+    std::vector<real_type> changedPath;
+    int delay{};
+    int cancelFrom{1 << 30};
+    int changeAt{1 << 30};
+
+    std::unique_ptr<SweepPipeline> make(
+        const HearingAidBuilder::Parameters &p
+    ) override {
+        return std::make_unique<ModelPipeline>(
+            path,
+            changedPath,
+            delay,
+            p.feedback == name(Feedback::on) ? cancelFrom : 1 << 30,
+            changeAt
+        );
+    }
+};
+
+class FeedbackLoopHostTests : public ::testing::Test {
+protected:
+    ModelBackend backend;
+    FeedbackLoopHost::Parameters parameters{};
+    HearingAidBuilder::Parameters fitting{};
+    std::vector<real_type> input;
+
+    FeedbackLoopHostTests() {
+        fitting.chunkSize = 4;
+        fitting.feedback = name(Feedback::on);
+        parameters.path.impulseResponse = {0.5};
+        parameters.convergenceThreshold = -60;
+        parameters.convergenceWindow = 1;
+        parameters.howlMargin = 10;
+        parameters.minimumGain = -20;
+        parameters.maximumGain = 20;
+        parameters.gainResolution = 0.1;
+        for (int i = 0; i < 4000; ++i)
+            input.push_back(real_type(0.1 * std::sin(0.7 * i)));
+        modelPath();
+    }
+
+    void modelPath() {
+        backend.path = parameters.path.impulseResponse;
+        backend.changedPath = parameters.path.changedImpulseResponse;
+        backend.delay = fitting.chunkSize + parameters.path.hardwareDelay;
+    }
+
+    std::vector<real_type> run(double gain = 0) {
+        FeedbackLoopHost host{&backend, parameters};
+        return host.run(fitting, input, gain);
+    }
+
+    FeedbackLoopHost::Result evaluate() {
+        FeedbackLoopHost host{&backend, parameters};
+        return host.evaluate(fitting, input);
+    }
+};
+
+TEST_F(FeedbackLoopHostTests, feedbackArrivesAfterFragmentAndHardwareDelay) {
+    parameters.path.impulseResponse = {0.5, 0.25};
+    parameters.path.hardwareDelay = 3;
+    input.assign(16, 0);
+    input.front() = 1;
+    const auto output = run();
+    for (int i = 1; i < 7; ++i)
+        assertEqual(real_type{0}, output[i]);
+    assertEqual(real_type{0.5}, output[7]);
+    assertEqual(real_type{0.25}, output[8]);
+}
+
+TEST_F(FeedbackLoopHostTests, extraGainScalesPlayedSignal) {
+    input.assign(16, 0);
+    input.front() = 1;
+    EXPECT_NEAR(1, run(20 * std::log10(2.)).at(4), 1e-6);
+}
+
+TEST_F(FeedbackLoopHostTests, pathCrossfadesToChangedPath) {
+    parameters.path.changedImpulseResponse = {0, 1};
+    parameters.path.changeFragment = 1;
+    parameters.path.changeFragments = 2;
+    input.assign(16, 0);
+    input.front() = 1;
+    const auto output = run();
+    assertEqual(real_type{0.25}, output[4]);
+    assertEqual(real_type{0.5}, output[5]);
+}
+
+TEST_F(FeedbackLoopHostTests, idealCancellerConvergesAtOnce) {
+    backend.cancelFrom = 0;
+    const auto result = evaluate();
+    assertEqual(0, result.convergence);
+    assertEqual(-1, result.reconvergence);
+    assertTrue(result.stable);
+}
+
+TEST_F(FeedbackLoopHostTests, convergenceIsStartOfFinalMatchingStretch) {
+    backend.cancelFrom = 10;
+    assertEqual(10, evaluate().convergence);
+}
+
+TEST_F(FeedbackLoopHostTests, uncancelledFeedbackDoesNotConverge) {
+    assertEqual(-1, evaluate().convergence);
+}
+
+TEST_F(FeedbackLoopHostTests, reconvergenceCountsFromPathChange) {
+    parameters.path.changedImpulseResponse = {-0.5};
+    parameters.path.changeFragment = 20;
+    modelPath();
+    backend.cancelFrom = 0;
+    backend.changeAt = 25;
+    const auto result = evaluate();
+    assertEqual(0, result.convergence);
+    assertEqual(5, result.reconvergence);
+}
+
+TEST_F(FeedbackLoopHostTests, maximumStableGainInvertsUncancelledPath) {
+    const auto result = evaluate();
+    EXPECT_NEAR(20 * std::log10(2.), result.maximumStableGain, 0.6);
+    assertTrue(result.stable);
+}
+
+TEST_F(FeedbackLoopHostTests, maximumStableGainIsNanWhenUnstableAtMinimum) {
+    parameters.path.impulseResponse = {2};
+    parameters.minimumGain = -3;
+    const auto result = evaluate();
+    assertTrue(std::isnan(result.maximumStableGain));
+    assertFalse(result.stable);
+}
+
+TEST_F(FeedbackLoopHostTests, maximumStableGainIsMaximumWhenNeverUnstable) {
+    parameters.path.impulseResponse = {0};
+    assertEqual(20., evaluate().maximumStableGain);
+}
+
+TEST_F(FeedbackLoopHostTests, costIsRecordedForEveryFragment) {
+    assertEqual(std::uint64_t{1000}, evaluate().cost.count());
+}
+}}
@@ -0,0 +1,127 @@
+#include "LogString.h"
+#include "assert-utility.h"
+#include <hearing-aid/FeedbackQualityTap.h>
+#include <gtest/gtest.h>
+
+namespace hearing_aid::tests { namespace {
+class SuperSignalProcessorStub : public SuperSignalProcessor {
+    LogString log_;
+public:
+    auto &log() const {
+        return log_;
+    }
+
+    void feedbackCancelInput(
+        real_signal_type,
+        real_signal_type,
+        int
+    ) override {
+        log_.insert("feedbackCancelInput");
+    }
+
+    void compressInput(real_signal_type, real_signal_type, int) override {
+        log_.insert("compressInput");
+    }
+
+    void compressChannel(
+        complex_signal_type,
+        complex_signal_type,
+        int
+    ) override {
+        log_.insert("compressChannel");
+    }
+
+    void compressOutput(real_signal_type, real_signal_type, int) override {
+        log_.insert("compressOutput");
+    }
+
+    void feedbackCancelOutput(real_signal_type, int) override {
+        log_.insert("feedbackCancelOutput");
+    }
+
+    int chunkSize() override {
+        return 0;
+    }
+
+    int channels() override {
+        return 0;
+    }
+};
+
+class FeedbackMonitorStub : public FeedbackMonitor {
+    real_type qualityMetric{};
+public:
+    void setQualityMetric(real_type x) {
+        qualityMetric = x;
+    }
+
+    FeedbackQuality feedbackQuality() override {
+        return {qualityMetric, -qualityMetric, 0};
+    }
+};
+
+class FeedbackQualityTapTests : public ::testing::Test {
+protected:
+    std::shared_ptr<SuperSignalProcessorStub> processor =
+        std::make_shared<SuperSignalProcessorStub>();
+    std::shared_ptr<FeedbackMonitorStub> monitor =
+        std::make_shared<FeedbackMonitorStub>();
+    FeedbackQualityTap tap{processor, monitor, 2};
+
+    void endFragment(real_type qualityMetric) {
+        monitor->setQualityMetric(qualityMetric);
+        tap.feedbackCancelOutput({}, 0);
+    }
+
+    std::vector<FeedbackQuality> drained() {
+        std::vector<FeedbackQuality> entries;
+        tap.drain([&](const FeedbackQuality &q) { entries.push_back(q); });
+        return entries;
+    }
+};
+
+TEST_F(FeedbackQualityTapTests, forwardsProcessing) {
+    std::vector<real_type> x(1);
+    tap.feedbackCancelInput(x, x, 0);
+    tap.compressInput(x, x, 0);
+    tap.compressChannel(x, x, 0);
+    tap.compressOutput(x, x, 0);
+    tap.feedbackCancelOutput(x, 0);
+    assertEqual(
+        "feedbackCancelInput"
+        "compressInput"
+        "compressChannel"
+        "compressOutput"
+        "feedbackCancelOutput",
+        processor->log()
+    );
+}
+
+TEST_F(FeedbackQualityTapTests, publishesQualityAfterEachFragment) {
+    endFragment(1);
+    endFragment(2);
+    const auto entries = drained();
+    assertEqual(std::size_t{2}, entries.size());
+    assertEqual(real_type{1}, entries[0].qualityMetric);
+    assertEqual(real_type{-2}, entries[1].misalignment);
+    assertEqual(0, entries[0].fragment);
+    assertEqual(1, entries[1].fragment);
+}
+
+TEST_F(FeedbackQualityTapTests, drainEmptiesRing) {
+    endFragment(1);
+    drained();
+    assertTrue(drained().empty());
+}
+
+TEST_F(FeedbackQualityTapTests, countsEntriesDroppedWhenFull) {
+    endFragment(1);
+    endFragment(2);
+    endFragment(3);
+    assertEqual(1, tap.dropped());
+    const auto entries = drained();
+    assertEqual(std::size_t{2}, entries.size());
+    endFragment(4);
+    assertEqual(3, drained().front().fragment);
+}
+}}
@@ -0,0 +1,61 @@
+#include "assert-utility.h"
+#include <hearing-aid/Fft.h>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+
+namespace hearing_aid::tests { namespace {
+class FftTests : public ::testing::Test {
+protected:
+    std::vector<real_type> ramp(int n) {
+        std::vector<real_type> x(n);
+        for (int i = 0; i < n; ++i)
+            x.at(i) = std::sin(0.3F * i) + 0.1F * i;
+        return x;
+    }
+
+    spectrum_type dft(const std::vector<real_type> &x, int k) {
+        const auto n = static_cast<int>(x.size());
+        const auto pi = std::acos(-1.);
+        std::complex<double> sum{};
+        for (int i = 0; i < n; ++i)
+            sum += static_cast<double>(x.at(i)) *
+                std::polar(1., -2 * pi * k * i / n);
+        return {static_cast<real_type>(sum.real()),
+            static_cast<real_type>(sum.imag())};
+    }
+};
+
+TEST_F(FftTests, forwardMatchesDiscreteFourierTransform) {
+    for (auto n : {2, 4, 16, 64}) {
+        Fft fft{n};
+        auto x = ramp(n);
+        std::vector<spectrum_type> spectrum(fft.bins());
+        fft.forward(x, spectrum);
+        for (int k = 0; k < fft.bins(); ++k) {
+            EXPECT_NEAR(dft(x, k).real(), spectrum.at(k).real(), 1e-3);
+            EXPECT_NEAR(dft(x, k).imag(), spectrum.at(k).imag(), 1e-3);
+        }
+    }
+}
+
+TEST_F(FftTests, inverseRestoresSignal) {
+    Fft fft{32};
+    auto x = ramp(32);
+    std::vector<spectrum_type> spectrum(fft.bins());
+    std::vector<real_type> y(32);
+    fft.forward(x, spectrum);
+    fft.inverse(spectrum, y);
+    for (int i = 0; i < 32; ++i)
+        EXPECT_NEAR(x.at(i), y.at(i), 1e-5);
+}
+
+TEST_F(FftTests, binsIsHalfSizePlusOne) {
+    Fft fft{8};
+    assertEqual(5, fft.bins());
+}
+
+TEST_F(FftTests, rejectsSizeThatIsNotPowerOfTwo) {
+    EXPECT_THROW(Fft{12}, std::invalid_argument);
+}
+}}
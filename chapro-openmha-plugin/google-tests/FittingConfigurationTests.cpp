@@ -0,0 +1,45 @@
+#include "assert-utility.h"
+#include <hearing-aid/FittingConfiguration.h>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+
+namespace hearing_aid::tests { namespace {
+HearingAidBuilder::Parameters read(const std::string &configuration) {
+    std::istringstream stream{configuration};
+    return readFitting(stream);
+}
+
+TEST(FittingConfigurationTests, readsPluginVariablesByLastComponent) {
+    const auto p = read(
+        "# chapro\n"
+        "fragsize = 32\n"
+        "srate = 22050\n"
+        "mha.chapro.cr = [1.1 1.2, 2]\n"
+        "mha.chapro.filter_type = FIR-MP\n"
+        "mha.chapro.afl = 100\n"
+    );
+    assertEqual(32, p.chunkSize);
+    assertEqual(22050., p.sampleRate);
+    assertEqual(std::vector<double>{1.1, 1.2, 2}, p.compressionRatios);
+    assertEqual(std::string{"FIR-MP"}, p.filterType);
+    assertEqual(100, p.adaptiveFeedbackFilterLength);
+}
+
+TEST(FittingConfigurationTests, missingVariablesTakePluginDefaults) {
+    const auto p = read("mha.chapro.nw = 256\n");
+    assertEqual(64, p.chunkSize);
+    assertEqual(44100., p.sampleRate);
+    assertEqual(std::string{"IIR"}, p.filterType);
+    assertEqual(std::string{"yes"}, p.feedback);
+    assertEqual(256, p.windowSize);
+    assertTrue(p.crossFrequencies.empty());
+}
+
+TEST(FittingConfigurationTests, missingFileThrows) {
+    EXPECT_THROW(
+        readFitting(std::string{"no/such/chapro.cfg"}),
+        std::runtime_error
+    );
+}
+}}
@@ -0,0 +1,246 @@
+#include "assert-utility.h"
+#include <hearing-aid/FlightRecorder.h>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <thread>
+
+namespace hearing_aid::tests { namespace {
+// Multiplies by a gain, then sleeps, so tests can cause each event.
+class ScalingProcessor : public SignalProcessor {
+    real_type gain;
+    std::chrono::milliseconds sleep;
+public:
+    ScalingProcessor(real_type gain, std::chrono::milliseconds sleep) :
+        gain{gain},
+        sleep{sleep} {}
+
+    void process(real_signal_type signal) override {
+        for (auto &x : signal)
+            x *= gain;
+        if (sleep.count() > 0)
+            std::this_thread::sleep_for(sleep);
+    }
+};
+
+class SleepingStages : public SuperSignalProcessor, public Filter {
+public:
+    void feedbackCancelInput(
+        real_signal_type,
+        real_signal_type,
+        int
+    ) override {}
+    void compressInput(real_signal_type, real_signal_type, int) override {}
+    void filterbankAnalyze(
+        real_signal_type,
+        complex_signal_type,
+        int
+    ) override {}
+
+    void compressChannel(
+        complex_signal_type,
+        complex_signal_type,
+        int
+    ) override {
+        std::this_thread::sleep_for(std::chrono::milliseconds{2});
+    }
+
+    void filterbankSynthesize(
+        complex_signal_type,
+        real_signal_type,
+        int
+    ) override {}
+    void compressOutput(real_signal_type, real_signal_type, int) override {}
+    void feedbackCancelOutput(real_signal_type, int) override {}
+    int chunkSize() override { return 4; }
+    int channels() override { return 2; }
+};
+
+std::vector<std::string> lines(const std::string &path) {
+    std::ifstream file{path};
+    std::vector<std::string> v;
+    std::string line;
+    while (std::getline(file, line))
+        v.push_back(line);
+    return v;
+}
+
+std::streamoff fileSize(const std::string &path) {
+    std::ifstream file{path, std::ios::binary | std::ios::ate};
+    return file.tellg();
+}
+
+class FlightRecorderTests : public ::testing::Test {
+protected:
+    FlightRecorder::Parameters parameters{};
+    std::vector<real_type> fragment;
+    std::unique_ptr<FlightRecorder> recorder;
+    std::chrono::milliseconds sleep{};
+    real_type gain{1};
+
+    FlightRecorderTests() {
+        parameters.path = ::testing::TempDir() + "flight-recorder-test-";
+        parameters.seconds = 0.001;
+        parameters.sampleRate = 16000;
+        parameters.deadline = 1000;
+        parameters.clippingLevel = 1;
+        parameters.chunkSize = 4;
+        parameters.maxDumps = 10;
+        fragment.resize(4);
+    }
+
+    ~FlightRecorderTests() override {
+        recorder.reset();
+        for (auto n : {"1", "2"}) {
+            std::remove((parameters.path + n + ".wav").c_str());
+            std::remove((parameters.path + n + ".csv").c_str());
+        }
+    }
+
+    void make() {
+        recorder = std::make_unique<FlightRecorder>(
+            std::make_unique<ScalingProcessor>(gain, sleep),
+            nullptr,
+            parameters
+        );
+    }
+
+    void process(int fragments, real_type value = real_type{0.5}) {
+        for (int i = 0; i < fragments; ++i) {
+            std::fill(fragment.begin(), fragment.end(), value);
+            recorder->process(fragment);
+        }
+    }
+
+    void waitForDump(int n = 1) {
+        for (int i = 0; i < 500 && recorder->dumps() < n; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds{2});
+        assertEqual(n, recorder->dumps());
+    }
+
+    std::vector<std::string> csv() {
+        return lines(recorder->lastDump() + ".csv");
+    }
+};
+
+TEST_F(FlightRecorderTests, historyCoversSeconds) {
+    make();
+    assertEqual(4, recorder->historyFragments());
+}
+
+TEST_F(FlightRecorderTests, processesSignal) {
+    gain = 0.5;
+    make();
+    process(1);
+    for (auto x : fragment)
+        assertEqual(real_type{0.25}, x);
+}
+
+TEST_F(FlightRecorderTests, doesNotDumpWithoutEvents) {
+    make();
+    process(10);
+    std::this_thread::sleep_for(std::chrono::milliseconds{30});
+    assertEqual(0, recorder->dumps());
+    assertEqual(0, recorder->events());
+}
+
+TEST_F(FlightRecorderTests, clippingDumpsHistoryEndingAtEvent) {
+    make();
+    process(10);
+    process(1, real_type{1.5});
+    waitForDump();
+    assertEqual(parameters.path + "1", recorder->lastDump());
+    const auto rows = csv();
+    assertEqual(std::size_t{5}, rows.size());
+    assertEqual(
+        std::string::size_type{0},
+        rows.front().find("fragment,start_ns,elapsed_ns,")
+    );
+    assertEqual(std::string::size_type{0}, rows[1].find("7,"));
+    assertEqual(std::string::size_type{0}, rows.back().find("10,"));
+    assertEqual(
+        std::string{",clipping"},
+        rows.back().substr(rows.back().rfind(','))
+    );
+    // Four fragments of four two-channel float samples.
+    assertEqual(
+        std::streamoff{44 + 4 * 4 * 2 * 4},
+        fileSize(recorder->lastDump() + ".wav")
+    );
+}
+
+TEST_F(FlightRecorderTests, notFiniteInputTriggersDump) {
+    make();
+    process(1, std::numeric_limits<real_type>::quiet_NaN());
+    waitForDump();
+    assertEqual(std::size_t{2}, csv().size());
+    assertTrue(csv().back().find("notFinite") != std::string::npos);
+}
+
+TEST_F(FlightRecorderTests, overrunTriggersDump) {
+    parameters.deadline = 1;
+    sleep = std::chrono::milliseconds{2};
+    make();
+    process(1);
+    waitForDump();
+    assertTrue(csv().back().find("overrun") != std::string::npos);
+}
+
+TEST_F(FlightRecorderTests, eventsWhileDumpIsPendingAreCountedOnly) {
+    make();
+    process(3, real_type{2});
+    waitForDump();
+    assertEqual(3, recorder->events());
+    assertEqual(2, recorder->suppressed());
+    std::this_thread::sleep_for(std::chrono::milliseconds{30});
+    assertEqual(1, recorder->dumps());
+}
+
+TEST_F(FlightRecorderTests, sustainedEventsTriggerOncePerHistory) {
+    make();
+    process(1, real_type{2});
+    waitForDump();
+    process(3, real_type{2});
+    std::this_thread::sleep_for(std::chrono::milliseconds{30});
+    assertEqual(1, recorder->dumps());
+    assertEqual(3, recorder->suppressed());
+    process(1, real_type{2});
+    waitForDump(2);
+    assertEqual(3, recorder->suppressed());
+}
+
+TEST_F(FlightRecorderTests, stopsDumpingAtMaximum) {
+    parameters.maxDumps = 1;
+    make();
+    process(1, real_type{2});
+    waitForDump();
+    process(8, real_type{2});
+    std::this_thread::sleep_for(std::chrono::milliseconds{30});
+    assertEqual(1, recorder->dumps());
+    assertEqual(8, recorder->suppressed());
+}
+
+TEST(StageTimerTests, timesEachStage) {
+    auto stages = std::make_shared<SleepingStages>();
+    auto timer = std::make_shared<StageTimer>(stages, stages);
+    AfcHearingAid hearingAid{timer, timer};
+    std::vector<real_type> x(4);
+    hearingAid.process(x);
+    const auto first = timer->take();
+    EXPECT_GE(first[static_cast<int>(Stage::compressChannel)], 2000000);
+    EXPECT_LT(first[static_cast<int>(Stage::compressInput)], 2000000);
+    const auto cleared = timer->take();
+    for (auto d : cleared)
+        assertEqual(std::int64_t{0}, d);
+}
+
+TEST(StageTimerTests, namesStages) {
+    assertEqual(
+        std::string{"filterbankAnalyze"},
+        std::string{name(Stage::filterbankAnalyze)}
+    );
+}
+}}
@@ -18,6 +18,39 @@ class FilterStub : public Filter {
     ) override {}
 };
 
+class SuperSignalProcessorStub : public SuperSignalProcessor {
+    int chunkSize_{};
+public:
+    void setChunkSize(int c) {
+        chunkSize_ = c;
+    }
+
+    void feedbackCancelInput(
+        real_signal_type,
+        real_signal_type,
+        int
+    ) override {}
+
+    void compressInput(real_signal_type, real_signal_type, int) override {}
+
+    void compressChannel(
+        complex_signal_type,
+        complex_signal_type,
+        int
+    ) override {}
+
+    void compressOutput(real_signal_type, real_signal_type, int) override {}
+    void feedbackCancelOutput(real_signal_type, int) override {}
+
+    int chunkSize() override {
+        return chunkSize_;
+    }
+
+    int channels() override {
+        return 0;
+    }
+};
+
 class FilterFactoryStub : public FilterFactory {
     std::shared_ptr<Filter> iirFilter_;
     std::shared_ptr<Filter> firFilter_;
@@ -68,13 +101,72 @@ class HearingAidInitializerStub : public HearingAidInitializer {
     int persistentFeedbackFilterLength_{};
     int hardwareLatency_{};
     int saveQualityMetric_{};
+    int qualityMetricLength_{};
+    int filterInitializations_{};
+    int feedbackInitializations_{};
+    int agcInitializations_{};
+    int filterReleases_{};
+    int feedbackReleases_{};
+    int agcReleases_{};
+    // Like CHAPRO, each initialization allocates state that only its
+    // component's release frees.
+    int filterAllocations_{};
+    int feedbackAllocations_{};
+    int agcAllocations_{};
     bool firInitialized_{};
     bool iirInitialized_{};
 public:
+    auto filterInitializations() const {
+        return filterInitializations_;
+    }
+
+    auto feedbackInitializations() const {
+        return feedbackInitializations_;
+    }
+
+    auto agcInitializations() const {
+        return agcInitializations_;
+    }
+
+    auto filterReleases() const {
+        return filterReleases_;
+    }
+
+    auto feedbackReleases() const {
+        return feedbackReleases_;
+    }
+
+    auto agcReleases() const {
+        return agcReleases_;
+    }
+
+    auto allocations() const {
+        return filterAllocations_ + feedbackAllocations_ + agcAllocations_;
+    }
+
+    void releaseFilter() override {
+        filterAllocations_ = 0;
+        ++filterReleases_;
+    }
+
+    void releaseFeedbackManagement() override {
+        feedbackAllocations_ = 0;
+        ++feedbackReleases_;
+    }
+
+    void releaseAutomaticGainControl() override {
+        agcAllocations_ = 0;
+        ++agcReleases_;
+    }
+
     auto saveQualityMetric() const {
         return saveQualityMetric_;
     }
 
+    auto qualityMetricLength() const {
+        return qualityMetricLength_;
+    }
+
     auto hardwareLatency() const {
         return hardwareLatency_;
     }
@@ -198,6 +290,8 @@ public:
         firWindowSize_ = p.windowSize;
         firChunkSize_ = p.chunkSize;
         firInitialized_ = true;
+        ++filterInitializations_;
+        ++filterAllocations_;
     }
 
     void initializeIirFilter(const IirParameters &p) override {
@@ -206,6 +300,8 @@ public:
         iirSampleRate_ = p.sampleRate;
         iirChunkSize_ = p.chunkSize;
         iirInitialized_ = true;
+        ++filterInitializations_;
+        ++filterAllocations_;
     }
 
     void initializeFeedbackManagement(const FeedbackManagement &p) override {
@@ -218,6 +314,9 @@ public:
         persistentFeedbackFilterLength_ = p.persistentFeedbackFilterLength;
         hardwareLatency_ = p.hardwareLatency;
         saveQualityMetric_ = p.saveQualityMetric;
+        qualityMetricLength_ = p.qualityMetricLength;
+        ++feedbackInitializations_;
+        ++feedbackAllocations_;
     }
 
     void initializeAutomaticGainControl(
@@ -234,6 +333,8 @@ public:
             p.broadbandOutputLimitingThresholds;
         agcSampleRate_ = p.sampleRate;
         agcFullScaleLevel_ = p.fullScaleLevel;
+        ++agcInitializations_;
+        ++agcAllocations_;
     }
 };
 
@@ -263,6 +364,26 @@ protected:
         builder.build(p);
     }
 
+    void invalidate() {
+        builder.invalidate();
+    }
+
+    void assertReleases(int filter, int feedback, int agc) {
+        assertEqual(filter, initializer_.filterReleases());
+        assertEqual(feedback, initializer_.feedbackReleases());
+        assertEqual(agc, initializer_.agcReleases());
+    }
+
+    void assertAllocations(int n) {
+        assertEqual(n, initializer_.allocations());
+    }
+
+    void assertInitializations(int filter, int feedback, int agc) {
+        assertEqual(filter, initializer_.filterInitializations());
+        assertEqual(feedback, initializer_.feedbackInitializations());
+        assertEqual(agc, initializer_.agcInitializations());
+    }
+
     bool firInitialized() {
         return initializer_.firInitialized();
     }
@@ -377,6 +498,14 @@ protected:
         assertEqual(f, builder.filter());
     }
 
+    void assertBuiltMinimumPhaseFilterbank() {
+        assertTrue(
+            std::dynamic_pointer_cast<MinimumPhaseFilterbank>(
+                builder.filter()
+            ) != nullptr
+        );
+    }
+
     void setSampleRate(double r) {
         p.sampleRate = r;
     }
@@ -413,6 +542,20 @@ protected:
         assertEqual(n, initializer_.iirChunkSize());
     }
 
+    void setControlInterval(int n) {
+        p.controlInterval = n;
+    }
+
+    void setSilenceLevel(double x) {
+        p.silenceLevel = x;
+    }
+
+    std::shared_ptr<SuperSignalProcessor> builtProcessor(
+        std::shared_ptr<SuperSignalProcessor> backend
+    ) {
+        return builder.processor(std::move(backend));
+    }
+
     void setFeedbackOff() {
         setFeedback(Feedback::off);
     }
@@ -425,6 +568,10 @@ protected:
         p.feedback = name(f);
     }
 
+    void setFeedbackEngine(FeedbackEngine e) {
+        p.feedbackEngine = name(e);
+    }
+
     void setFeedbackGain(double x) {
         p.feedbackGain = x;
     }
@@ -461,6 +608,10 @@ protected:
         p.saveQualityMetric = sqm;
     }
 
+    void setQualityMetricLength(int n) {
+        p.qualityMetricLength = n;
+    }
+
     void assertFilterEstimationForgettingFactor(double rho) {
         assertEqual(rho, initializer_.filterEstimationForgettingFactor());
     }
@@ -489,6 +640,10 @@ protected:
         assertEqual(sqm, initializer_.saveQualityMetric());
     }
 
+    void assertQualityMetricLength(int n) {
+        assertEqual(n, initializer_.qualityMetricLength());
+    }
+
     void assertFeedbackGain(double x) {
         assertEqual(x, initializer_.feedbackGain());
     }
@@ -570,6 +725,7 @@ TEST_F(
     setPersistentFeedbackFilterLength(7);
     setHardwareLatency(8);
     setSaveQualityMetric(9);
+    setQualityMetricLength(10);
     build();
     assertFeedbackGain(1);
     assertAdaptiveFeedbackFilterLength(2);
@@ -580,6 +736,7 @@ TEST_F(
     assertPersistentFeedbackFilterLength(7);
     assertHardwareLatency(8);
     assertSaveQualityMetric(9);
+    assertQualityMetricLength(10);
 }
 
 TEST_F(HearingAidBuilderTests, passesAgcParameters) {
@@ -620,4 +777,176 @@ TEST_F(HearingAidBuilderTests, firBuildReturnsFirFilter) {
     build();
     assertBuiltFilter(filter);
 }
+
+TEST_F(HearingAidBuilderTests, minimumPhaseFirReturnsMinimumPhaseFilterbank) {
+    setFilterType(FilterType::minimumPhaseFir);
+    setFirFilter(std::make_shared<FilterStub>());
+    setCrossFrequencies({ 1000 });
+    setSampleRate(16000);
+    setWindowSize(8);
+    setChunkSize(4);
+    build();
+    assertFirNotInitialized();
+    assertIirNotInitialized();
+    assertBuiltMinimumPhaseFilterbank();
+}
+
+TEST_F(HearingAidBuilderTests, zeroControlIntervalReturnsBackendProcessor) {
+    setControlInterval(0);
+    build();
+    auto backend = std::make_shared<SuperSignalProcessorStub>();
+    assertEqual(
+        std::shared_ptr<SuperSignalProcessor>{backend},
+        builtProcessor(backend)
+    );
+}
+
+TEST_F(HearingAidBuilderTests, controlIntervalReturnsControlRateCompressor) {
+    setControlInterval(8);
+    build();
+    auto processor =
+        builtProcessor(std::make_shared<SuperSignalProcessorStub>());
+    assertTrue(
+        std::dynamic_pointer_cast<ControlRateCompressor>(processor) != nullptr
+    );
+}
+
+TEST_F(
+    HearingAidBuilderTests,
+    frequencyDomainFeedbackDisablesInitializerAdaptiveFilter
+) {
+    setFeedbackOn();
+    setFeedbackEngine(FeedbackEngine::frequencyDomain);
+    setFeedbackGain(1);
+    setAdaptiveFeedbackFilterLength(2);
+    build();
+    assertFeedbackGain(0);
+    assertAdaptiveFeedbackFilterLength(0);
+}
+
+TEST_F(
+    HearingAidBuilderTests,
+    frequencyDomainFeedbackReturnsPartitionedBlockFeedbackCanceller
+) {
+    setFeedbackOn();
+    setFeedbackEngine(FeedbackEngine::frequencyDomain);
+    setAdaptiveFeedbackFilterLength(2);
+    setChunkSize(4);
+    build();
+    auto backend = std::make_shared<SuperSignalProcessorStub>();
+    backend->setChunkSize(4);
+    assertTrue(
+        std::dynamic_pointer_cast<PartitionedBlockFeedbackCanceller>(
+            builtProcessor(backend)
+        ) != nullptr
+    );
+}
+
+TEST_F(
+    HearingAidBuilderTests,
+    timeDomainFeedbackReturnsBackendProcessor
+) {
+    setFeedbackOn();
+    setFeedbackEngine(FeedbackEngine::timeDomain);
+    setAdaptiveFeedbackFilterLength(2);
+    build();
+    auto backend = std::make_shared<SuperSignalProcessorStub>();
+    assertEqual(
+        std::shared_ptr<SuperSignalProcessor>{backend},
+        builtProcessor(backend)
+    );
+}
+
+TEST_F(HearingAidBuilderTests, silenceLevelReturnsActivityGate) {
+    setSilenceLevel(30);
+    setChunkSize(4);
+    setSampleRate(1000);
+    build();
+    auto backend = std::make_shared<SuperSignalProcessorStub>();
+    backend->setChunkSize(4);
+    assertTrue(
+        std::dynamic_pointer_cast<ActivityGate>(builtProcessor(backend)) !=
+            nullptr
+    );
+}
+
+TEST_F(HearingAidBuilderTests, activityGateKeepsControlRateBandCompressor) {
+    setSilenceLevel(30);
+    setControlInterval(8);
+    setChunkSize(4);
+    setSampleRate(1000);
+    build();
+    auto backend = std::make_shared<SuperSignalProcessorStub>();
+    backend->setChunkSize(4);
+    const auto processor = builtProcessor(backend);
+    assertTrue(std::dynamic_pointer_cast<ActivityGate>(processor) != nullptr);
+    assertTrue(
+        std::dynamic_pointer_cast<BandCompressor>(processor) != nullptr
+    );
+}
+
+TEST_F(HearingAidBuilderTests, unchangedRebuildInitializesNothing) {
+    build();
+    build();
+    assertInitializations(1, 1, 1);
+    assertReleases(0, 0, 0);
+}
+
+TEST_F(HearingAidBuilderTests, changedDecoratorOnlyInitializesNothing) {
+    build();
+    setControlInterval(4);
+    build();
+    assertInitializations(1, 1, 1);
+    assertReleases(0, 0, 0);
+}
+
+TEST_F(HearingAidBuilderTests, changedAgcReinitializesOnlyAgc) {
+    build();
+    setKneepointGains({ 1, 2 });
+    build();
+    assertInitializations(1, 1, 2);
+    assertReleases(0, 0, 1);
+}
+
+TEST_F(HearingAidBuilderTests, changedFeedbackReinitializesOnlyFeedback) {
+    build();
+    setHardwareLatency(3);
+    build();
+    assertInitializations(1, 2, 1);
+    assertReleases(0, 1, 0);
+}
+
+TEST_F(HearingAidBuilderTests, changedFilterTypeReinitializesOnlyFilter) {
+    build();
+    setFilterType(FilterType::iir);
+    build();
+    assertInitializations(2, 1, 1);
+    assertReleases(1, 0, 0);
+}
+
+TEST_F(HearingAidBuilderTests, changedChunkSizeReinitializesAll) {
+    build();
+    setChunkSize(8);
+    build();
+    assertInitializations(2, 2, 2);
+    assertReleases(1, 1, 1);
+}
+
+TEST_F(HearingAidBuilderTests, repeatedChangedBuildsDoNotGrowAllocations) {
+    for (int i = 0; i < 10; ++i) {
+        setFilterType(i % 2 == 0 ? FilterType::fir : FilterType::iir);
+        setKneepointGains({ 1, double(i) });
+        build();
+        assertAllocations(3);
+    }
+    assertReleases(9, 0, 9);
+}
+
+TEST_F(HearingAidBuilderTests, invalidateReinitializesAllWithoutReleasing) {
+    build();
+    invalidate();
+    build();
+    assertInitializations(2, 2, 2);
+    assertReleases(0, 0, 0);
+}
 }}
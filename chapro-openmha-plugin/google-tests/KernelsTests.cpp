@@ -0,0 +1,187 @@
+#include "assert-utility.h"
+#include <hearing-aid/ControlRateCompressor.h>
+#include <hearing-aid/Kernels.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+namespace hearing_aid::tests { namespace {
+std::vector<real_type> samples(int n, int seed) {
+    std::vector<real_type> x(n);
+    for (int i = 0; i < n; ++i)
+        x[i] = static_cast<real_type>(std::sin(0.37 * i * seed + seed));
+    return x;
+}
+
+std::vector<spectrum_type> spectrum(int n, int seed) {
+    const auto re = samples(n, seed);
+    const auto im = samples(n, seed + 1);
+    std::vector<spectrum_type> x(n);
+    for (int k = 0; k < n; ++k)
+        x[k] = {re[k], im[k]};
+    return x;
+}
+
+void assertNear(
+    const std::vector<spectrum_type> &expected,
+    const std::vector<spectrum_type> &actual
+) {
+    assertEqual(expected.size(), actual.size());
+    for (std::size_t k = 0; k < expected.size(); ++k) {
+        EXPECT_NEAR(expected[k].real(), actual[k].real(), 1e-5);
+        EXPECT_NEAR(expected[k].imag(), actual[k].imag(), 1e-5);
+    }
+}
+
+// Odd so every level runs its remainder loop.
+constexpr auto bins = 67;
+
+class KernelsTests : public ::testing::TestWithParam<const Kernels *> {
+protected:
+    const Kernels &k{*GetParam()};
+};
+
+TEST_P(KernelsTests, multiplyAccumulateAddsProducts) {
+    const auto a = spectrum(bins, 1);
+    const auto b = spectrum(bins, 3);
+    auto sum = spectrum(bins, 5);
+    auto expected = sum;
+    for (int i = 0; i < bins; ++i)
+        expected[i] += a[i] * b[i];
+    k.multiplyAccumulate(a.data(), b.data(), sum.data(), bins);
+    assertNear(expected, sum);
+}
+
+TEST_P(KernelsTests, normalizedCorrelationDividesByPower) {
+    const auto x = spectrum(bins, 1);
+    const auto e = spectrum(bins, 3);
+    auto power = samples(bins, 5);
+    for (auto &p : power)
+        p = p * p;
+    std::vector<spectrum_type> g(bins);
+    std::vector<spectrum_type> expected(bins);
+    for (int i = 0; i < bins; ++i)
+        expected[i] = std::conj(x[i]) * e[i] / (power[i] + real_type{0.5});
+    k.normalizedCorrelation(
+        x.data(),
+        e.data(),
+        power.data(),
+        0.5,
+        g.data(),
+        bins
+    );
+    assertNear(expected, g);
+}
+
+TEST_P(KernelsTests, scaledAccumulateAddsScaledGradient) {
+    const auto g = spectrum(bins, 1);
+    auto w = spectrum(bins, 3);
+    auto expected = w;
+    for (int i = 0; i < bins; ++i)
+        expected[i] += real_type{0.25} * g[i];
+    k.scaledAccumulate(g.data(), 0.25, w.data(), bins);
+    assertNear(expected, w);
+}
+
+TEST_P(KernelsTests, rampBandScalesByInterpolatedGainAndReturnsPeak) {
+    auto band = samples(2 * bins, 1);
+    const auto in = band;
+    real_type peak = 0;
+    for (int i = 0; i < bins; ++i)
+        peak = std::max(
+            peak,
+            std::norm(spectrum_type{in[2 * i], in[2 * i + 1]})
+        );
+    EXPECT_NEAR(
+        peak,
+        k.rampBand(band.data(), band.data(), bins, 2, 0.5),
+        1e-6
+    );
+    for (int i = 0; i < bins; ++i) {
+        const auto gain = 2 + (i + 1) * 0.5;
+        EXPECT_NEAR(in[2 * i] * gain, band[2 * i], 1e-4);
+        EXPECT_NEAR(in[2 * i + 1] * gain, band[2 * i + 1], 1e-4);
+    }
+}
+
+TEST_P(KernelsTests, rampSignalScalesByInterpolatedGainAndReturnsPeak) {
+    const auto in = samples(bins, 1);
+    std::vector<real_type> out(bins);
+    real_type peak = 0;
+    for (auto x : in)
+        peak = std::max(peak, x * x);
+    EXPECT_NEAR(
+        peak,
+        k.rampSignal(in.data(), out.data(), bins, 1, -0.01F),
+        1e-6
+    );
+    for (int i = 0; i < bins; ++i)
+        EXPECT_NEAR(in[i] * (1 - (i + 1) * 0.01), out[i], 1e-5);
+}
+
+TEST_P(KernelsTests, dotProductSumsProducts) {
+    const auto a = samples(bins, 1);
+    const auto b = samples(bins, 3);
+    for (int n : {0, 1, 8, bins}) {
+        double expected = 0;
+        for (int i = 0; i < n; ++i)
+            expected += a[i] * b[i];
+        EXPECT_NEAR(expected, k.dotProduct(a.data(), b.data(), n), 1e-5);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    SupportedLevels,
+    KernelsTests,
+    ::testing::ValuesIn(supportedKernels()),
+    [](const ::testing::TestParamInfo<const Kernels *> &info) {
+        auto name = std::string{info.param->level};
+        std::replace(name.begin(), name.end(), '-', '_');
+        return name;
+    }
+);
+
+TEST(KernelsSelectionTests, selectedLevelIsBestSupported) {
+    const auto levels = supportedKernels();
+    assertEqual(std::string{"generic"}, std::string{levels.back()->level});
+    if (!std::getenv("HEARING_AID_KERNELS"))
+        assertEqual(levels.front(), &kernels());
+}
+
+GainTrajectory::Parameters trajectory() {
+    GainTrajectory::Parameters p{};
+    p.curve.compressionRatio = 2;
+    p.curve.kneepoint = 40;
+    p.curve.kneepointGain = 10;
+    p.curve.broadbandOutputLimitingThreshold = 100;
+    p.attack = 5;
+    p.release = 50;
+    p.sampleRate = 16000;
+    p.fullScaleLevel = 119;
+    p.controlInterval = 8;
+    return p;
+}
+
+TEST(GainTrajectoryTests, applyToBandMatchesNext) {
+    GainTrajectory stepped{trajectory()};
+    GainTrajectory applied{trajectory()};
+    auto band = samples(2 * 100, 1);
+    std::vector<real_type> expected(band.size());
+    for (int i = 0; i < 100; ++i) {
+        const auto re = band[2 * i];
+        const auto im = band[2 * i + 1];
+        const auto gain = stepped.next(re * re + im * im);
+        expected[2 * i] = re * gain;
+        expected[2 * i + 1] = im * gain;
+    }
+    // Spans partial and whole control intervals.
+    applied.applyToBand(band.data(), band.data(), 13);
+    applied.applyToBand(band.data() + 26, band.data() + 26, 87);
+    for (std::size_t i = 0; i < band.size(); ++i)
+        EXPECT_NEAR(expected[i], band[i], 1e-5);
+    EXPECT_NEAR(stepped.gain(), applied.gain(), 1e-5);
+    EXPECT_NEAR(stepped.levelDecibels(), applied.levelDecibels(), 1e-4);
+}
+}}
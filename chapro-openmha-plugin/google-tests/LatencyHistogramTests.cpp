@@ -0,0 +1,67 @@
+#include "assert-utility.h"
+#include <hearing-aid/LatencyHistogram.h>
+#include <gtest/gtest.h>
+
+namespace hearing_aid::tests { namespace {
+class LatencyHistogramTests : public ::testing::Test {
+protected:
+    LatencyHistogram histogram;
+
+    void recordOneToN(std::uint64_t n) {
+        for (std::uint64_t i = 1; i <= n; ++i)
+            histogram.record(i);
+    }
+};
+
+TEST_F(LatencyHistogramTests, emptyHistogramReportsZero) {
+    assertEqual(std::uint64_t{0}, histogram.percentile(0.5));
+    assertEqual(std::uint64_t{0}, histogram.max());
+    assertEqual(std::uint64_t{0}, histogram.count());
+}
+
+TEST_F(LatencyHistogramTests, smallValuesAreExact) {
+    recordOneToN(50);
+    assertEqual(std::uint64_t{25}, histogram.percentile(0.5));
+    assertEqual(std::uint64_t{50}, histogram.percentile(1));
+}
+
+TEST_F(LatencyHistogramTests, largeValuesAreWithinOneThirtySecond) {
+    recordOneToN(100000);
+    EXPECT_NEAR(50000, histogram.percentile(0.5), 50000 / 32.);
+    EXPECT_NEAR(99000, histogram.percentile(0.99), 99000 / 32.);
+    EXPECT_NEAR(99900, histogram.percentile(0.999), 99900 / 32.);
+}
+
+TEST_F(LatencyHistogramTests, percentileNeverExceedsMax) {
+    histogram.record(1000);
+    assertEqual(std::uint64_t{1000}, histogram.percentile(1));
+}
+
+TEST_F(LatencyHistogramTests, tracksMaxCountAndMean) {
+    recordOneToN(4);
+    assertEqual(std::uint64_t{4}, histogram.max());
+    assertEqual(std::uint64_t{4}, histogram.count());
+    assertEqual(2.5, histogram.mean());
+}
+
+TEST_F(LatencyHistogramTests, recordsLargestValues) {
+    histogram.record(~std::uint64_t{0});
+    assertEqual(~std::uint64_t{0}, histogram.percentile(1));
+}
+
+TEST_F(LatencyHistogramTests, mergesCounts) {
+    LatencyHistogram other;
+    other.record(100);
+    histogram.record(10);
+    histogram.merge(other);
+    assertEqual(std::uint64_t{2}, histogram.count());
+    assertEqual(std::uint64_t{100}, histogram.max());
+}
+
+TEST_F(LatencyHistogramTests, clearForgetsValues) {
+    recordOneToN(10);
+    histogram.clear();
+    assertEqual(std::uint64_t{0}, histogram.count());
+    assertEqual(std::uint64_t{0}, histogram.percentile(0.5));
+}
+}}
@@ -0,0 +1,101 @@
+#include "assert-utility.h"
+#include <hearing-aid/LatencyMeasurement.h>
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace hearing_aid::tests { namespace {
+// Filters by a sparse impulse response given as (delay, gain) taps.
+class TapsPipeline : public SweepPipeline {
+    std::vector<std::pair<int, real_type>> taps;
+    std::vector<real_type> history;
+public:
+    explicit TapsPipeline(std::vector<std::pair<int, real_type>> taps) :
+        taps{std::move(taps)} {}
+
+    void process(real_signal_type x) override {
+        for (auto &sample : x) {
+            history.push_back(sample);
+            const auto n = static_cast<int>(history.size()) - 1;
+            real_type y = 0;
+            for (auto [delay, gain] : taps)
+                if (n >= delay)
+                    y += gain * history[n - delay];
+            sample = y;
+        }
+    }
+
+    std::vector<real_type> qualityMetric() override {
+        return {};
+    }
+};
+
+class TapsBackend : public SweepBackend {
+public:
+    std::vector<std::pair<int, real_type>> taps;
+    int made{};
+
+    std::unique_ptr<SweepPipeline> make(
+        const HearingAidBuilder::Parameters &
+    ) override {
+        ++made;
+        return std::make_unique<TapsPipeline>(taps);
+    }
+};
+
+class LatencyMeasurementTests : public ::testing::Test {
+protected:
+    TapsBackend backend;
+    LatencyMeasurement::Parameters parameters{};
+    HearingAidBuilder::Parameters fitting{};
+
+    LatencyMeasurementTests() {
+        parameters.level = 65;
+        parameters.length = 1000;
+        fitting.crossFrequencies = {1000, 4000};
+        fitting.sampleRate = 16000;
+        fitting.fullScaleLevel = 119;
+        fitting.chunkSize = 32;
+    }
+
+    LatencyMeasurement::Result measure() {
+        LatencyMeasurement measurement{&backend, parameters};
+        return measurement.measure(fitting);
+    }
+};
+
+TEST_F(LatencyMeasurementTests, bandCentersAreGeometricMeansOfEdges) {
+    const auto centers =
+        LatencyMeasurement::bandCenters({1000, 4000}, 16000);
+    assertEqual(std::size_t{3}, centers.size());
+    assertEqual(500., centers[0]);
+    assertEqual(2000., centers[1]);
+    EXPECT_NEAR(std::sqrt(4000. * 8000), centers[2], 1e-9);
+}
+
+TEST_F(LatencyMeasurementTests, delayIsOnsetPeakAndGroupDelay) {
+    backend.taps = {{37, real_type{2}}};
+    const auto result = measure();
+    assertEqual(37, result.onset);
+    assertEqual(37, result.peak);
+    assertEqual(std::size_t{3}, result.bands.size());
+    for (const auto &band : result.bands)
+        EXPECT_NEAR(37, band.groupDelay, 0.05);
+}
+
+TEST_F(LatencyMeasurementTests, onsetPrecedesPeak) {
+    backend.taps = {{5, real_type{0.5}}, {20, real_type{1}}};
+    const auto result = measure();
+    assertEqual(5, result.onset);
+    assertEqual(20, result.peak);
+}
+
+TEST_F(LatencyMeasurementTests, fragmentContributionIsTwoChunks) {
+    assertEqual(64, measure().fragment);
+}
+
+TEST_F(LatencyMeasurementTests, eachProbeUsesFreshHearingAid) {
+    backend.taps = {{0, real_type{1}}};
+    measure();
+    assertEqual(2, backend.made);
+}
+}}
@@ -0,0 +1,223 @@
+#include "assert-utility.h"
+#include <hearing-aid/MinimumPhaseFilterbank.h>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+
+namespace hearing_aid::tests { namespace {
+std::complex<double> response(
+    const std::vector<real_type> &h,
+    double frequency
+) {
+    constexpr auto pi = 3.14159265358979323846;
+    std::complex<double> sum;
+    for (std::vector<real_type>::size_type n = 0; n < h.size(); ++n)
+        sum += double{h[n]} * std::polar(1., -2 * pi * frequency * n);
+    return sum;
+}
+
+double magnitude(const std::vector<real_type> &h, double frequency) {
+    return std::abs(response(h, frequency));
+}
+
+// Largest deviation in dB of the bands' summed real parts from a flat
+// response, below 0.9 times the Nyquist frequency: the even-length bands
+// all vanish at the Nyquist frequency.
+double summedRipple(const MinimumPhaseFilterbank::Parameters &p) {
+    const auto bands = complementaryBands(p);
+    double ripple = 0;
+    for (int i = 0; i < 900; ++i) {
+        const auto f = i / 2000.;
+        std::complex<double> sum;
+        for (const auto &band : bands)
+            sum += response(band.real, f);
+        ripple = std::max(ripple, std::abs(20 * std::log10(std::abs(sum))));
+    }
+    return ripple;
+}
+
+// Mean delay of the filter's energy, in samples.
+double centroid(const std::vector<real_type> &h) {
+    double weighted = 0;
+    double energy = 0;
+    for (std::vector<real_type>::size_type n = 0; n < h.size(); ++n) {
+        weighted += n * double{h[n]} * h[n];
+        energy += double{h[n]} * h[n];
+    }
+    return weighted / energy;
+}
+
+class MinimumPhaseFilterbankTests : public ::testing::Test {
+protected:
+    MinimumPhaseFilterbank::Parameters p{};
+
+    MinimumPhaseFilterbankTests() {
+        p.crossFrequencies = {1000, 3000};
+        p.sampleRate = 16000;
+        p.windowSize = 64;
+        p.chunkSize = 16;
+    }
+};
+
+TEST_F(MinimumPhaseFilterbankTests, minimumPhaseKeepsMinimumPhaseFilter) {
+    const auto h = minimumPhase({1, 0.5});
+    EXPECT_NEAR(1, h[0], 1e-3);
+    EXPECT_NEAR(0.5, h[1], 1e-3);
+}
+
+TEST_F(MinimumPhaseFilterbankTests, minimumPhaseReflectsMaximumPhaseFilter) {
+    const auto h = minimumPhase({0.5, 1});
+    EXPECT_NEAR(1, h[0], 1e-3);
+    EXPECT_NEAR(0.5, h[1], 1e-3);
+}
+
+TEST_F(MinimumPhaseFilterbankTests, minimumPhaseBandsKeepPassbandMagnitude) {
+    for (const auto &band : linearPhaseBands(p)) {
+        const auto h = minimumPhase(band);
+        for (int i = 0; i < 64; ++i) {
+            const auto f = i / 128.;
+            const auto expected = magnitude(band, f);
+            if (expected > 0.1) {
+                EXPECT_NEAR(
+                    20 * std::log10(expected),
+                    20 * std::log10(magnitude(h, f)),
+                    0.5
+                );
+            }
+        }
+    }
+}
+
+TEST_F(MinimumPhaseFilterbankTests, minimumPhaseBandsHaveLessDelay) {
+    for (const auto &band : linearPhaseBands(p))
+        assertTrue(centroid(minimumPhase(band)) < centroid(band) / 2);
+}
+
+TEST_F(MinimumPhaseFilterbankTests, complementaryBandsSumFlat) {
+    assertTrue(summedRipple(p) < 1);
+}
+
+TEST_F(MinimumPhaseFilterbankTests, complementaryBandsSumFlatForChaproFitting) {
+    p.crossFrequencies = {317, 503, 798, 1265, 2006, 3181, 5045};
+    p.sampleRate = 44100;
+    p.windowSize = 256;
+    p.chunkSize = 64;
+    assertTrue(summedRipple(p) < 1);
+    p.windowSize = 128;
+    assertTrue(summedRipple(p) < 1);
+    p.sampleRate = 22050;
+    assertTrue(summedRipple(p) < 1);
+}
+
+TEST_F(MinimumPhaseFilterbankTests, complementaryBandsKeepPassbands) {
+    const auto bands = complementaryBands(p);
+    // Band centers and the other bands' centers.
+    const std::vector<double> centers{250, 2000, 5500};
+    for (std::size_t k = 0; k < bands.size(); ++k)
+        for (std::size_t j = 0; j < centers.size(); ++j) {
+            const auto level = 20 * std::log10(
+                magnitude(bands[k].real, centers[j] / p.sampleRate)
+            );
+            if (j == k)
+                EXPECT_NEAR(0, level, 0.5);
+            else
+                assertTrue(level < -30);
+        }
+}
+
+TEST_F(MinimumPhaseFilterbankTests, complementaryBandsHaveLessDelay) {
+    const auto linear = linearPhaseBands(p);
+    const auto bands = complementaryBands(p);
+    for (std::size_t k = 0; k < bands.size(); ++k)
+        assertTrue(centroid(bands[k].real) < centroid(linear[k]) / 2);
+}
+
+TEST_F(MinimumPhaseFilterbankTests, complementaryBandsAreAnalytic) {
+    const auto bands = complementaryBands(p);
+    const std::vector<double> centers{500, 2000, 5500};
+    for (std::size_t k = 0; k < bands.size(); ++k) {
+        const auto f = centers[k] / p.sampleRate;
+        const auto analytic = [&](double frequency) {
+            return std::abs(
+                response(bands[k].real, frequency) +
+                std::complex<double>{0, 1} *
+                    response(bands[k].imaginary, frequency)
+            );
+        };
+        assertTrue(analytic(-f) < 0.1 * analytic(f));
+    }
+}
+
+TEST_F(MinimumPhaseFilterbankTests, bandEnvelopeOfToneIsSteady) {
+    constexpr auto pi = 3.14159265358979323846;
+    MinimumPhaseFilterbank filterbank{p};
+    std::vector<real_type> x(16);
+    std::vector<complex_type> y(2 * 16 * 3);
+    double low = 2;
+    double high = 0;
+    for (int n = 0; n < 40; ++n) {
+        for (int i = 0; i < 16; ++i)
+            x[i] = real_type(std::sin(2 * pi * 2000 / 16000 * (16 * n + i)));
+        filterbank.filterbankAnalyze(x, y, 16);
+        if (n < 8)
+            continue;
+        for (int i = 0; i < 16; ++i) {
+            const auto envelope = std::abs(std::complex<double>{
+                y[2 * 16 + 2 * i],
+                y[2 * 16 + 2 * i + 1]
+            });
+            low = std::min(low, envelope);
+            high = std::max(high, envelope);
+        }
+    }
+    EXPECT_NEAR(0, 20 * std::log10(low), 1);
+    EXPECT_NEAR(0, 20 * std::log10(high), 1);
+}
+
+TEST_F(MinimumPhaseFilterbankTests, partitionsCoverWindow) {
+    assertEqual(4, MinimumPhaseFilterbank{p}.partitions());
+    p.windowSize = 65;
+    assertEqual(5, MinimumPhaseFilterbank{p}.partitions());
+}
+
+TEST_F(MinimumPhaseFilterbankTests, analysisConvolvesWithComplementaryBands) {
+    MinimumPhaseFilterbank filterbank{p};
+    std::vector<real_type> x;
+    for (int i = 0; i < 6 * 16; ++i)
+        x.push_back(real_type(std::sin(0.3 * i) + 0.5 * std::cos(1.7 * i)));
+    const auto bands = complementaryBands(p);
+    std::vector<complex_type> y(2 * 16 * 3);
+    for (int n = 0; n < 6; ++n) {
+        filterbank.filterbankAnalyze({x.data() + 16 * n, 16}, y, 16);
+        for (int k = 0; k < 3; ++k)
+            for (int i = 0; i < 16; ++i) {
+                const auto t = 16 * n + i;
+                double real = 0;
+                double imaginary = 0;
+                for (int j = 0; j < 64 && j <= t; ++j) {
+                    real += double{bands[k].real[j]} * x[t - j];
+                    imaginary += double{bands[k].imaginary[j]} * x[t - j];
+                }
+                EXPECT_NEAR(real, y[2 * 16 * k + 2 * i], 1e-4);
+                EXPECT_NEAR(imaginary, y[2 * 16 * k + 2 * i + 1], 1e-4);
+            }
+    }
+}
+
+TEST_F(MinimumPhaseFilterbankTests, synthesisSumsBands) {
+    MinimumPhaseFilterbank filterbank{p};
+    std::vector<complex_type> bands(2 * 16 * 3);
+    for (int k = 0; k < 3; ++k)
+        bands[2 * 16 * k + 2] = complex_type(k + 1);
+    std::vector<real_type> y(16);
+    filterbank.filterbankSynthesize(bands, y, 16);
+    assertEqual(real_type{0}, y[0]);
+    assertEqual(real_type{6}, y[1]);
+}
+
+TEST_F(MinimumPhaseFilterbankTests, nonPositiveWindowSizeThrows) {
+    p.windowSize = 0;
+    EXPECT_THROW(MinimumPhaseFilterbank{p}, std::invalid_argument);
+}
+}}
@@ -0,0 +1,150 @@
+#include "assert-utility.h"
+#include <hearing-aid/ParameterSweep.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <thread>
+
+namespace hearing_aid::tests { namespace {
+class ScalingPipeline : public SweepPipeline {
+    real_type gain;
+    int fragments{};
+public:
+    explicit ScalingPipeline(real_type gain) : gain{gain} {}
+
+    void process(real_signal_type x) override {
+        for (auto &sample : x)
+            sample *= gain;
+        ++fragments;
+    }
+
+    std::vector<real_type> qualityMetric() override {
+        std::vector<real_type> metric;
+        for (int i = 0; i < fragments; ++i)
+            metric.push_back(real_type(i));
+        return metric;
+    }
+};
+
+// Scales by the first kneepoint gain.
+class ScalingBackend : public SweepBackend {
+    std::mutex mutex;
+    std::vector<HearingAidBuilder::Parameters> made_;
+    std::atomic<int> making{0};
+    std::atomic<bool> overlapped_{false};
+public:
+    auto made() {
+        return made_;
+    }
+
+    bool overlapped() const {
+        return overlapped_.load();
+    }
+
+    std::unique_ptr<SweepPipeline> make(
+        const HearingAidBuilder::Parameters &p
+    ) override {
+        if (making.fetch_add(1) > 0)
+            overlapped_.store(true);
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        making.fetch_sub(1);
+        std::lock_guard<std::mutex> lock{mutex};
+        made_.push_back(p);
+        return std::make_unique<ScalingPipeline>(
+            p.kneepointGains.empty() ? 1 : real_type(p.kneepointGains.front())
+        );
+    }
+};
+
+class ParameterSweepTests : public ::testing::Test {
+protected:
+    ScalingBackend backend;
+    HearingAidBuilder::Parameters fitting{};
+    ParameterSweep::Grid grid{};
+    ParameterSweep::Input input{};
+    ParameterSweep::Metrics metrics{};
+
+    ParameterSweepTests() {
+        fitting.chunkSize = 4;
+        fitting.fullScaleLevel = 100;
+        input.signal.assign(16, real_type{0.1});
+    }
+
+    std::vector<ParameterSweep::Result> run(int threads = 1) {
+        ParameterSweep sweep{&backend, threads};
+        return sweep.run(fitting, grid, input, metrics);
+    }
+};
+
+TEST_F(ParameterSweepTests, pointsAreEveryCombination) {
+    grid.compressionRatios = {{1}, {2}};
+    grid.kneepoints = {{3}, {4}, {5}};
+    grid.kneepointGains = {{6}};
+    const auto points = ParameterSweep::points(grid);
+    assertEqual(std::size_t{6}, points.size());
+    assertEqual(std::vector<double>{1}, points[0].compressionRatios);
+    assertEqual(std::vector<double>{3}, points[0].kneepoints);
+    assertEqual(std::vector<double>{4}, points[1].kneepoints);
+    assertEqual(std::vector<double>{2}, points[5].compressionRatios);
+    assertEqual(std::vector<double>{5}, points[5].kneepoints);
+    assertEqual(std::vector<double>{6}, points[5].kneepointGains);
+}
+
+TEST_F(ParameterSweepTests, emptyDimensionKeepsFitting) {
+    fitting.compressionRatios = {7, 8};
+    grid.kneepointGains = {{1}, {2}};
+    const auto results = run();
+    assertEqual(std::size_t{2}, results.size());
+    assertEqual(std::vector<double>{7, 8}, results[1].compressionRatios);
+    assertEqual(std::vector<double>{2}, results[1].kneepointGains);
+    assertEqual(std::vector<double>{2}, backend.made()[1].kneepointGains);
+}
+
+TEST_F(ParameterSweepTests, levelIsOutputLevel) {
+    grid.kneepointGains = {{2}};
+    metrics.level = true;
+    EXPECT_NEAR(100 + 20 * std::log10(0.2), run().front().level, 1e-4);
+}
+
+TEST_F(ParameterSweepTests, snrOfLinearPipelineIsInputSnr) {
+    grid.kneepointGains = {{3}};
+    metrics.snr = true;
+    for (int i = 0; i < 16; ++i)
+        input.noise.push_back(i % 2 ? real_type{0.01} : real_type{-0.01});
+    EXPECT_NEAR(20, run().front().snr, 1e-4);
+}
+
+TEST_F(ParameterSweepTests, feedbackQualityIsMeanOfSecondHalf) {
+    metrics.feedbackQuality = true;
+    const auto result = run().front();
+    EXPECT_NEAR((2 + 3) / 2., result.feedbackQuality, 1e-9);
+    assertEqual(1, backend.made().front().saveQualityMetric);
+    assertEqual(4, backend.made().front().qualityMetricLength);
+}
+
+TEST_F(ParameterSweepTests, unrequestedMetricsAreNan) {
+    const auto result = run().front();
+    assertTrue(std::isnan(result.level));
+    assertTrue(std::isnan(result.snr));
+    assertTrue(std::isnan(result.feedbackQuality));
+}
+
+TEST_F(ParameterSweepTests, parallelRunMatchesSerialRun) {
+    grid.kneepointGains = {{1}, {2}, {3}, {4}, {5}};
+    metrics.level = true;
+    const auto serial = run(1);
+    const auto parallel = run(3);
+    for (std::size_t i = 0; i < serial.size(); ++i)
+        assertEqual(serial[i].level, parallel[i].level);
+}
+
+TEST_F(ParameterSweepTests, buildsOnePipelineAtATime) {
+    grid.kneepointGains = {{1}, {2}, {3}, {4}, {5}, {6}};
+    input.noise.assign(16, real_type{0.01});
+    metrics.snr = true;
+    run(3);
+    assertEqual(std::size_t{12}, backend.made().size());
+    assertTrue(!backend.overlapped());
+}
+}}
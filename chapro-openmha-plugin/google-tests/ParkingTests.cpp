@@ -0,0 +1,55 @@
+#include "assert-utility.h"
+#include <hearing-aid/Parking.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <ctime>
+#include <thread>
+
+namespace hearing_aid::tests { namespace {
+class ParkingTests : public ::testing::Test {
+protected:
+    Parking parking;
+    std::atomic<bool> ready{false};
+
+    void wait() {
+        parking.wait([&] { return ready.load(); });
+    }
+
+    void setReady() {
+        ready.store(true);
+        parking.notify();
+    }
+};
+
+TEST_F(ParkingTests, returnsAtOnceWhenReady) {
+    setReady();
+    wait();
+    assertTrue(ready.load());
+}
+
+TEST_F(ParkingTests, wakesWaiterWithinSpin) {
+    std::thread waiter{[&] { wait(); }};
+    setReady();
+    waiter.join();
+    assertTrue(ready.load());
+}
+
+TEST_F(ParkingTests, wakesParkedWaiter) {
+    std::thread waiter{[&] { wait(); }};
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    setReady();
+    waiter.join();
+    assertTrue(ready.load());
+}
+
+TEST_F(ParkingTests, parkedWaiterUsesNoProcessorTime) {
+    std::thread waiter{[&] { wait(); }};
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    const auto start = std::clock();
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    const auto used = std::clock() - start;
+    setReady();
+    waiter.join();
+    assertTrue(used < CLOCKS_PER_SEC / 100);
+}
+}}
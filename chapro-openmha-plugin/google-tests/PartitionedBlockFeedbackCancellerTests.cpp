@@ -0,0 +1,162 @@
+#include "LogString.h"
+#include "assert-utility.h"
+#include <hearing-aid/PartitionedBlockFeedbackCanceller.h>
+#include <gtest/gtest.h>
+#include <cstdint>
+
+namespace hearing_aid::tests { namespace {
+class SuperSignalProcessorStub : public SuperSignalProcessor {
+    LogString log_;
+    int chunkSize_{};
+public:
+    auto &log() const {
+        return log_;
+    }
+
+    void setChunkSize(int c) {
+        chunkSize_ = c;
+    }
+
+    void feedbackCancelInput(
+        real_signal_type,
+        real_signal_type,
+        int
+    ) override {
+        log_.insert("feedbackCancelInput");
+    }
+
+    void compressInput(real_signal_type, real_signal_type, int) override {
+        log_.insert("compressInput");
+    }
+
+    void compressChannel(
+        complex_signal_type,
+        complex_signal_type,
+        int
+    ) override {
+        log_.insert("compressChannel");
+    }
+
+    void compressOutput(real_signal_type, real_signal_type, int) override {
+        log_.insert("compressOutput");
+    }
+
+    void feedbackCancelOutput(real_signal_type, int) override {
+        log_.insert("feedbackCancelOutput");
+    }
+
+    int chunkSize() override {
+        return chunkSize_;
+    }
+
+    int channels() override {
+        return 0;
+    }
+};
+
+class PartitionedBlockFeedbackCancellerTests : public ::testing::Test {
+protected:
+    using buffer_type = std::vector<real_type>;
+    std::shared_ptr<SuperSignalProcessorStub> processor =
+        std::make_shared<SuperSignalProcessorStub>();
+    PartitionedBlockFeedbackCanceller::Parameters p{};
+    std::uint32_t seed{1};
+
+    PartitionedBlockFeedbackCancellerTests() {
+        processor->setChunkSize(16);
+        p.filterEstimationForgettingFactor = 0.9;
+        p.filterEstimationPowerThreshold = 1e-6;
+        p.filterEstimationStepSize = 0.2;
+        p.adaptiveFilterLength = 48;
+    }
+
+    PartitionedBlockFeedbackCanceller make() {
+        return PartitionedBlockFeedbackCanceller{processor, p};
+    }
+
+    real_type noise() {
+        seed = 1664525 * seed + 1013904223;
+        return static_cast<real_type>(seed >> 8) / (1 << 23) - 1;
+    }
+
+    // Returns the residual-to-feedback energy ratio over the last chunks of
+    // a run where the microphone picks up the output through a path with
+    // the given delay (beyond the one-chunk reference delay) and gain.
+    double residualRatio(int blocks, int pathDelay, real_type pathGain) {
+        auto canceller = make();
+        const auto chunk = 16;
+        const auto latency = chunk + p.hardwareLatency + pathDelay;
+        buffer_type history(blocks * chunk + latency);
+        double residual = 0;
+        double feedback = 0;
+        for (int m = 0; m < blocks; ++m) {
+            buffer_type x(chunk);
+            for (int i = 0; i < chunk; ++i)
+                x.at(i) = pathGain * history.at(m * chunk + i);
+            buffer_type e(chunk);
+            canceller.feedbackCancelInput(x, e, chunk);
+            if (m >= blocks - 50)
+                for (int i = 0; i < chunk; ++i) {
+                    residual += e.at(i) * e.at(i);
+                    feedback += x.at(i) * x.at(i);
+                }
+            buffer_type u(chunk);
+            for (auto &sample : u)
+                sample = noise();
+            for (int i = 0; i < chunk; ++i)
+                history.at(m * chunk + i + latency) = u.at(i);
+            canceller.feedbackCancelOutput(u, chunk);
+        }
+        return residual / feedback;
+    }
+};
+
+TEST_F(PartitionedBlockFeedbackCancellerTests, forwardsCompression) {
+    auto canceller = make();
+    buffer_type x(16);
+    buffer_type z(32);
+    canceller.compressInput(x, x, 16);
+    canceller.compressChannel(z, z, 16);
+    canceller.compressOutput(x, x, 16);
+    assertEqual(
+        "compressInput"
+        "compressChannel"
+        "compressOutput",
+        processor->log()
+    );
+}
+
+TEST_F(PartitionedBlockFeedbackCancellerTests, doesNotForwardFeedbackCancellation) {
+    auto canceller = make();
+    buffer_type x(16);
+    canceller.feedbackCancelInput(x, x, 16);
+    canceller.feedbackCancelOutput(x, 16);
+    assertTrue(processor->log().isEmpty());
+}
+
+TEST_F(PartitionedBlockFeedbackCancellerTests, partitionsCoverFilterLength) {
+    p.adaptiveFilterLength = 40;
+    assertEqual(3, make().partitions());
+}
+
+TEST_F(PartitionedBlockFeedbackCancellerTests, passesInputBeforeAnyOutput) {
+    auto canceller = make();
+    buffer_type x(16, 0.5F);
+    buffer_type e(16);
+    canceller.feedbackCancelInput(x, e, 16);
+    assertEqual(x, e);
+}
+
+TEST_F(PartitionedBlockFeedbackCancellerTests, cancelsStaticFeedbackPath) {
+    assertTrue(residualRatio(1500, 5, 0.5F) < 1e-3);
+}
+
+TEST_F(PartitionedBlockFeedbackCancellerTests, modelsPathBeyondFirstPartition) {
+    assertTrue(residualRatio(1500, 20, 0.5F) < 1e-3);
+}
+
+TEST_F(PartitionedBlockFeedbackCancellerTests, accountsForHardwareLatency) {
+    p.hardwareLatency = 40;
+    assertTrue(residualRatio(1500, 3, 0.5F) < 1e-3);
+}
+}}
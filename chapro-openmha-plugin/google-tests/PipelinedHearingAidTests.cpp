@@ -0,0 +1,265 @@
+#include "assert-utility.h"
+#include <hearing-aid/PipelinedHearingAid.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <ctime>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+
+namespace hearing_aid::tests { namespace {
+// Analysis copies the signal into the real part of the first band,
+// compression doubles every band and synthesis sums the real parts.
+class SuperSignalProcessorStub :
+    public SuperSignalProcessor,
+    public Filter
+{
+    std::mutex mutex;
+    std::set<std::thread::id> feedbackThreads_;
+    std::set<std::thread::id> automaticGainControlThreads_;
+    std::atomic<bool> holding{false};
+    int chunkSize_{};
+    int channels_{};
+public:
+    void setChunkSize(int c) {
+        chunkSize_ = c;
+    }
+
+    void setChannels(int c) {
+        channels_ = c;
+    }
+
+    auto feedbackThreads() {
+        std::lock_guard<std::mutex> lock{mutex};
+        return feedbackThreads_;
+    }
+
+    auto automaticGainControlThreads() {
+        std::lock_guard<std::mutex> lock{mutex};
+        return automaticGainControlThreads_;
+    }
+
+    // Channel compression does not return while held.
+    void hold(bool h) {
+        holding.store(h);
+    }
+
+    void feedbackCancelInput(
+        real_signal_type,
+        real_signal_type,
+        int
+    ) override {
+        std::lock_guard<std::mutex> lock{mutex};
+        feedbackThreads_.insert(std::this_thread::get_id());
+    }
+
+    void compressInput(real_signal_type, real_signal_type, int) override {
+        std::lock_guard<std::mutex> lock{mutex};
+        automaticGainControlThreads_.insert(std::this_thread::get_id());
+    }
+
+    void filterbankAnalyze(
+        real_signal_type x,
+        complex_signal_type z,
+        int c
+    ) override {
+        std::fill(z.begin(), z.end(), complex_type{0});
+        for (int i = 0; i < c; ++i)
+            z[2 * i] = x[i];
+    }
+
+    void compressChannel(
+        complex_signal_type in,
+        complex_signal_type out,
+        int
+    ) override {
+        while (holding.load())
+            std::this_thread::yield();
+        for (int i = 0; i < in.size(); ++i)
+            out[i] = 2 * in[i];
+        std::lock_guard<std::mutex> lock{mutex};
+        automaticGainControlThreads_.insert(std::this_thread::get_id());
+    }
+
+    void filterbankSynthesize(
+        complex_signal_type z,
+        real_signal_type x,
+        int c
+    ) override {
+        for (int i = 0; i < c; ++i) {
+            x[i] = 0;
+            for (int k = 0; k < channels_; ++k)
+                x[i] += z[2 * c * k + 2 * i];
+        }
+    }
+
+    void compressOutput(real_signal_type, real_signal_type, int) override {
+        std::lock_guard<std::mutex> lock{mutex};
+        automaticGainControlThreads_.insert(std::this_thread::get_id());
+    }
+
+    void feedbackCancelOutput(real_signal_type, int) override {
+        std::lock_guard<std::mutex> lock{mutex};
+        feedbackThreads_.insert(std::this_thread::get_id());
+    }
+
+    int chunkSize() override {
+        return chunkSize_;
+    }
+
+    int channels() override {
+        return channels_;
+    }
+};
+
+class BandCompressorStub :
+    public SuperSignalProcessorStub,
+    public BandCompressor
+{
+    std::mutex mutex;
+    std::multiset<int> compressedChannels_;
+public:
+    auto compressedChannels() {
+        std::lock_guard<std::mutex> lock{mutex};
+        return compressedChannels_;
+    }
+
+    void compressChannels(
+        complex_signal_type,
+        complex_signal_type,
+        int,
+        int first,
+        int count
+    ) override {
+        std::lock_guard<std::mutex> lock{mutex};
+        for (int c = first; c < first + count; ++c)
+            compressedChannels_.insert(c);
+    }
+};
+
+class PipelinedHearingAidTests : public ::testing::Test {
+protected:
+    using buffer_type = std::vector<real_type>;
+    std::shared_ptr<SuperSignalProcessorStub> processor =
+        std::make_shared<SuperSignalProcessorStub>();
+    PipelinedHearingAid::Parameters p{};
+
+    PipelinedHearingAidTests() {
+        processor->setChunkSize(4);
+        processor->setChannels(3);
+        p.bandThreads = 1;
+    }
+
+    std::unique_ptr<PipelinedHearingAid> make(
+        std::shared_ptr<SuperSignalProcessorStub> s
+    ) {
+        return std::make_unique<PipelinedHearingAid>(s, s, p);
+    }
+
+    // The calling thread does not wait for the workers, so fragments are
+    // paced like audio to let them keep up.
+    static buffer_type processPaced(PipelinedHearingAid &hearingAid, int n) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{2});
+        buffer_type x(4, static_cast<real_type>(n + 1));
+        hearingAid.process(x);
+        return x;
+    }
+
+    std::vector<buffer_type> processConstantFragments(int count) {
+        auto hearingAid = make(processor);
+        std::vector<buffer_type> outputs;
+        for (int n = 0; n < count; ++n)
+            outputs.push_back(processPaced(*hearingAid, n));
+        assertEqual(0, hearingAid->missedFragments());
+        return outputs;
+    }
+};
+
+TEST_F(PipelinedHearingAidTests, outputsZerosWhilePipelineFills) {
+    auto outputs = processConstantFragments(2);
+    assertEqual(buffer_type(4, 0), outputs.at(0));
+    assertEqual(buffer_type(4, 0), outputs.at(1));
+}
+
+TEST_F(PipelinedHearingAidTests, outputIsDelayedByLatencyFragments) {
+    auto outputs = processConstantFragments(10);
+    for (int n = PipelinedHearingAid::latencyFragments(); n < 10; ++n)
+        assertEqual(
+            buffer_type(4, 2.F * (n - 1)),
+            outputs.at(n)
+        );
+}
+
+TEST_F(PipelinedHearingAidTests, idleStagesPark) {
+    auto hearingAid = make(processor);
+    buffer_type x(4, 1);
+    hearingAid->process(x);
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    const auto start = std::clock();
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    const auto used = std::clock() - start;
+    assertTrue(used < CLOCKS_PER_SEC / 100);
+}
+
+TEST_F(PipelinedHearingAidTests, reportsLatencyInSamples) {
+    assertEqual(2 * 4, make(processor)->latencySamples());
+}
+
+TEST_F(PipelinedHearingAidTests, feedbackCancellationRunsOnCallingThread) {
+    processConstantFragments(5);
+    assertEqual(
+        std::set<std::thread::id>{std::this_thread::get_id()},
+        processor->feedbackThreads()
+    );
+}
+
+TEST_F(PipelinedHearingAidTests, automaticGainControlRunsOnOneWorkerThread) {
+    processConstantFragments(5);
+    auto threads = processor->automaticGainControlThreads();
+    assertEqual(std::set<std::thread::id>::size_type{1}, threads.size());
+    assertTrue(threads.count(std::this_thread::get_id()) == 0);
+}
+
+TEST_F(PipelinedHearingAidTests, lateFragmentIsReplacedByZerosAndDropped) {
+    auto hearingAid = make(processor);
+    processor->hold(true);
+    std::vector<buffer_type> outputs;
+    for (int n = 0; n < 3; ++n) {
+        buffer_type x(4, static_cast<real_type>(n + 1));
+        hearingAid->process(x);
+        outputs.push_back(x);
+    }
+    processor->hold(false);
+    for (int n = 3; n < 10; ++n)
+        outputs.push_back(processPaced(*hearingAid, n));
+    assertEqual(buffer_type(4, 0), outputs.at(2));
+    for (int n = 3; n < 10; ++n)
+        assertEqual(buffer_type(4, 2.F * (n - 1)), outputs.at(n));
+    assertEqual(1, hearingAid->missedFragments());
+}
+
+TEST_F(PipelinedHearingAidTests, ignoresFragmentsOfOtherSizes) {
+    auto hearingAid = make(processor);
+    buffer_type x(3, 1);
+    hearingAid->process(x);
+    assertEqual(buffer_type(3, 1), x);
+}
+
+TEST_F(PipelinedHearingAidTests, bandThreadsShareEachChannelOnce) {
+    auto compressor = std::make_shared<BandCompressorStub>();
+    compressor->setChunkSize(4);
+    compressor->setChannels(8);
+    p.bandThreads = 3;
+    {
+        auto hearingAid = make(compressor);
+        for (int n = 0; n < 5; ++n)
+            processPaced(*hearingAid, n);
+    }
+    auto channels = compressor->compressedChannels();
+    for (int c = 0; c < 8; ++c)
+        assertTrue(channels.count(c) >= 3);
+    for (int c = 0; c < 8; ++c)
+        assertEqual(channels.count(c), channels.count(0));
+}
+}}
@@ -0,0 +1,131 @@
+#include "assert-utility.h"
+#include <hearing-aid/PolyphaseResampler.h>
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace hearing_aid::tests { namespace {
+class PolyphaseResamplerTests : public ::testing::Test {
+protected:
+    using buffer_type = std::vector<real_type>;
+
+    PolyphaseResampler::Parameters parameters(int inputRate, int outputRate) {
+        PolyphaseResampler::Parameters p;
+        p.inputRate = inputRate;
+        p.outputRate = outputRate;
+        p.passband = 0.8;
+        p.stopbandAttenuation = 70;
+        p.maxInput = 64;
+        return p;
+    }
+
+    buffer_type resample(
+        int inputRate,
+        int outputRate,
+        const buffer_type &input
+    ) {
+        PolyphaseResampler resampler{parameters(inputRate, outputRate)};
+        buffer_type output;
+        buffer_type chunk(resampler.maxOutput(64));
+        for (std::size_t i = 0; i + 64 <= input.size(); i += 64) {
+            buffer_type x(input.begin() + i, input.begin() + i + 64);
+            const auto count = resampler.process(x, chunk);
+            output.insert(output.end(), chunk.begin(), chunk.begin() + count);
+        }
+        return output;
+    }
+
+    buffer_type sine(double frequency, int rate, int n) {
+        buffer_type x(n);
+        const auto pi = std::acos(-1.);
+        for (int i = 0; i < n; ++i)
+            x[i] = static_cast<real_type>(std::sin(2 * pi * frequency * i / rate));
+        return x;
+    }
+
+    // Of the component at frequency, by heterodyning it to DC.
+    static double amplitude(
+        const buffer_type &x,
+        double frequency,
+        int rate,
+        std::size_t from
+    ) {
+        const auto pi = std::acos(-1.);
+        double re = 0;
+        double im = 0;
+        for (auto i = from; i < x.size(); ++i) {
+            re += x[i] * std::cos(2 * pi * frequency * i / rate);
+            im += x[i] * std::sin(2 * pi * frequency * i / rate);
+        }
+        return 2 * std::hypot(re, im) / (x.size() - from);
+    }
+
+    static double peak(const buffer_type &x, int from) {
+        double p = 0;
+        for (std::size_t i = from; i < x.size(); ++i)
+            p = std::max(p, std::abs(static_cast<double>(x[i])));
+        return p;
+    }
+};
+
+TEST_F(PolyphaseResamplerTests, reducesRatio) {
+    PolyphaseResampler resampler{parameters(44100, 16000)};
+    assertEqual(160, resampler.upsampling());
+    assertEqual(441, resampler.downsampling());
+}
+
+TEST_F(PolyphaseResamplerTests, producesOutputAtRatio) {
+    const auto output = resample(44100, 16000, buffer_type(44100 / 64 * 64));
+    EXPECT_NEAR(16000 * (44100 / 64 * 64) / 44100., output.size(), 1);
+}
+
+TEST_F(PolyphaseResamplerTests, passesDcWithUnityGainDownsampling) {
+    const auto output = resample(48000, 16000, buffer_type(6400, 1));
+    for (std::size_t i = 100; i < output.size(); ++i)
+        EXPECT_NEAR(1, output[i], 1e-3);
+}
+
+TEST_F(PolyphaseResamplerTests, passesDcWithUnityGainUpsampling) {
+    const auto output = resample(16000, 44100, buffer_type(6400, 1));
+    for (std::size_t i = 200; i < output.size(); ++i)
+        EXPECT_NEAR(1, output[i], 1e-3);
+}
+
+TEST_F(PolyphaseResamplerTests, passesPassbandTone) {
+    const auto output = resample(44100, 16000, sine(1000, 44100, 64 * 200));
+    EXPECT_NEAR(1, peak(output, 100), 1e-2);
+}
+
+TEST_F(PolyphaseResamplerTests, passesToneNearPassbandEdge) {
+    const auto output = resample(44100, 16000, sine(6000, 44100, 64 * 400));
+    EXPECT_NEAR(0, 20 * std::log10(amplitude(output, 6000, 16000, 200)), 0.1);
+}
+
+TEST_F(PolyphaseResamplerTests, rejectsTonesAboveNewNyquist) {
+    for (auto frequency : {8000, 10000, 12000, 20000}) {
+        const auto output =
+            resample(44100, 16000, sine(frequency, 44100, 64 * 400));
+        EXPECT_LT(20 * std::log10(peak(output, 200)), -60) << frequency;
+    }
+}
+
+TEST_F(PolyphaseResamplerTests, rejectsImagesUpsampling) {
+    const auto output = resample(16000, 44100, sine(5000, 16000, 64 * 400));
+    // 5 kHz is imaged at 11 kHz.
+    EXPECT_LT(20 * std::log10(amplitude(output, 11000, 44100, 500)), -60);
+}
+
+TEST_F(PolyphaseResamplerTests, spansPassbandTransitionAtLowerRate) {
+    PolyphaseResampler down{parameters(44100, 16000)};
+    PolyphaseResampler up{parameters(16000, 44100)};
+    // Kaiser's length for 70 dB over 0.1 of the lower rate, per phase.
+    EXPECT_NEAR(44 * 441 / 160., down.taps(), 2);
+    EXPECT_NEAR(44, up.taps(), 2);
+}
+
+TEST_F(PolyphaseResamplerTests, ignoresInputLongerThanMaximum) {
+    PolyphaseResampler resampler{parameters(44100, 16000)};
+    buffer_type x(65);
+    buffer_type y(resampler.maxOutput(65));
+    assertEqual(0, resampler.process(x, y));
+}
+}}
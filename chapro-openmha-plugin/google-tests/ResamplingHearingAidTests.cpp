@@ -0,0 +1,104 @@
+#include "assert-utility.h"
+#include <hearing-aid/ResamplingHearingAid.h>
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace hearing_aid::tests { namespace {
+class SignalProcessorStub : public SignalProcessor {
+    std::vector<int> *sizes;
+public:
+    explicit SignalProcessorStub(std::vector<int> *sizes) : sizes{sizes} {}
+
+    void process(real_signal_type signal) override {
+        sizes->push_back(static_cast<int>(signal.size()));
+    }
+};
+
+class ResamplingHearingAidTests : public ::testing::Test {
+protected:
+    using buffer_type = std::vector<real_type>;
+    std::vector<int> sizes;
+    ResamplingHearingAid::Parameters p{44100, 16000, 32, 0.8, 70};
+
+    std::unique_ptr<ResamplingHearingAid> make() {
+        return std::make_unique<ResamplingHearingAid>(
+            std::make_unique<SignalProcessorStub>(&sizes),
+            p
+        );
+    }
+
+    buffer_type process(const buffer_type &input) {
+        auto hearingAid = make();
+        buffer_type output;
+        for (std::size_t i = 0; i + p.externalChunkSize <= input.size();
+            i += p.externalChunkSize)
+        {
+            buffer_type x(
+                input.begin() + i,
+                input.begin() + i + p.externalChunkSize
+            );
+            hearingAid->process(x);
+            output.insert(output.end(), x.begin(), x.end());
+        }
+        return output;
+    }
+
+    buffer_type sine(int n, int delay = 0) {
+        buffer_type x(n);
+        const auto pi = std::acos(-1.);
+        for (int i = 0; i < n; ++i)
+            x[i] = i < delay ?
+                0.F :
+                static_cast<real_type>(
+                    std::sin(2 * pi * 500 * (i - delay) / p.externalRate)
+                );
+        return x;
+    }
+};
+
+TEST_F(ResamplingHearingAidTests, internalChunkSizeCoversExternalFragment) {
+    assertEqual(12, ResamplingHearingAid::internalChunkSize(p));
+}
+
+TEST_F(ResamplingHearingAidTests, processesInternalFragments) {
+    process(buffer_type(32 * 100));
+    assertFalse(sizes.empty());
+    for (auto size : sizes)
+        assertEqual(12, size);
+}
+
+TEST_F(ResamplingHearingAidTests, processesInternalRateShareOfSamples) {
+    process(buffer_type(32 * 1000));
+    EXPECT_NEAR(32 * 1000 * 16000. / 44100, 12. * sizes.size(), 12);
+}
+
+TEST_F(ResamplingHearingAidTests, delaysSignalByReportedLatency) {
+    const auto latency = make()->latencySamples();
+    const auto output = process(sine(32 * 200));
+    const auto expected = sine(32 * 200, latency);
+    for (std::size_t i = latency + 200; i < output.size(); ++i)
+        EXPECT_NEAR(expected[i], output[i], 0.05);
+}
+
+TEST_F(ResamplingHearingAidTests, reportsLatencyBeforeConstruction) {
+    assertEqual(
+        make()->latencySamples(),
+        ResamplingHearingAid::latencySamples(p)
+    );
+}
+
+TEST_F(ResamplingHearingAidTests, neverRunsDryAtOtherRates) {
+    p = {48000, 24000, 64, 0.8, 70};
+    const auto output = process(buffer_type(64 * 500, 1));
+    const auto latency = make()->latencySamples();
+    for (std::size_t i = latency + 50; i < output.size(); ++i)
+        EXPECT_NEAR(1, output[i], 1e-2);
+}
+
+TEST_F(ResamplingHearingAidTests, ignoresFragmentsOfOtherSizes) {
+    auto hearingAid = make();
+    buffer_type x(31, 1);
+    hearingAid->process(x);
+    assertEqual(buffer_type(31, 1), x);
+}
+}}
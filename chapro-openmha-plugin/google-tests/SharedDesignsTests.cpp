@@ -0,0 +1,64 @@
+#include "assert-utility.h"
+#include <hearing-aid/SharedDesigns.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hearing_aid::tests { namespace {
+class SharedDesignsTests : public ::testing::Test {
+protected:
+    using Design = std::vector<double>;
+    SharedDesigns<std::string, Design> designs;
+    int designed{};
+
+    std::shared_ptr<const Design> acquire(const std::string &key) {
+        return designs.acquire(key, [&] {
+            ++designed;
+            return Design(3, 1.);
+        });
+    }
+};
+
+TEST_F(SharedDesignsTests, sameKeySharesOneDesign) {
+    auto a = acquire("a");
+    auto b = acquire("a");
+    assertTrue(a == b);
+    assertEqual(1, designed);
+}
+
+TEST_F(SharedDesignsTests, differentKeysDesignSeparately) {
+    auto a = acquire("a");
+    auto b = acquire("b");
+    assertTrue(a != b);
+    assertEqual(2, designed);
+    assertEqual(2, designs.size());
+}
+
+TEST_F(SharedDesignsTests, releasesDesignWithLastInstance) {
+    auto a = acquire("a");
+    auto b = acquire("a");
+    a.reset();
+    assertEqual(1, designs.size());
+    b.reset();
+    assertEqual(0, designs.size());
+}
+
+TEST_F(SharedDesignsTests, redesignsAfterRelease) {
+    acquire("a");
+    acquire("a");
+    assertEqual(2, designed);
+}
+
+TEST_F(SharedDesignsTests, concurrentInstancesShareOneDesign) {
+    std::vector<std::shared_ptr<const Design>> acquired(8);
+    std::vector<std::thread> threads;
+    for (auto &design : acquired)
+        threads.emplace_back([&] { design = acquire("a"); });
+    for (auto &thread : threads)
+        thread.join();
+    for (auto &design : acquired)
+        assertTrue(design == acquired.front());
+    assertEqual(1, designed);
+}
+}}
@@ -0,0 +1,129 @@
+#include "assert-utility.h"
+#include <hearing-aid/Fft.h>
+#include <hearing-aid/SpectralCompressor.h>
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace hearing_aid::tests { namespace {
+class SpectralCompressorTests : public ::testing::Test {
+protected:
+    using buffer_type = std::vector<real_type>;
+    SpectralCompressor::Parameters p{};
+
+    // 16-point FFT at 1600 Hz: bins are 100 Hz apart, 8 is Nyquist.
+    SpectralCompressorTests() {
+        p.fitting.sampleRate = 1600;
+        p.fitting.fullScaleLevel = 100;
+        p.fitting.attack = 5;
+        p.fitting.release = 50;
+        p.crossFrequencies = {250, 500};
+        p.fftLength = 16;
+        p.hopSize = 8;
+    }
+
+    void setBand(double kneepointGain, double kneepoint, double ratio) {
+        p.fitting.kneepointGains.push_back(kneepointGain);
+        p.fitting.kneepoints.push_back(kneepoint);
+        p.fitting.compressionRatios.push_back(ratio);
+        p.fitting.broadbandOutputLimitingThresholds.push_back(300);
+    }
+
+    buffer_type processConstant(
+        SpectralCompressor &compressor,
+        real_type x,
+        int frames = 1
+    ) {
+        buffer_type frame(2 * compressor.bins());
+        for (int n = 0; n < frames; ++n) {
+            std::fill(frame.begin(), frame.end(), x);
+            compressor.process(frame);
+        }
+        return frame;
+    }
+};
+
+TEST_F(SpectralCompressorTests, groupsBinsAtCrossFrequencies) {
+    SpectralCompressor compressor{p};
+    assertEqual(9, compressor.bins());
+    assertEqual(3, compressor.bands());
+    assertEqual(std::vector<int>{0, 3, 5, 9}, compressor.bandEdges());
+}
+
+TEST_F(SpectralCompressorTests, appliesEachBandGainToItsBins) {
+    setBand(0, 200, 1);
+    setBand(20, 200, 1);
+    setBand(-20, 200, 1);
+    SpectralCompressor compressor{p};
+    const auto frame = processConstant(compressor, 1);
+    EXPECT_NEAR(1, frame.at(2 * 2 + 1), 1e-5);
+    EXPECT_NEAR(10, frame.at(2 * 3), 1e-4);
+    EXPECT_NEAR(10, frame.at(2 * 4 + 1), 1e-4);
+    EXPECT_NEAR(0.1, frame.at(2 * 8), 1e-5);
+}
+
+TEST_F(SpectralCompressorTests, loudFramesAreCompressed) {
+    setBand(0, 40, 3);
+    setBand(0, 40, 3);
+    setBand(0, 40, 3);
+    SpectralCompressor compressor{p};
+    const auto frame = processConstant(compressor, 16, 200);
+    assertTrue(frame.front() < 16 * 0.5F);
+}
+
+TEST_F(SpectralCompressorTests, quietFramesAreNotCompressed) {
+    setBand(0, 40, 3);
+    setBand(0, 40, 3);
+    setBand(0, 40, 3);
+    SpectralCompressor compressor{p};
+    const auto frame = processConstant(compressor, 1e-4F, 200);
+    EXPECT_NEAR(1e-4, frame.front(), 1e-8);
+}
+
+TEST_F(SpectralCompressorTests, sineReadsItsLevelWhateverTheWindow) {
+    for (auto type : {"rect", "hanning", "hamming", "blackman"}) {
+        p = {};
+        p.fitting.sampleRate = 16000;
+        p.fitting.fullScaleLevel = 100;
+        p.fitting.attack = 5;
+        p.fitting.release = 50;
+        p.crossFrequencies = {1000, 2000};
+        p.fftLength = 512;
+        p.hopSize = 160;
+        // A 320-sample window, zero-padded to the FFT length.
+        p.window = analysisWindow(type, 320);
+        setBand(0, 200, 1);
+        setBand(0, 200, 1);
+        setBand(0, 200, 1);
+        SpectralCompressor compressor{p};
+        // 70 dB SPL at 1500 Hz, in the middle band.
+        const auto amplitude = std::pow(10., (70 - 100) / 20.);
+        const auto pi = std::acos(-1.);
+        Fft fft{p.fftLength};
+        buffer_type frame(p.fftLength);
+        std::vector<spectrum_type> spectrum(fft.bins());
+        for (int n = 0; n < 200; ++n) {
+            std::fill(frame.begin(), frame.end(), 0.F);
+            for (int i = 0; i < 320; ++i)
+                frame.at(i) = static_cast<real_type>(
+                    p.window.at(i) * amplitude * std::sin(
+                        2 * pi * 1500 * (n * p.hopSize + i) / 16000
+                    )
+                );
+            fft.forward(frame, spectrum);
+            compressor.process({
+                reinterpret_cast<real_type *>(spectrum.data()),
+                2 * fft.bins()
+            });
+        }
+        EXPECT_NEAR(70, compressor.levelDecibels(1), 0.2) << type;
+    }
+}
+
+TEST_F(SpectralCompressorTests, ignoresFramesOfWrongSize) {
+    setBand(20, 200, 1);
+    SpectralCompressor compressor{p};
+    buffer_type frame(4, 1);
+    compressor.process(frame);
+    assertEqual(buffer_type(4, 1), frame);
+}
+}}
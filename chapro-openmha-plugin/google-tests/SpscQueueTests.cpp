@@ -0,0 +1,64 @@
+#include "assert-utility.h"
+#include <hearing-aid/SpscQueue.h>
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace hearing_aid::tests { namespace {
+class SpscQueueTests : public ::testing::Test {
+protected:
+    SpscQueue<int> queue{3};
+
+    int pop() {
+        int x{-1};
+        queue.pop(x);
+        return x;
+    }
+};
+
+TEST_F(SpscQueueTests, popsInOrderOfPush) {
+    queue.push(1);
+    queue.push(2);
+    queue.push(3);
+    assertEqual(1, pop());
+    assertEqual(2, pop());
+    assertEqual(3, pop());
+}
+
+TEST_F(SpscQueueTests, pushFailsWhenFull) {
+    assertTrue(queue.push(1));
+    assertTrue(queue.push(2));
+    assertTrue(queue.push(3));
+    assertFalse(queue.push(4));
+}
+
+TEST_F(SpscQueueTests, popFailsWhenEmpty) {
+    int x{};
+    assertTrue(queue.empty());
+    assertFalse(queue.pop(x));
+}
+
+TEST_F(SpscQueueTests, wrapsAround) {
+    for (int i = 0; i < 10; ++i) {
+        queue.push(i);
+        assertEqual(i, pop());
+    }
+}
+
+TEST_F(SpscQueueTests, transfersBetweenThreadsInOrder) {
+    constexpr auto count = 100000;
+    std::thread producer{[&] {
+        for (int i = 0; i < count; ++i)
+            while (!queue.push(i))
+                std::this_thread::yield();
+    }};
+    auto ordered = true;
+    for (int i = 0; i < count; ++i) {
+        int x{};
+        while (!queue.pop(x))
+            std::this_thread::yield();
+        ordered = ordered && x == i;
+    }
+    producer.join();
+    assertTrue(ordered);
+}
+}}
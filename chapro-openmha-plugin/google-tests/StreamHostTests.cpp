@@ -0,0 +1,115 @@
+#include "assert-utility.h"
+#include <hearing-aid/StreamHost.h>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <thread>
+
+namespace hearing_aid::tests { namespace {
+class SignalProcessorStub : public SignalProcessor {
+    std::vector<int> *order;
+    std::mutex *mutex;
+    std::chrono::milliseconds delay;
+    int id;
+public:
+    SignalProcessorStub(
+        std::vector<int> *order,
+        std::mutex *mutex,
+        int id,
+        std::chrono::milliseconds delay = {}
+    ) :
+        order{order},
+        mutex{mutex},
+        delay{delay},
+        id{id} {}
+
+    void process(real_signal_type signal) override {
+        std::this_thread::sleep_for(delay);
+        for (auto &x : signal)
+            x += static_cast<real_type>(id);
+        std::lock_guard<std::mutex> lock{*mutex};
+        order->push_back(id);
+    }
+};
+
+class StreamHostTests : public ::testing::Test {
+protected:
+    using buffer_type = std::vector<real_type>;
+    using milliseconds = std::chrono::milliseconds;
+    std::vector<int> order;
+    std::mutex mutex;
+    StreamHost::Parameters p{{}, 1};
+
+    int add(
+        StreamHost &host,
+        int id,
+        milliseconds deadline,
+        milliseconds delay = {}
+    ) {
+        return host.add(
+            std::make_unique<SignalProcessorStub>(&order, &mutex, id, delay),
+            deadline
+        );
+    }
+};
+
+TEST_F(StreamHostTests, processesEachStreamsOwnFragment) {
+    p.threads = 3;
+    StreamHost host{p};
+    for (int id = 1; id <= 5; ++id)
+        add(host, id, milliseconds{100});
+    std::vector<buffer_type> buffers(5, buffer_type(4, 0));
+    std::vector<real_signal_type> signals(buffers.begin(), buffers.end());
+    host.process(signals);
+    for (int i = 0; i < 5; ++i)
+        assertEqual(buffer_type(4, i + 1.F), buffers.at(i));
+}
+
+TEST_F(StreamHostTests, takesEarliestDeadlineFirst) {
+    StreamHost host{p};
+    add(host, 1, milliseconds{30});
+    add(host, 2, milliseconds{10});
+    add(host, 3, milliseconds{20});
+    std::vector<buffer_type> buffers(3, buffer_type(1));
+    host.process({buffers.begin(), buffers.end()});
+    assertEqual(std::vector<int>{2, 3, 1}, order);
+}
+
+TEST_F(StreamHostTests, returnsStreamIndices) {
+    StreamHost host{p};
+    assertEqual(0, add(host, 1, milliseconds{30}));
+    assertEqual(1, add(host, 2, milliseconds{10}));
+    assertEqual(2, host.streams());
+}
+
+TEST_F(StreamHostTests, countsDeadlineMisses) {
+    StreamHost host{p};
+    add(host, 1, milliseconds{1}, milliseconds{5});
+    add(host, 2, milliseconds{10000});
+    std::vector<buffer_type> buffers(2, buffer_type(1));
+    host.process({buffers.begin(), buffers.end()});
+    host.process({buffers.begin(), buffers.end()});
+    assertEqual(2, host.statistics(0).fragments);
+    assertEqual(2, host.statistics(0).deadlineMisses);
+    assertEqual(0, host.statistics(1).deadlineMisses);
+    assertTrue(host.statistics(0).worstCompletion >= milliseconds{5});
+}
+
+TEST_F(StreamHostTests, ignoresWrongNumberOfFragments) {
+    StreamHost host{p};
+    add(host, 1, milliseconds{30});
+    host.process({});
+    assertEqual(0, host.statistics(0).fragments);
+}
+
+TEST_F(StreamHostTests, processesEachStreamOnceWithManyThreads) {
+    p.threads = 4;
+    StreamHost host{p};
+    for (int id = 0; id < 16; ++id)
+        add(host, id, milliseconds{id});
+    std::vector<buffer_type> buffers(16, buffer_type(1));
+    for (int n = 0; n < 50; ++n)
+        host.process({buffers.begin(), buffers.end()});
+    for (int id = 0; id < 16; ++id)
+        assertEqual(50, host.statistics(id).fragments);
+}
+}}
@@ -0,0 +1,107 @@
+#include "assert-utility.h"
+#include <hearing-aid/DenormalProtection.h>
+#include <hearing-aid/WorkStealingPool.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <ctime>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace hearing_aid::tests { namespace {
+class WorkStealingPoolTests : public ::testing::Test {
+protected:
+    std::vector<int> runCounts(WorkStealingPool &pool, int tasks) {
+        std::vector<std::atomic<int>> counts(tasks);
+        pool.run(tasks, [&](int task) { ++counts[task]; });
+        std::vector<int> result;
+        for (auto &count : counts)
+            result.push_back(count.load());
+        return result;
+    }
+};
+
+TEST_F(WorkStealingPoolTests, runsEachTaskOnce) {
+    WorkStealingPool pool{4};
+    assertEqual(std::vector<int>(13, 1), runCounts(pool, 13));
+}
+
+TEST_F(WorkStealingPoolTests, runsEachTaskOnceAcrossRepeatedBatches) {
+    WorkStealingPool pool{3};
+    for (int n = 0; n < 200; ++n)
+        assertEqual(std::vector<int>(1 + n % 7, 1), runCounts(pool, 1 + n % 7));
+}
+
+TEST_F(WorkStealingPoolTests, runsFewerTasksThanThreads) {
+    WorkStealingPool pool{4};
+    assertEqual(std::vector<int>(2, 1), runCounts(pool, 2));
+}
+
+TEST_F(WorkStealingPoolTests, runsNothingForZeroTasks) {
+    WorkStealingPool pool{2};
+    assertEqual(std::vector<int>{}, runCounts(pool, 0));
+}
+
+TEST_F(WorkStealingPoolTests, singleThreadRunsOnCallingThread) {
+    WorkStealingPool pool{1};
+    std::set<std::thread::id> threads;
+    pool.run(5, [&](int) { threads.insert(std::this_thread::get_id()); });
+    assertEqual(
+        std::set<std::thread::id>{std::this_thread::get_id()},
+        threads
+    );
+}
+
+TEST_F(WorkStealingPoolTests, idleWorkersStealFromBusyOnes) {
+    WorkStealingPool pool{2};
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    pool.run(8, [&](int task) {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            threads.insert(std::this_thread::get_id());
+        }
+        if (task == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    });
+    assertEqual(std::set<std::thread::id>::size_type{2}, threads.size());
+}
+
+TEST_F(WorkStealingPoolTests, workersFlushDenormalsWhenAsked) {
+    if (!FlushDenormalsToZero::supported())
+        GTEST_SKIP() << "no hardware flush-to-zero";
+    WorkStealingPool pool{2, {}, true};
+    std::mutex mutex;
+    std::vector<float> workerProducts;
+    const auto caller = std::this_thread::get_id();
+    pool.run(8, [&](int) {
+        volatile float a = 1e-30F;
+        volatile float b = 1e-10F;
+        const float product = a * b;
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        if (std::this_thread::get_id() != caller) {
+            std::lock_guard<std::mutex> lock{mutex};
+            workerProducts.push_back(product);
+        }
+    });
+    assertFalse(workerProducts.empty());
+    for (auto product : workerProducts)
+        assertEqual(0.F, product);
+}
+
+TEST_F(WorkStealingPoolTests, idleWorkersPark) {
+    WorkStealingPool pool{4};
+    runCounts(pool, 8);
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    const auto start = std::clock();
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    const auto used = std::clock() - start;
+    assertTrue(used < CLOCKS_PER_SEC / 100);
+    assertEqual(std::vector<int>(8, 1), runCounts(pool, 8));
+}
+
+TEST_F(WorkStealingPoolTests, reportsThreads) {
+    WorkStealingPool pool{3};
+    assertEqual(3, pool.threads());
+}
+}}
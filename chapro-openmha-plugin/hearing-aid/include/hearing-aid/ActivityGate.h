@@ -0,0 +1,89 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_ACTIVITYGATE_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_ACTIVITYGATE_H_
+
+#include "AfcHearingAid.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace hearing_aid {
+// Measures the power of each input fragment and, once the input has
+// stayed below a silence level for a hold time, runs the decorated
+// channel compression only every update interval. Fragments in between
+// reuse the band gains measured on the last compressed fragment, so
+// envelopes keep tracking the floor. Feedback cancellation and
+// broadband compression always run. The first active fragment after
+// silence is compressed and crossfaded from the held gains.
+//
+// The decision is made in feedbackCancelInput and published atomically,
+// so channel compression may run on other threads; make() returns a
+// BandCompressor when the decorated processor is one, so band-parallel
+// compression still applies. There is one decision at a time, so the
+// channel compression of a fragment must finish before the next
+// fragment's feedbackCancelInput. PipelinedHearingAid overlaps them, so
+// it must not run an ActivityGate.
+class ActivityGate : public SuperSignalProcessor {
+public:
+    struct Parameters {
+        double silenceLevel;
+        double fullScaleLevel;
+        int holdFragments;
+        int updateInterval;
+    };
+    static std::shared_ptr<ActivityGate> make(
+        std::shared_ptr<SuperSignalProcessor>,
+        const Parameters &
+    );
+    ActivityGate(std::shared_ptr<SuperSignalProcessor>, const Parameters &);
+    void feedbackCancelInput(real_signal_type, real_signal_type, int) override;
+    void compressInput(real_signal_type, real_signal_type, int) override;
+    void compressChannel(complex_signal_type, complex_signal_type, int) override;
+    void compressOutput(real_signal_type, real_signal_type, int) override;
+    void feedbackCancelOutput(real_signal_type, int) override;
+    int chunkSize() override;
+    int channels() override;
+    bool reduced() const { return reduced_; }
+protected:
+    // Gates bands first to first + n; compress runs the decorated
+    // compression over them.
+    template<typename F>
+    void gate(
+        complex_signal_type,
+        complex_signal_type,
+        int chunkSize,
+        int first,
+        int n,
+        F &&compress
+    );
+    std::shared_ptr<SuperSignalProcessor> processor;
+private:
+    enum class Mode { compress, resume, hold };
+
+    void remeasure(
+        complex_signal_type,
+        int chunkSize,
+        int first,
+        int n,
+        bool resuming
+    );
+    void applyHeldGains(
+        complex_signal_type,
+        complex_signal_type,
+        int chunkSize,
+        int first,
+        int n
+    );
+
+    std::vector<real_type> gains;
+    std::vector<real_type> held;
+    std::atomic<Mode> mode{Mode::compress};
+    real_type threshold;
+    int holdFragments;
+    int updateInterval;
+    int quietFragments{};
+    int skipped{};
+    bool reduced_{};
+};
+}
+
+#endif
@@ -56,16 +56,51 @@ public:
     virtual int channels() = 0;
 };
 
-class AfcHearingAid {
+// Implemented by processors whose channel compression can be applied to
+// a contiguous range of bands independently of the others.
+class BandCompressor {
+public:
+    virtual ~BandCompressor() = default;
+    virtual void compressChannels(
+        complex_signal_type,
+        complex_signal_type,
+        int chunkSize,
+        int firstChannel,
+        int channelCount
+    ) = 0;
+};
+
+class SignalProcessor {
+public:
+    virtual ~SignalProcessor() = default;
+    virtual void process(real_signal_type signal) = 0;
+};
+
+class AfcHearingAid : public SignalProcessor {
     std::vector<complex_type> buffer;
+    std::vector<complex_type> compressed;
+    std::vector<real_type> levels;
     std::shared_ptr<SuperSignalProcessor> processor;
     std::shared_ptr<Filter> filter;
+    real_type fullScaleLevel{};
+    bool measureLevels{};
 public:
     AfcHearingAid(
         std::shared_ptr<SuperSignalProcessor>,
         std::shared_ptr<Filter>
     );
-    void process(real_signal_type signal);
+    void process(real_signal_type signal) override;
+
+    // Band signals of the filterbank analysis, before channel
+    // compression, band k at offset 2 * chunkSize * k. Compression
+    // writes to a separate buffer, so the memory keeps the analysis for
+    // the whole fragment and is fixed for the hearing aid's lifetime;
+    // others can read it in place.
+    complex_signal_type bands();
+    // Level (dB SPL) of each band before compression, updated every
+    // fragment once measuring is enabled. Fixed memory, like bands().
+    real_signal_type bandLevels();
+    void measureBandLevels(double fullScaleLevel);
 };
 }
 
@@ -0,0 +1,57 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_BANDPARALLELCOMPRESSOR_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_BANDPARALLELCOMPRESSOR_H_
+
+#include "AfcHearingAid.h"
+#include "WorkStealingPool.h"
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace hearing_aid {
+// Splits channel compression band by band across a work-stealing pool.
+// Falls back to the decorated processor's own compressChannel when it is
+// not a BandCompressor or when a fragment holds fewer band samples
+// (chunk size times channels) than the threshold.
+class BandParallelCompressor :
+    public SuperSignalProcessor,
+    public BandCompressor
+{
+public:
+    struct Parameters {
+        std::vector<int> cores;
+        int threads;
+        int threshold;
+        // Run the pool's workers in flush-to-zero mode.
+        bool flushDenormals;
+        // How long idle workers spin before parking; one fragment period
+        // keeps them awake between fragments.
+        std::chrono::nanoseconds spin{Parking::defaultSpin};
+    };
+    BandParallelCompressor(
+        std::shared_ptr<SuperSignalProcessor>,
+        const Parameters &
+    );
+    void feedbackCancelInput(real_signal_type, real_signal_type, int) override;
+    void compressInput(real_signal_type, real_signal_type, int) override;
+    void compressChannel(complex_signal_type, complex_signal_type, int) override;
+    void compressChannels(
+        complex_signal_type,
+        complex_signal_type,
+        int chunkSize,
+        int firstChannel,
+        int channelCount
+    ) override;
+    void compressOutput(real_signal_type, real_signal_type, int) override;
+    void feedbackCancelOutput(real_signal_type, int) override;
+    int chunkSize() override;
+    int channels() override;
+    bool parallel(int chunkSize);
+private:
+    std::shared_ptr<SuperSignalProcessor> processor;
+    std::shared_ptr<BandCompressor> bandCompressor;
+    WorkStealingPool pool;
+    int threshold;
+};
+}
+
+#endif
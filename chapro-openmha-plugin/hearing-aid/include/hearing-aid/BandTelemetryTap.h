@@ -0,0 +1,84 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_BANDTELEMETRYTAP_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_BANDTELEMETRYTAP_H_
+
+#include "AfcHearingAid.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace hearing_aid {
+// Measures each band's input level and the gain the decorated channel
+// compression applied to it, once every interval fragments, and
+// publishes them through one seqlock per band: the compressing thread
+// never waits, and a reader retries only while that band is being
+// written. Bands may be compressed by different threads, as by
+// BandParallelCompressor and PipelinedHearingAid; make() returns a
+// BandCompressor when the decorated processor is one.
+class BandTelemetryTap : public SuperSignalProcessor {
+public:
+    struct Parameters {
+        double fullScaleLevel;
+        int interval;
+    };
+
+    struct Band {
+        // dB SPL, before compression.
+        real_type level;
+        // dB; the previous value while the input is silent.
+        real_type gain;
+        std::uint32_t updates;
+    };
+
+    static std::shared_ptr<BandTelemetryTap> make(
+        std::shared_ptr<SuperSignalProcessor>,
+        const Parameters &
+    );
+    BandTelemetryTap(
+        std::shared_ptr<SuperSignalProcessor>,
+        const Parameters &
+    );
+    void feedbackCancelInput(real_signal_type, real_signal_type, int) override;
+    void compressInput(real_signal_type, real_signal_type, int) override;
+    void compressChannel(complex_signal_type, complex_signal_type, int) override;
+    void compressOutput(real_signal_type, real_signal_type, int) override;
+    void feedbackCancelOutput(real_signal_type, int) override;
+    int chunkSize() override;
+    int channels() override;
+    // From any thread, without blocking the compressing threads.
+    std::vector<Band> read() const;
+protected:
+    void beforeCompressing(
+        const complex_type *,
+        int chunkSize,
+        int first,
+        int n
+    );
+    void afterCompressing(
+        const complex_type *,
+        int chunkSize,
+        int first,
+        int n
+    );
+    std::shared_ptr<SuperSignalProcessor> processor;
+private:
+    // Everything but the seqlock is used only by the band's compressing
+    // thread.
+    struct alignas(64) Slot {
+        std::atomic<std::uint32_t> sequence{0};
+        std::atomic<real_type> level{0};
+        std::atomic<real_type> gain{0};
+        real_type inputPower{};
+        int countdown{};
+        bool measuring{};
+    };
+
+    void publish(Slot &, real_type level, real_type gain);
+
+    std::vector<Slot> slots;
+    real_type fullScaleLevel;
+    int interval;
+};
+}
+
+#endif
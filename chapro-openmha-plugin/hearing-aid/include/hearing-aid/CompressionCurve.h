@@ -0,0 +1,19 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_COMPRESSIONCURVE_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_COMPRESSIONCURVE_H_
+
+namespace hearing_aid {
+struct CompressionCurve {
+    double kneepointGain;
+    double kneepoint;
+    double compressionRatio;
+    double broadbandOutputLimitingThreshold;
+};
+
+// Wide dynamic range compression gain (dB) for an input level (dB SPL),
+// following the CHAPRO WDRC curve: linear gain below the kneepoint,
+// compression above it, and limiting above the broadband output
+// limiting threshold.
+double gainDecibels(const CompressionCurve &, double levelDecibels);
+}
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_CONTROLRATECOMPRESSOR_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_CONTROLRATECOMPRESSOR_H_
+
+#include "AfcHearingAid.h"
+#include "CompressionCurve.h"
+#include <memory>
+#include <vector>
+
+namespace hearing_aid {
+// Tracks a compressor gain that is recomputed once per control interval
+// and linearly interpolated in between. An interval of one sample
+// updates the gain every sample.
+class GainTrajectory {
+    CompressionCurve curve;
+    double attackCoefficient;
+    double releaseCoefficient;
+    double fullScaleLevel;
+    real_type envelope{};
+    real_type peak{};
+    real_type gain_;
+    real_type step{};
+    int interval;
+    int remaining;
+public:
+    struct Parameters {
+        CompressionCurve curve;
+        double attack;
+        double release;
+        double sampleRate;
+        double fullScaleLevel;
+        int controlInterval;
+    };
+    explicit GainTrajectory(const Parameters &);
+
+    real_type next(real_type power) {
+        if (power > peak)
+            peak = power;
+        gain_ += step;
+        if (--remaining == 0)
+            update();
+        return gain_;
+    }
+
+    // Equivalent to next() over count samples of a band (interleaved
+    // complex) or of a broadband signal, applying the gains with the
+    // selected kernels one control interval at a time. in may equal out.
+    void applyToBand(const complex_type *in, complex_type *out, int count);
+    void applyToSignal(const real_type *in, real_type *out, int count);
+
+    real_type gain() const { return gain_; }
+    real_type levelDecibels() const;
+private:
+    template<typename Ramp, typename Sample>
+    void apply(Ramp, const Sample *in, Sample *out, int count, int stride);
+    void update();
+};
+
+// Replaces the input, channel and output compression of a
+// SuperSignalProcessor with control-rate compressors. Feedback
+// cancellation is forwarded to the decorated processor.
+class ControlRateCompressor :
+    public SuperSignalProcessor,
+    public BandCompressor
+{
+    std::vector<GainTrajectory> channelGains;
+    GainTrajectory inputGain;
+    GainTrajectory outputGain;
+    std::shared_ptr<SuperSignalProcessor> processor;
+public:
+    struct Parameters {
+        std::vector<double> compressionRatios;
+        std::vector<double> kneepoints;
+        std::vector<double> kneepointGains;
+        std::vector<double> broadbandOutputLimitingThresholds;
+        CompressionCurve broadband;
+        double attack;
+        double release;
+        double broadbandAttack;
+        double broadbandRelease;
+        double sampleRate;
+        double fullScaleLevel;
+        int controlInterval;
+    };
+    ControlRateCompressor(
+        std::shared_ptr<SuperSignalProcessor>,
+        const Parameters &
+    );
+    void feedbackCancelInput(real_signal_type, real_signal_type, int) override;
+    void compressInput(real_signal_type, real_signal_type, int) override;
+    void compressChannel(complex_signal_type, complex_signal_type, int) override;
+    void compressChannels(
+        complex_signal_type,
+        complex_signal_type,
+        int chunkSize,
+        int firstChannel,
+        int channelCount
+    ) override;
+    void compressOutput(real_signal_type, real_signal_type, int) override;
+    void feedbackCancelOutput(real_signal_type, int) override;
+    int chunkSize() override;
+    int channels() override;
+};
+
+// Trajectory parameters for one channel's fitting; missing entries are
+// zero.
+GainTrajectory::Parameters channelTrajectory(
+    const ControlRateCompressor::Parameters &,
+    int channel
+);
+}
+
+#endif
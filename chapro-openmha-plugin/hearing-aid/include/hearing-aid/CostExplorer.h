@@ -0,0 +1,66 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_COSTEXPLORER_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_COSTEXPLORER_H_
+
+#include "LatencyHistogram.h"
+#include "ParameterSweep.h"
+#include <string>
+#include <vector>
+
+namespace hearing_aid {
+// Searches for the fittings that cost the most per fragment on this
+// machine. The load of a fitting is its 99th-percentile fragment time
+// over the fragment duration. Starting from a fitting, each dimension
+// of the space in turn is set to the candidate with the highest load
+// while the others are held, until a round changes nothing. Fittings
+// are timed one at a time on the calling thread, on white noise,
+// without the first tenth of their fragments; those the backend cannot
+// build are skipped.
+class CostExplorer {
+public:
+    // Empty dimensions are held at the starting fitting's value.
+    struct Space {
+        std::vector<int> bands;
+        std::vector<int> windowSizes;
+        std::vector<int> adaptiveFeedbackFilterLengths;
+        std::vector<int> signalWhiteningFilterLengths;
+        std::vector<int> persistentFeedbackFilterLengths;
+        std::vector<int> chunkSizes;
+        std::vector<std::string> filterTypes;
+    };
+
+    struct Parameters {
+        // Of audio per fitting.
+        double seconds;
+        // Noise level in dB SPL, for the fitting's full-scale level.
+        double level;
+        int rounds;
+    };
+
+    struct Result {
+        HearingAidBuilder::Parameters fitting;
+        // Nanoseconds per fragment.
+        LatencyHistogram cost;
+        double load;
+    };
+
+    CostExplorer(SweepBackend *, const Parameters &);
+    // Every fitting evaluated, highest load first.
+    std::vector<Result> explore(
+        const HearingAidBuilder::Parameters &,
+        const Space &
+    );
+    Result evaluate(const HearingAidBuilder::Parameters &);
+    // The fitting with bands logarithmically spaced cross frequencies
+    // between 250 Hz and a quarter of the sample rate; per-band lists
+    // repeat their first entry.
+    static HearingAidBuilder::Parameters withBands(
+        HearingAidBuilder::Parameters,
+        int bands
+    );
+private:
+    Parameters p;
+    SweepBackend *backend;
+};
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_DENORMALPROTECTION_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_DENORMALPROTECTION_H_
+
+#include "AfcHearingAid.h"
+#include <cstdint>
+#include <memory>
+
+namespace hearing_aid {
+// Sets the FPU to flush subnormal results and operands to zero (MXCSR
+// FTZ/DAZ on x86, FPCR/FPSCR FZ on ARM) for its lifetime and restores the
+// previous mode afterwards.
+class FlushDenormalsToZero {
+public:
+    FlushDenormalsToZero();
+    ~FlushDenormalsToZero();
+    FlushDenormalsToZero(const FlushDenormalsToZero &) = delete;
+    FlushDenormalsToZero &operator=(const FlushDenormalsToZero &) = delete;
+    static bool supported();
+private:
+    std::uintptr_t previous{};
+};
+
+// Keeps subnormal floats out of the wrapped hearing aid's state. Where
+// the hardware can flush them, process() runs in that mode; otherwise
+// inaudible dither (about -300 dB full scale) is added to the input so
+// recursive filter and envelope state never decays into the subnormal
+// range.
+class DenormalProtectedHearingAid : public SignalProcessor {
+public:
+    enum class Mode { flush, dither };
+    DenormalProtectedHearingAid(std::unique_ptr<SignalProcessor>, Mode);
+    explicit DenormalProtectedHearingAid(std::unique_ptr<SignalProcessor>);
+    void process(real_signal_type signal) override;
+    Mode mode() const;
+private:
+    std::unique_ptr<SignalProcessor> processor;
+    std::uint32_t state{1};
+    Mode mode_;
+};
+}
+
+#endif
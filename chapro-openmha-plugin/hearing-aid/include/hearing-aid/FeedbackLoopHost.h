@@ -0,0 +1,91 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_FEEDBACKLOOPHOST_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_FEEDBACKLOOPHOST_H_
+
+#include "LatencyHistogram.h"
+#include "ParameterSweep.h"
+#include <vector>
+
+namespace hearing_aid {
+// Closes a simulated acoustic loop around hearing aids built by a
+// SweepBackend so feedback cancellation can be evaluated offline. The
+// output of a fragment is played during the next fragment (as with a
+// double-buffered sound card), then delayed by the hardware delay and
+// filtered by the feedback path before it is added to the microphone
+// signal. The reference for convergence and stability is the same
+// fitting with feedback management off and no acoustic feedback.
+class FeedbackLoopHost {
+public:
+    struct Path {
+        std::vector<real_type> impulseResponse;
+        // Optional path the loop moves to, for example when a phone is
+        // brought to the ear. Empty keeps the path fixed.
+        std::vector<real_type> changedImpulseResponse;
+        int hardwareDelay;
+        // Fragment at which the change starts and the fragments it is
+        // crossfaded over; 0 switches at once.
+        int changeFragment;
+        int changeFragments;
+    };
+
+    struct Parameters {
+        Path path;
+        // Converged once the output differs from the reference by less
+        // than this many dB (relative to the reference), measured over
+        // windows of this many fragments.
+        double convergenceThreshold;
+        int convergenceWindow;
+        // Unstable when, over the last quarter of the input, the output
+        // exceeds the reference by this many dB or is not finite.
+        double howlMargin;
+        // Extra forward gain in dB searched for the maximum stable gain,
+        // bisected down to the resolution.
+        double minimumGain;
+        double maximumGain;
+        double gainResolution;
+    };
+
+    // Times are in fragments from the start of the input; -1 when the
+    // loop did not converge. Reconvergence is counted from the change
+    // of path and is -1 too when the path is fixed. Cost is the time
+    // spent in each fragment of the run at 0 dB extra gain, in
+    // nanoseconds.
+    struct Result {
+        LatencyHistogram cost;
+        double maximumStableGain;
+        int convergence;
+        int reconvergence;
+        bool stable;
+    };
+
+    FeedbackLoopHost(SweepBackend *, const Parameters &);
+    Result evaluate(
+        const HearingAidBuilder::Parameters &,
+        const std::vector<real_type> &input
+    );
+    // Processes the input in a closed loop with the given extra forward
+    // gain in dB, returning the hearing aid output before that gain.
+    std::vector<real_type> run(
+        const HearingAidBuilder::Parameters &,
+        const std::vector<real_type> &input,
+        double gain,
+        LatencyHistogram *cost = nullptr
+    );
+private:
+    Parameters p;
+    SweepBackend *backend;
+
+    bool stable(
+        const std::vector<real_type> &closed,
+        const std::vector<real_type> &open
+    ) const;
+    int converged(
+        const std::vector<real_type> &closed,
+        const std::vector<real_type> &open,
+        int chunkSize,
+        int first,
+        int last
+    ) const;
+};
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_FEEDBACKQUALITYTAP_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_FEEDBACKQUALITYTAP_H_
+
+#include "AfcHearingAid.h"
+#include "SpscQueue.h"
+#include <atomic>
+#include <memory>
+
+namespace hearing_aid {
+// AFC state after one fragment. Values the backend cannot provide are
+// NaN.
+struct FeedbackQuality {
+    real_type qualityMetric;
+    // Estimated against the simulated feedback path, in dB.
+    real_type misalignment;
+    int fragment;
+};
+
+class FeedbackMonitor {
+public:
+    virtual ~FeedbackMonitor() = default;
+    // Called from the audio thread once per fragment; must not block.
+    virtual FeedbackQuality feedbackQuality() = 0;
+};
+
+// Publishes the AFC quality after every fragment through a lock-free
+// ring so a non-realtime thread can monitor convergence without
+// stalling the audio thread. When the reader falls behind, new entries
+// are dropped and counted.
+class FeedbackQualityTap : public SuperSignalProcessor {
+    SpscQueue<FeedbackQuality> ring;
+    std::shared_ptr<SuperSignalProcessor> processor;
+    std::shared_ptr<FeedbackMonitor> monitor;
+    std::atomic<int> dropped_{0};
+    int fragment{};
+public:
+    FeedbackQualityTap(
+        std::shared_ptr<SuperSignalProcessor>,
+        std::shared_ptr<FeedbackMonitor>,
+        int capacity
+    );
+    void feedbackCancelInput(real_signal_type, real_signal_type, int) override;
+    void compressInput(real_signal_type, real_signal_type, int) override;
+    void compressChannel(complex_signal_type, complex_signal_type, int) override;
+    void compressOutput(real_signal_type, real_signal_type, int) override;
+    void feedbackCancelOutput(real_signal_type, int) override;
+    int chunkSize() override;
+    int channels() override;
+
+    // Passes every published entry to f in order; call from one reader
+    // thread only. Returns the number of entries.
+    template<typename F>
+    int drain(F &&f) {
+        FeedbackQuality quality{};
+        int entries = 0;
+        while (ring.pop(quality)) {
+            f(quality);
+            ++entries;
+        }
+        return entries;
+    }
+
+    int dropped() const;
+};
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_FFT_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_FFT_H_
+
+#include "AfcHearingAid.h"
+#include <complex>
+#include <vector>
+
+namespace hearing_aid {
+using spectrum_type = std::complex<real_type>;
+using spectrum_signal_type = gsl::span<spectrum_type>;
+
+// Complex product without the NaN/infinity recovery std::complex's
+// operator* performs, which keeps inner loops vectorizable.
+inline spectrum_type multiply(spectrum_type a, spectrum_type b) {
+    return {
+        a.real() * b.real() - a.imag() * b.imag(),
+        a.real() * b.imag() + a.imag() * b.real()
+    };
+}
+
+inline spectrum_type multiplyConjugate(spectrum_type a, spectrum_type b) {
+    return {
+        a.real() * b.real() + a.imag() * b.imag(),
+        a.real() * b.imag() - a.imag() * b.real()
+    };
+}
+
+// Real-input FFT of a power-of-two size N, computed with a complex FFT of
+// size N/2. The spectrum holds the N/2 + 1 non-negative frequency bins.
+// The inverse is scaled by 1/N so that inverse(forward(x)) == x.
+class Fft {
+    std::vector<spectrum_type> twiddles;
+    std::vector<spectrum_type> halfTwiddles;
+    std::vector<spectrum_type> work;
+    std::vector<int> bitReversed;
+    int size_;
+public:
+    explicit Fft(int size);
+    void forward(real_signal_type, spectrum_signal_type);
+    void inverse(spectrum_signal_type, real_signal_type);
+    int size() const { return size_; }
+    int bins() const { return size_ / 2 + 1; }
+private:
+    void transform(bool inverse_);
+};
+
+bool isPowerOfTwo(int);
+}
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_FITTINGCONFIGURATION_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_FITTINGCONFIGURATION_H_
+
+#include "HearingAidBuilder.h"
+#include <istream>
+#include <string>
+
+namespace hearing_aid {
+// Reads the fitting of an openMHA configuration (for example chapro.cfg)
+// from its "key = value" lines. A plugin variable such as mha.chapro.cr
+// is matched by its last component; missing variables take the plugin's
+// defaults, and srate and fragsize give the sample rate and chunk size.
+HearingAidBuilder::Parameters readFitting(std::istream &);
+// The same for the configuration file at the path; throws
+// std::runtime_error when it cannot be read.
+HearingAidBuilder::Parameters readFitting(const std::string &path);
+}
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_FLIGHTRECORDER_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_FLIGHTRECORDER_H_
+
+#include "AfcHearingAid.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hearing_aid {
+// The stages of a fragment through AfcHearingAid, in order.
+enum class Stage {
+    feedbackCancelInput,
+    compressInput,
+    filterbankAnalyze,
+    compressChannel,
+    filterbankSynthesize,
+    compressOutput,
+    feedbackCancelOutput
+};
+
+constexpr auto stageCount = 7;
+
+const char *name(Stage);
+
+// Passed to AfcHearingAid as both its processor and its filter, and
+// accumulates the time spent in each stage until take() is called. For
+// use from one thread.
+class StageTimer : public SuperSignalProcessor, public Filter {
+public:
+    using Durations = std::array<std::int64_t, stageCount>;
+
+    StageTimer(
+        std::shared_ptr<SuperSignalProcessor>,
+        std::shared_ptr<Filter>
+    );
+    void feedbackCancelInput(real_signal_type, real_signal_type, int) override;
+    void compressInput(real_signal_type, real_signal_type, int) override;
+    void filterbankAnalyze(real_signal_type, complex_signal_type, int) override;
+    void compressChannel(complex_signal_type, complex_signal_type, int) override;
+    void filterbankSynthesize(
+        complex_signal_type,
+        real_signal_type,
+        int
+    ) override;
+    void compressOutput(real_signal_type, real_signal_type, int) override;
+    void feedbackCancelOutput(real_signal_type, int) override;
+    int chunkSize() override;
+    int channels() override;
+    // Nanoseconds per stage since the last call.
+    Durations take();
+private:
+    template<typename F>
+    void time(Stage, F &&);
+
+    Durations elapsed{};
+    std::shared_ptr<SuperSignalProcessor> processor;
+    std::shared_ptr<Filter> filter;
+};
+
+// Keeps the last seconds of input and output fragments, with the time
+// each took and, given a StageTimer, its stage timings, in rings
+// allocated at construction. A fragment whose processing exceeds the
+// deadline, or whose input or output contains NaN, infinity or a sample
+// at or above the clipping level, triggers a dump: a background thread
+// writes the history up to that fragment to <path><n>.wav (input and
+// output as a two-channel float WAV) and <path><n>.csv (timings and
+// events per fragment). The audio thread only copies into the rings and
+// sets a flag. Events while a dump is pending, within one history of
+// the last trigger, or after maxDumps dumps are counted as suppressed
+// but do not trigger another, so sustained clipping cannot fill the
+// disk.
+class FlightRecorder : public SignalProcessor {
+public:
+    struct Parameters {
+        std::string path;
+        double seconds;
+        double sampleRate;
+        // Fraction of the fragment duration.
+        double deadline;
+        real_type clippingLevel;
+        int chunkSize;
+        int maxDumps;
+    };
+
+    enum Event : unsigned {
+        overrun = 1,
+        notFinite = 2,
+        clipping = 4
+    };
+
+    FlightRecorder(
+        std::unique_ptr<SignalProcessor>,
+        std::shared_ptr<StageTimer>,
+        const Parameters &
+    );
+    ~FlightRecorder() override;
+    FlightRecorder(const FlightRecorder &) = delete;
+    FlightRecorder &operator=(const FlightRecorder &) = delete;
+    void process(real_signal_type signal) override;
+    // Fragments kept in a dump.
+    int historyFragments() const;
+    int dumps() const;
+    int events() const;
+    // Events that did not trigger a dump.
+    int suppressed() const;
+    // The last file written without its extension; empty before the
+    // first dump.
+    std::string lastDump() const;
+private:
+    struct Fragment {
+        StageTimer::Durations stages;
+        std::int64_t index;
+        std::int64_t start;
+        std::int64_t elapsed;
+        unsigned events;
+    };
+
+    void dumpWhenTriggered();
+    void dump(std::int64_t last);
+
+    Parameters p;
+    int history;
+    int capacity;
+    std::vector<real_type> inputs;
+    std::vector<real_type> outputs;
+    std::vector<Fragment> fragments;
+    std::unique_ptr<SignalProcessor> processor;
+    std::shared_ptr<StageTimer> stageTimer;
+    std::chrono::steady_clock::time_point origin;
+    std::int64_t deadline;
+    // Used only by the audio thread.
+    std::int64_t holdoffEnd{0};
+    int triggers{0};
+    std::atomic<std::int64_t> written{0};
+    std::atomic<std::int64_t> trigger{-1};
+    std::atomic<int> dumps_{0};
+    std::atomic<int> events_{0};
+    std::atomic<int> suppressed_{0};
+    std::atomic<bool> stopping{false};
+    mutable std::mutex lastDumpMutex;
+    std::string lastDump_;
+    std::thread dumper;
+};
+}
+
+#endif
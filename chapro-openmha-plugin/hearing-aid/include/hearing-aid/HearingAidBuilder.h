@@ -1,10 +1,15 @@
 #ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_HEARINGAIDBUILDER_H_
 #define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_HEARINGAIDBUILDER_H_
 
+#include "ActivityGate.h"
 #include "AfcHearingAid.h"
+#include "ControlRateCompressor.h"
+#include "MinimumPhaseFilterbank.h"
+#include "PartitionedBlockFeedbackCanceller.h"
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
-#include <memory>
 
 namespace hearing_aid {
 class HearingAidInitializer {
@@ -30,11 +35,14 @@ public:
         double filterEstimationForgettingFactor;
         double filterEstimationPowerThreshold;
         double filterEstimationStepSize;
+        double silenceLevel;
+        double silenceHold;
         int adaptiveFilterLength;
         int signalWhiteningFilterLength;
         int persistentFeedbackFilterLength;
         int hardwareLatency;
         int saveQualityMetric;
+        int qualityMetricLength;
     };
     virtual void initializeFeedbackManagement(const FeedbackManagement &) = 0;
     struct AutomaticGainControl {
@@ -52,11 +60,19 @@ public:
     virtual void initializeAutomaticGainControl(
         const AutomaticGainControl &
     ) = 0;
+    // Free the state of one initialized component and leave the others'
+    // untouched. A backend cannot always initialize a component again
+    // without leaking the state it holds, so the builder releases a
+    // component before reinitializing it.
+    virtual void releaseFilter() = 0;
+    virtual void releaseFeedbackManagement() = 0;
+    virtual void releaseAutomaticGainControl() = 0;
 };
 
 enum class FilterType {
     fir,
-    iir
+    iir,
+    minimumPhaseFir
 };
 
 constexpr const char *name(FilterType t) {
@@ -65,6 +81,8 @@ constexpr const char *name(FilterType t) {
             return "FIR";
         case FilterType::iir:
             return "IIR";
+        case FilterType::minimumPhaseFir:
+            return "FIR-MP";
         default:
             return "";
     }
@@ -86,7 +104,26 @@ constexpr const char *name(Feedback t) {
     }
 }
 
+enum class FeedbackEngine {
+    timeDomain,
+    frequencyDomain
+};
+
+constexpr const char *name(FeedbackEngine t) {
+    switch (t) {
+        case FeedbackEngine::timeDomain:
+            return "time";
+        case FeedbackEngine::frequencyDomain:
+            return "frequency";
+        default:
+            return "";
+    }
+}
+
 class HearingAidBuilder {
+    ControlRateCompressor::Parameters compressor{};
+    PartitionedBlockFeedbackCanceller::Parameters feedbackCanceller{};
+    ActivityGate::Parameters activityGate{};
     std::shared_ptr<Filter> filter_;
     HearingAidInitializer *initializer;
     FilterFactory *filterFactory;
@@ -106,6 +143,7 @@ public:
         std::vector<double> broadbandOutputLimitingThresholds;
         std::string filterType;
         std::string feedback;
+        std::string feedbackEngine;
         double attack;
         double release;
         double sampleRate;
@@ -114,23 +152,45 @@ public:
         double filterEstimationForgettingFactor;
         double filterEstimationPowerThreshold;
         double filterEstimationStepSize;
+        double silenceLevel;
+        double silenceHold;
         int adaptiveFeedbackFilterLength;
         int signalWhiteningFilterLength;
         int persistentFeedbackFilterLength;
         int hardwareLatency;
         int saveQualityMetric;
+        int qualityMetricLength;
         int windowSize;
         int chunkSize;
+        int controlInterval;
+        int silenceUpdateInterval;
     };
 
+    // Initializes each backend component (filter, feedback management,
+    // AGC) whose inputs differ from those of the previous build, releasing
+    // its previous state first; the other components' state is left
+    // untouched. Call invalidate() after releasing the initialized state
+    // elsewhere so the next build initializes everything without
+    // releasing it again.
     void build(const Parameters &);
+    void invalidate();
     std::shared_ptr<Filter> filter();
+    std::shared_ptr<SuperSignalProcessor> processor(
+        std::shared_ptr<SuperSignalProcessor>
+    );
 private:
+    std::optional<Parameters> built;
+
     void prepareFilter(const Parameters &);
+    void initializeFirFilter(const Parameters &);
     void buildFirFilter(const Parameters &);
+    void buildMinimumPhaseFirFilter(const Parameters &);
     void buildIirFilter(const Parameters &);
-    void prepareFeedbackManagement(const Parameters &);
-    void prepareAutomaticGainControl(const Parameters &);
+    void prepareFeedbackManagement(const Parameters &, bool initialize);
+    void prepareFrequencyDomainFeedbackCanceller(const Parameters &);
+    void prepareAutomaticGainControl(const Parameters &, bool initialize);
+    void prepareControlRateCompressor(const Parameters &);
+    void prepareActivityGate(const Parameters &);
     int channels(const Parameters &);
 };
 }
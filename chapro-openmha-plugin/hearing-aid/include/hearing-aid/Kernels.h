@@ -0,0 +1,67 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_KERNELS_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_KERNELS_H_
+
+#include "Fft.h"
+#include <vector>
+
+namespace hearing_aid {
+// Inner loops of the filterbank, AGC, AFC and resampler, compiled once for each
+// instruction-set level the target supports: generic, avx2-fma and
+// avx512f on x86-64, generic and neon on 32-bit ARM. kernels() picks the
+// best level the CPU reports (cpuid, or the ELF hwcaps on ARM) the first
+// time it is called. Setting HEARING_AID_KERNELS to a supported level's
+// name selects that level instead.
+struct Kernels {
+    const char *level;
+    // sum[k] += a[k] b[k]
+    void (*multiplyAccumulate)(
+        const spectrum_type *a,
+        const spectrum_type *b,
+        spectrum_type *sum,
+        int n
+    );
+    // g[k] = conj(x[k]) e[k] / (power[k] + threshold)
+    void (*normalizedCorrelation)(
+        const spectrum_type *x,
+        const spectrum_type *e,
+        const real_type *power,
+        real_type threshold,
+        spectrum_type *g,
+        int n
+    );
+    // w[k] += scale g[k]
+    void (*scaledAccumulate)(
+        const spectrum_type *g,
+        real_type scale,
+        spectrum_type *w,
+        int n
+    );
+    // out[i] = in[i] (gain + (i + 1) step) for n interleaved complex
+    // samples; returns the largest |in[i]|^2. in may equal out.
+    real_type (*rampBand)(
+        const complex_type *in,
+        complex_type *out,
+        int n,
+        real_type gain,
+        real_type step
+    );
+    // The same for n real samples.
+    real_type (*rampSignal)(
+        const real_type *in,
+        real_type *out,
+        int n,
+        real_type gain,
+        real_type step
+    );
+    // sum of a[i] b[i]
+    real_type (*dotProduct)(const real_type *a, const real_type *b, int n);
+};
+
+const Kernels &kernels();
+
+// Every compiled level this CPU supports, best first; the last is
+// generic.
+std::vector<const Kernels *> supportedKernels();
+}
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_LATENCYHISTOGRAM_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_LATENCYHISTOGRAM_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace hearing_aid {
+// Histogram of durations (or any non-negative integers) with buckets
+// that widen with magnitude: exact below 64 and within 1/32 above, so
+// percentiles of nanosecond timings stay accurate from tens of
+// nanoseconds to minutes. Recording does not allocate.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+    void record(std::uint64_t value);
+    // Upper bound of the bucket holding the value at rank p (0 to 1),
+    // never above max(); 0 when nothing is recorded.
+    std::uint64_t percentile(double p) const;
+    std::uint64_t max() const;
+    std::uint64_t count() const;
+    double mean() const;
+    void merge(const LatencyHistogram &);
+    void clear();
+private:
+    std::vector<std::uint64_t> buckets;
+    std::uint64_t count_{};
+    std::uint64_t max_{};
+    double sum{};
+};
+}
+
+#endif
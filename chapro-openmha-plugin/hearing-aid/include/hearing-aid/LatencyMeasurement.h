@@ -0,0 +1,51 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_LATENCYMEASUREMENT_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_LATENCYMEASUREMENT_H_
+
+#include "ParameterSweep.h"
+#include <vector>
+
+namespace hearing_aid {
+// Measures the delay of hearing aids built by a SweepBackend. An
+// impulse gives the algorithmic latency: the first output sample within
+// 20 dB of the peak (onset) and the peak itself. A logarithmic chirp,
+// deconvolved from the output, gives the pipeline's group delay at each
+// band's center frequency: the geometric mean of its edges, or half the
+// upper edge for the lowest band. A fresh hearing aid is built for each
+// probe.
+class LatencyMeasurement {
+public:
+    struct Parameters {
+        // Probe level in dB SPL, for the fitting's full-scale level.
+        double level;
+        // Samples of chirp, and of response captured after each probe.
+        int length;
+    };
+
+    struct Band {
+        double centerFrequency;
+        double groupDelay;
+    };
+
+    // In samples. The fragment contribution is the input and the output
+    // buffer of a double-buffered sound card, two chunks, and is not
+    // part of the algorithmic latency.
+    struct Result {
+        std::vector<Band> bands;
+        int onset;
+        int peak;
+        int fragment;
+    };
+
+    LatencyMeasurement(SweepBackend *, const Parameters &);
+    Result measure(const HearingAidBuilder::Parameters &);
+    static std::vector<double> bandCenters(
+        const std::vector<double> &crossFrequencies,
+        double sampleRate
+    );
+private:
+    Parameters p;
+    SweepBackend *backend;
+};
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_MINIMUMPHASEFILTERBANK_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_MINIMUMPHASEFILTERBANK_H_
+
+#include "AfcHearingAid.h"
+#include "Fft.h"
+#include <memory>
+#include <vector>
+
+namespace hearing_aid {
+// Partition spectra of the real and imaginary parts of every band's
+// filter: band k's partition p is at [k * partitions + p].
+struct MinimumPhaseDesign {
+    std::vector<std::vector<spectrum_type>> spectra;
+    std::vector<std::vector<spectrum_type>> quadratureSpectra;
+    int partitions;
+};
+
+// Low-latency FIR filterbank. Each band starts from the Hamming-window
+// bandpass CHAPRO designs (windowSize taps, linear phase, about half a
+// window of delay). The bands' minimum-phase counterparts have the same
+// magnitude responses with their energy in the first few taps, but
+// different phase responses, so they do not sum flat at the crossovers;
+// complementaryBands() gives every band one common phase response close
+// to theirs instead, truncated to windowSize taps. The filterbank is
+// therefore low-latency but not minimum-phase. Bands are filtered by
+// uniformly partitioned overlap-save convolution with partitions of one
+// chunk, so no block delay is added.
+//
+// Band signals are analytic, as with CHAPRO's FIR filterbank. Synthesis
+// sums their real parts. Designs are shared between filterbanks with the
+// same parameters.
+class MinimumPhaseFilterbank : public Filter {
+public:
+    struct Parameters {
+        std::vector<double> crossFrequencies;
+        double sampleRate;
+        int windowSize;
+        int chunkSize;
+    };
+    explicit MinimumPhaseFilterbank(const Parameters &);
+    void filterbankAnalyze(real_signal_type, complex_signal_type, int) override;
+    void filterbankSynthesize(
+        complex_signal_type,
+        real_signal_type,
+        int
+    ) override;
+    int partitions() const;
+private:
+    std::shared_ptr<const MinimumPhaseDesign> design;
+    Fft fft;
+    std::vector<std::vector<spectrum_type>> inputSpectra;
+    std::vector<spectrum_type> accumulator;
+    std::vector<real_type> frame;
+    std::vector<real_type> result;
+    int bands;
+    int blockSize;
+    int newest{};
+
+    void convolve(const std::vector<std::vector<spectrum_type>> &, int k);
+};
+
+// Impulse responses (windowSize taps) of the linear-phase bands.
+std::vector<std::vector<real_type>> linearPhaseBands(
+    const MinimumPhaseFilterbank::Parameters &
+);
+
+// Real and imaginary parts of an analytic filter.
+struct AnalyticFilter {
+    std::vector<real_type> real;
+    std::vector<real_type> imaginary;
+};
+
+// Analytic band filters (windowSize taps) with a common phase response,
+// whose real parts sum to an all-pass response. Band k's magnitude is its
+// linear-phase band's share of the bands' summed magnitude, and the common
+// group delay is the bands' minimum-phase group delays weighted by their
+// power, at least 8 samples.
+std::vector<AnalyticFilter> complementaryBands(
+    const MinimumPhaseFilterbank::Parameters &
+);
+
+// Minimum-phase filter with the magnitude response of h, as long as h,
+// by the real-cepstrum method.
+std::vector<real_type> minimumPhase(const std::vector<real_type> &h);
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_PARAMETERSWEEP_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_PARAMETERSWEEP_H_
+
+#include "HearingAidBuilder.h"
+#include "WorkStealingPool.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace hearing_aid {
+// One hearing aid built for a point of a sweep.
+class SweepPipeline {
+public:
+    virtual ~SweepPipeline() = default;
+    virtual void process(real_signal_type) = 0;
+    // AFC quality metric saved per fragment so far.
+    virtual std::vector<real_type> qualityMetric() = 0;
+};
+
+// Builds independent pipelines; called from the sweep's workers, one at
+// a time.
+class SweepBackend {
+public:
+    virtual ~SweepBackend() = default;
+    virtual std::unique_ptr<SweepPipeline> make(
+        const HearingAidBuilder::Parameters &
+    ) = 0;
+};
+
+// Evaluates every combination of candidate compression ratios,
+// kneepoints and kneepoint gains on the same input. Points are run in
+// parallel but built one at a time, since CHAPRO's prepare functions are
+// not known to be reentrant; processing dominates a sweep, so little is
+// lost. Each point is a fresh pipeline so results do not depend on the
+// order they are evaluated in.
+class ParameterSweep {
+    WorkStealingPool pool;
+    std::mutex making;
+    SweepBackend *backend;
+public:
+    struct Grid {
+        std::vector<std::vector<double>> compressionRatios;
+        std::vector<std::vector<double>> kneepoints;
+        std::vector<std::vector<double>> kneepointGains;
+    };
+
+    // With noise, SNR is measured by phase inversion: each point also
+    // processes signal minus noise, and the half sum and half
+    // difference of the two outputs estimate the processed signal and
+    // noise.
+    struct Input {
+        std::vector<real_type> signal;
+        std::vector<real_type> noise;
+    };
+
+    struct Metrics {
+        bool level;
+        bool snr;
+        bool feedbackQuality;
+    };
+
+    // Metrics not requested are NaN. Level is the output level in dB
+    // SPL; feedback quality is the mean AFC quality metric over the
+    // second half of the input, after the canceller has converged.
+    struct Result {
+        std::vector<double> compressionRatios;
+        std::vector<double> kneepoints;
+        std::vector<double> kneepointGains;
+        double level;
+        double snr;
+        double feedbackQuality;
+    };
+
+    ParameterSweep(SweepBackend *, int threads);
+    std::vector<Result> run(
+        const HearingAidBuilder::Parameters &fitting,
+        const Grid &,
+        const Input &,
+        const Metrics &
+    );
+    static std::vector<Result> points(const Grid &);
+private:
+    std::unique_ptr<SweepPipeline> make(const HearingAidBuilder::Parameters &);
+};
+}
+
+#endif
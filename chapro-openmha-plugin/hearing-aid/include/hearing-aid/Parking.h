@@ -0,0 +1,62 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_PARKING_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_PARKING_H_
+
+#include <semaphore.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace hearing_aid {
+// Lets threads wait for a condition set by another thread: a waiter
+// yields for up to the spin time, then sleeps on a semaphore until
+// notified. Waking a sleeper takes tens of microseconds, so waiters that
+// should answer within a fragment spin for at least a fragment period.
+// notify() must follow every change that can make a waiter's condition
+// true. It neither blocks nor takes a lock, so an audio thread may call
+// it: it posts the semaphore once per sleeping thread, and makes no
+// system call while the waiters are still spinning.
+class Parking {
+    sem_t semaphore{};
+    std::atomic<int> sleepers{0};
+    std::chrono::nanoseconds spin;
+public:
+    static constexpr std::chrono::microseconds defaultSpin{200};
+
+    explicit Parking(std::chrono::nanoseconds spin = defaultSpin) :
+        spin{spin}
+    {
+        sem_init(&semaphore, 0, 0);
+    }
+
+    ~Parking() { sem_destroy(&semaphore); }
+    Parking(const Parking &) = delete;
+    Parking &operator=(const Parking &) = delete;
+
+    template<typename Ready>
+    void wait(Ready ready) {
+        const auto deadline = std::chrono::steady_clock::now() + spin;
+        while (!ready())
+            if (std::chrono::steady_clock::now() < deadline)
+                std::this_thread::yield();
+            else {
+                // Announcing the sleeper before checking again pairs with
+                // notify() checking for sleepers after the change: one of
+                // them sees the other. A post the waiter did not need
+                // only costs it another check.
+                sleepers.fetch_add(1);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!ready())
+                    while (sem_wait(&semaphore) != 0) {}
+                sleepers.fetch_sub(1);
+            }
+    }
+
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (auto n = sleepers.load(); n > 0; --n)
+            sem_post(&semaphore);
+    }
+};
+}
+
+#endif
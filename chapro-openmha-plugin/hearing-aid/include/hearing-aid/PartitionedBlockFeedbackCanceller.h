@@ -0,0 +1,67 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_PARTITIONEDBLOCKFEEDBACKCANCELLER_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_PARTITIONEDBLOCKFEEDBACKCANCELLER_H_
+
+#include "AfcHearingAid.h"
+#include "Fft.h"
+#include <memory>
+#include <vector>
+
+namespace hearing_aid {
+// Partitioned-block frequency-domain adaptive feedback canceller
+// (overlap-save, block size equal to the chunk size). The adaptive filter
+// is split into partitions of one chunk each; the gradient constraint is
+// applied to one partition per chunk in turn, so the cost per sample grows
+// with the partition count rather than the filter length.
+//
+// The reference signal is the processor output delayed by one chunk plus
+// the hardware latency. Compression is forwarded to the decorated
+// processor.
+class PartitionedBlockFeedbackCanceller : public SuperSignalProcessor {
+public:
+    struct Parameters {
+        double filterEstimationForgettingFactor;
+        double filterEstimationPowerThreshold;
+        double filterEstimationStepSize;
+        int adaptiveFilterLength;
+        int hardwareLatency;
+    };
+    PartitionedBlockFeedbackCanceller(
+        std::shared_ptr<SuperSignalProcessor>,
+        const Parameters &
+    );
+    void feedbackCancelInput(real_signal_type, real_signal_type, int) override;
+    void compressInput(real_signal_type, real_signal_type, int) override;
+    void compressChannel(complex_signal_type, complex_signal_type, int) override;
+    void compressOutput(real_signal_type, real_signal_type, int) override;
+    void feedbackCancelOutput(real_signal_type, int) override;
+    int chunkSize() override;
+    int channels() override;
+    int partitions() const;
+private:
+    std::shared_ptr<SuperSignalProcessor> processor;
+    Fft fft;
+    std::vector<std::vector<spectrum_type>> weights;
+    std::vector<std::vector<spectrum_type>> references;
+    std::vector<spectrum_type> estimate;
+    std::vector<spectrum_type> gradient;
+    std::vector<spectrum_type> error;
+    std::vector<real_type> power;
+    std::vector<real_type> frame;
+    std::vector<real_type> previous;
+    std::vector<real_type> delayLine;
+    real_type forgettingFactor;
+    real_type powerThreshold;
+    real_type stepSize;
+    int blockSize;
+    int newest{};
+    int constrained{};
+    int delayLineHead{};
+
+    void pushReference();
+    void adapt(real_signal_type);
+    void constrain(std::vector<spectrum_type> &);
+    std::vector<spectrum_type> &reference(int partition);
+};
+}
+
+#endif
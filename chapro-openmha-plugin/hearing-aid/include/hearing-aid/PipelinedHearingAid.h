@@ -0,0 +1,97 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_PIPELINEDHEARINGAID_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_PIPELINEDHEARINGAID_H_
+
+#include "AfcHearingAid.h"
+#include "Parking.h"
+#include "SpscQueue.h"
+#include "WorkStealingPool.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace hearing_aid {
+// Runs the AfcHearingAid stages as a three-stage pipeline:
+//  - the calling thread cancels feedback,
+//  - a worker compresses the input, analyzes and compresses the channels,
+//    optionally sharing the bands with a WorkStealingPool when the
+//    processor is a BandCompressor, and then compresses the output of the
+//    previous fragment,
+//  - a worker synthesizes.
+// CHAPRO's AGC stages share state in cha_pointer, so the input, channel
+// and output compressors all run on the compress stage, one at a time.
+// Stages exchange fragments through lock-free SPSC queues; a worker
+// waiting for a fragment spins for Parameters::spin and then parks until
+// one is pushed. Each call returns the fragment submitted latencyFragments()
+// calls earlier (zeros while the pipeline fills). The calling thread
+// never waits for the workers or takes a lock: a fragment that is not
+// ready in time is replaced by zeros and dropped when it arrives, and an
+// input arriving while every fragment is in flight is not processed.
+// Both feedback cancellation stages run on the calling thread when a
+// fragment enters and leaves the pipeline, so the feedback canceller's
+// view of the hardware delay is unchanged.
+class PipelinedHearingAid : public SignalProcessor {
+public:
+    struct Parameters {
+        // Cores for the compress stage, the synthesize stage and then each
+        // band helper. Missing entries leave threads unpinned.
+        std::vector<int> cores;
+        // Threads sharing channel compression, including the stage itself.
+        int bandThreads;
+        // Run the stage and band threads in flush-to-zero mode.
+        bool flushDenormals;
+        // How long idle stage and band threads spin before parking; one
+        // fragment period keeps them awake between fragments.
+        std::chrono::nanoseconds spin{Parking::defaultSpin};
+    };
+    PipelinedHearingAid(
+        std::shared_ptr<SuperSignalProcessor>,
+        std::shared_ptr<Filter>,
+        const Parameters &
+    );
+    ~PipelinedHearingAid() override;
+    PipelinedHearingAid(const PipelinedHearingAid &) = delete;
+    PipelinedHearingAid &operator=(const PipelinedHearingAid &) = delete;
+    void process(real_signal_type signal) override;
+    static constexpr int latencyFragments() { return 2; }
+    int latencySamples();
+    // Calls that output zeros because their fragment was late or could
+    // not be submitted.
+    int missedFragments() const;
+private:
+    struct Fragment {
+        std::vector<real_type> signal;
+        std::vector<complex_type> bands;
+    };
+    std::vector<Fragment> fragments;
+    SpscQueue<int> available;
+    SpscQueue<int> submitted;
+    SpscQueue<int> compressed;
+    SpscQueue<int> synthesized;
+    SpscQueue<int> delivered;
+    Parking submittedParking;
+    Parking compressedParking;
+    Parking synthesizedParking;
+    std::shared_ptr<SuperSignalProcessor> processor;
+    std::shared_ptr<Filter> filter;
+    std::shared_ptr<BandCompressor> bandCompressor;
+    WorkStealingPool bandPool;
+    std::vector<std::thread> threads;
+    std::atomic<bool> stopping{false};
+    // Bit n is set when the call n calls ago submitted a fragment.
+    unsigned submissions{};
+    // Submitted fragments that were due but replaced by zeros.
+    int late{};
+    int missed{};
+    int chunkSize;
+
+    void compressStage();
+    void synthesizeStage();
+    void compress(int slot);
+    bool submit(real_signal_type signal);
+    void retireLate();
+};
+}
+
+#endif
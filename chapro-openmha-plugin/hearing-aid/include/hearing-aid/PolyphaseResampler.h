@@ -0,0 +1,49 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_POLYPHASERESAMPLER_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_POLYPHASERESAMPLER_H_
+
+#include "AfcHearingAid.h"
+#include <memory>
+#include <vector>
+
+namespace hearing_aid {
+// Streaming rational sample-rate converter. The Kaiser-windowed sinc
+// prototype for upsampling by L and downsampling by M is designed for a
+// passband and stopband relative to the lower of the two rates, and
+// split into L phases, so each output sample costs one dot product of
+// taps() coefficients.
+class PolyphaseResampler {
+public:
+    struct Parameters {
+        int inputRate;
+        int outputRate;
+        // Passband edge as a fraction of the lower rate's Nyquist
+        // frequency; the stopband starts at that Nyquist frequency.
+        double passband;
+        // dB
+        double stopbandAttenuation;
+        // Most input samples passed to one call of process().
+        int maxInput;
+    };
+    explicit PolyphaseResampler(const Parameters &);
+    // Returns the number of output samples written. Output must hold at
+    // least maxOutput(input.size()) samples; input longer than maxInput
+    // is ignored.
+    int process(real_signal_type input, real_signal_type output);
+    int maxOutput(int input) const;
+    // Group delay of the prototype filter in output samples.
+    double delay() const;
+    int upsampling() const;
+    int taps() const;
+    int downsampling() const;
+private:
+    std::vector<real_type> coefficients;
+    std::vector<real_type> history;
+    int taps_;
+    int up;
+    int down;
+    int phase{};
+    int position{};
+};
+}
+
+#endif
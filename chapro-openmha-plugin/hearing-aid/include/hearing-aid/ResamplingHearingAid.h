@@ -0,0 +1,48 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_RESAMPLINGHEARINGAID_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_RESAMPLINGHEARINGAID_H_
+
+#include "AfcHearingAid.h"
+#include "PolyphaseResampler.h"
+#include <memory>
+#include <vector>
+
+namespace hearing_aid {
+// Runs a hearing aid at a lower internal sample rate than the audio
+// interface. Each external fragment is downsampled into a queue; whole
+// internal fragments are processed and upsampled into an output queue
+// that starts primed with enough zeros never to run dry.
+class ResamplingHearingAid : public SignalProcessor {
+public:
+    struct Parameters {
+        int externalRate;
+        int internalRate;
+        int externalChunkSize;
+        // Of both converters; see PolyphaseResampler.
+        double passband;
+        double stopbandAttenuation;
+    };
+    // The fragment size the internal hearing aid has to be prepared with.
+    static int internalChunkSize(const Parameters &);
+    ResamplingHearingAid(std::unique_ptr<SignalProcessor>, const Parameters &);
+    void process(real_signal_type signal) override;
+    // Delay added by resampling and queueing, in external samples. The
+    // internal hearing aid's feedback loop runs through both converters
+    // and queues, so its hardware delay has to include this.
+    static int latencySamples(const Parameters &);
+    int latencySamples() const;
+private:
+    std::unique_ptr<SignalProcessor> processor;
+    PolyphaseResampler down;
+    PolyphaseResampler up;
+    std::vector<real_type> downsampled;
+    std::vector<real_type> internalQueue;
+    std::vector<real_type> outputQueue;
+    double latency;
+    int externalChunkSize;
+    int internalChunkSize_;
+    int internalQueued{};
+    int outputQueued;
+};
+}
+
+#endif
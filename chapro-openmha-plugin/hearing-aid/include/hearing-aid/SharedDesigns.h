@@ -0,0 +1,48 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_SHAREDDESIGNS_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_SHAREDDESIGNS_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace hearing_aid {
+// Hands out one immutable design per key to every instance asking for it.
+// A design is computed by the first acquire() for its key and released
+// when the last instance holding it lets go, so instances with the same
+// configuration share one copy instead of each holding their own.
+template<typename Key, typename Design>
+class SharedDesigns {
+    std::map<Key, std::weak_ptr<const Design>> designs;
+    std::mutex mutex;
+public:
+    // design() returns a Design and is called with the registry locked.
+    template<typename F>
+    std::shared_ptr<const Design> acquire(const Key &key, F &&design) {
+        std::lock_guard<std::mutex> lock{mutex};
+        prune();
+        auto &entry = designs[key];
+        if (auto shared = entry.lock())
+            return shared;
+        auto shared = std::make_shared<const Design>(design());
+        entry = shared;
+        return shared;
+    }
+
+    // Number of designs still held by some instance.
+    int size() {
+        std::lock_guard<std::mutex> lock{mutex};
+        prune();
+        return static_cast<int>(designs.size());
+    }
+private:
+    void prune() {
+        for (auto it = designs.begin(); it != designs.end();)
+            if (it->second.expired())
+                it = designs.erase(it);
+            else
+                ++it;
+    }
+};
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_SPECTRALCOMPRESSOR_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_SPECTRALCOMPRESSOR_H_
+
+#include "ControlRateCompressor.h"
+#include <string>
+#include <vector>
+
+namespace hearing_aid {
+// Channel compression applied directly to STFT frames. Bins are grouped
+// into bands at the cross frequencies; each band's gain follows its
+// frame power with the fitting's curve, attack and release, and is
+// applied to every bin of the band. Frame power assumes an unnormalized
+// forward FFT of a frame weighted by the window and is normalized by the
+// window's energy, so that, as in the chapro plugin, a sine of amplitude
+// A reads the full-scale level plus 20 log10 A.
+class SpectralCompressor {
+    std::vector<GainTrajectory> bandGains;
+    std::vector<int> firstBins;
+    double powerScale;
+    int bins_;
+    int nyquist;
+public:
+    struct Parameters {
+        ControlRateCompressor::Parameters fitting;
+        std::vector<double> crossFrequencies;
+        // The analysis window (wndlen samples); empty is rectangular
+        // over the FFT length.
+        std::vector<double> window;
+        int fftLength;
+        int hopSize;
+    };
+    explicit SpectralCompressor(const Parameters &);
+    // fftLength / 2 + 1 bins, real and imaginary parts interleaved.
+    void process(complex_signal_type frame);
+    int bins() const;
+    int bands() const;
+    // Band k covers bins bandEdges()[k] up to but excluding
+    // bandEdges()[k + 1].
+    const std::vector<int> &bandEdges() const;
+    real_type levelDecibels(int band) const;
+};
+
+// openMHA's analysis windows ("rect", "bartlett", "hanning", "hamming"
+// and "blackman") raised to the exponent, as wave2spec computes them
+// from wndtype and wndexp.
+std::vector<double> analysisWindow(
+    const std::string &type,
+    int length,
+    double exponent = 1
+);
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_SPSCQUEUE_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_SPSCQUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace hearing_aid {
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Storage is allocated once at construction.
+template<typename T>
+class SpscQueue {
+    std::vector<T> items;
+    alignas(64) std::atomic<std::size_t> head{0};
+    alignas(64) std::atomic<std::size_t> tail{0};
+public:
+    explicit SpscQueue(std::size_t capacity) : items(capacity + 1) {}
+
+    bool push(const T &item) {
+        const auto t = tail.load(std::memory_order_relaxed);
+        const auto next = advance(t);
+        if (next == head.load(std::memory_order_acquire))
+            return false;
+        items[t] = item;
+        tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &item) {
+        const auto h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false;
+        item = items[h];
+        head.store(advance(h), std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) ==
+            tail.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const {
+        return items.size() - 1;
+    }
+private:
+    std::size_t advance(std::size_t i) const {
+        return i + 1 == items.size() ? 0 : i + 1;
+    }
+};
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_STREAMHOST_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_STREAMHOST_H_
+
+#include "AfcHearingAid.h"
+#include "WorkStealingPool.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace hearing_aid {
+// Hosts many independent hearing aids (streams) in one process. Each call
+// to process() hands every stream one fragment; the fragments are taken
+// earliest deadline first by the threads of a core-pinned pool, and a
+// stream misses its deadline when its fragment finishes later than its
+// deadline after process() was called.
+class StreamHost {
+public:
+    using duration_type = std::chrono::nanoseconds;
+    struct Parameters {
+        // Cores for the threads besides the caller of process(). Missing
+        // entries leave threads unpinned.
+        std::vector<int> cores;
+        // Threads processing fragments, including the calling thread.
+        int threads;
+    };
+    struct Statistics {
+        duration_type worstCompletion;
+        int fragments;
+        int deadlineMisses;
+    };
+    explicit StreamHost(const Parameters &);
+    // Returns the index of the new stream. Streams are only added
+    // between calls to process().
+    int add(std::unique_ptr<SignalProcessor>, duration_type deadline);
+    // One fragment per stream, in the order the streams were added.
+    void process(const std::vector<real_signal_type> &signals);
+    Statistics statistics(int stream) const;
+    int streams() const;
+private:
+    struct Stream {
+        std::unique_ptr<SignalProcessor> processor;
+        duration_type deadline;
+        Statistics statistics;
+    };
+    std::vector<Stream> streams_;
+    std::vector<int> schedule;
+    WorkStealingPool pool;
+    std::atomic<int> next{0};
+
+    void serve(
+        const std::vector<real_signal_type> &,
+        std::chrono::steady_clock::time_point start
+    );
+};
+}
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_THREADAFFINITY_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_THREADAFFINITY_H_
+
+#include <thread>
+
+namespace hearing_aid {
+// Restricts a thread to one core. Returns false where affinity is not
+// supported or the core does not exist; the thread then stays unpinned.
+bool pinToCore(std::thread &, int core);
+bool pinCurrentThreadToCore(int core);
+// Moves the calling thread to SCHED_FIFO at the given priority. Returns
+// false where unsupported or not permitted.
+bool makeCurrentThreadRealtime(int priority);
+// Locks current and future pages in memory so page faults cannot stall
+// the audio thread. Returns false where unsupported or not permitted.
+bool lockMemory();
+}
+
+#endif
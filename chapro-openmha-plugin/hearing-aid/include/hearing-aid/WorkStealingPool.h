@@ -0,0 +1,71 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_WORKSTEALINGPOOL_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_INCLUDE_HEARING_AID_WORKSTEALINGPOOL_H_
+
+#include "Parking.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace hearing_aid {
+// Runs a batch of independent tasks on a fixed set of workers, which
+// spin for the spin time between batches and then park until the next
+// one. The
+// calling thread takes part as worker 0. Each worker starts on its
+// own contiguous share of the task indices and, once that is exhausted,
+// steals the remaining indices of the others. run() returns after every
+// task has completed and does not allocate; workers still leaving the
+// previous batch are waited for at the start of the next one.
+class WorkStealingPool {
+public:
+    // Threads includes the calling thread; cores pins the additional
+    // workers in order. flushDenormals puts the additional workers in
+    // flush-to-zero mode for their lifetime. A spin of at least the time
+    // between batches keeps the workers awake while batches keep coming.
+    explicit WorkStealingPool(
+        int threads,
+        const std::vector<int> &cores = {},
+        bool flushDenormals = false,
+        std::chrono::nanoseconds spin = Parking::defaultSpin
+    );
+    ~WorkStealingPool();
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    template<typename F>
+    void run(int tasks, F &&f) {
+        run(
+            tasks,
+            [](void *context, int task) {
+                (*static_cast<std::remove_reference_t<F> *>(context))(task);
+            },
+            &f
+        );
+    }
+
+    int threads() const;
+private:
+    struct alignas(64) Share {
+        std::atomic<int> next{0};
+        int end{};
+    };
+    std::unique_ptr<Share[]> shares;
+    std::vector<std::thread> workers;
+    void (*task)(void *, int){};
+    void *context{};
+    std::atomic<int> generation{0};
+    std::atomic<int> completed{0};
+    std::atomic<int> finished{0};
+    std::atomic<bool> stopping{false};
+    Parking parking;
+    int threads_;
+    bool flushDenormals;
+
+    void run(int tasks, void (*)(void *, int), void *);
+    void work(int worker);
+    void execute(int worker);
+};
+}
+
+#endif
@@ -0,0 +1,208 @@
+#include "ActivityGate.h"
+#include <algorithm>
+#include <cmath>
+
+namespace hearing_aid {
+namespace {
+class BandActivityGate : public ActivityGate, public BandCompressor {
+    BandCompressor *bandCompressor;
+public:
+    BandActivityGate(
+        std::shared_ptr<SuperSignalProcessor> processor,
+        BandCompressor *bandCompressor,
+        const Parameters &p
+    ) :
+        ActivityGate{std::move(processor), p},
+        bandCompressor{bandCompressor} {}
+
+    void compressChannels(
+        complex_signal_type input,
+        complex_signal_type output,
+        int chunkSize,
+        int firstChannel,
+        int channelCount
+    ) override {
+        gate(input, output, chunkSize, firstChannel, channelCount, [&] {
+            bandCompressor->compressChannels(
+                input,
+                output,
+                chunkSize,
+                firstChannel,
+                channelCount
+            );
+        });
+    }
+};
+}
+
+static real_type power(double decibels) {
+    return std::pow(10., decibels / 10);
+}
+
+std::shared_ptr<ActivityGate> ActivityGate::make(
+    std::shared_ptr<SuperSignalProcessor> processor,
+    const Parameters &p
+) {
+    if (const auto bandCompressor =
+            dynamic_cast<BandCompressor *>(processor.get()))
+        return std::make_shared<BandActivityGate>(
+            std::move(processor),
+            bandCompressor,
+            p
+        );
+    return std::make_shared<ActivityGate>(std::move(processor), p);
+}
+
+ActivityGate::ActivityGate(
+    std::shared_ptr<SuperSignalProcessor> processor_,
+    const Parameters &p
+) :
+    processor{std::move(processor_)},
+    gains(processor->channels(), 1),
+    held(2 * processor->chunkSize() * processor->channels()),
+    threshold{
+        p.silenceLevel > 0 ? power(p.silenceLevel - p.fullScaleLevel) : 0
+    },
+    holdFragments{std::max(p.holdFragments, 1)},
+    updateInterval{std::max(p.updateInterval, 1)} {}
+
+void ActivityGate::feedbackCancelInput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    real_type sum = 0;
+    for (int i = 0; i < chunkSize; ++i)
+        sum += input[i] * input[i];
+    if (chunkSize > 0 && sum / chunkSize < threshold)
+        quietFragments = std::min(quietFragments + 1, holdFragments);
+    else
+        quietFragments = 0;
+    const auto wasReduced = reduced_;
+    reduced_ = quietFragments == holdFragments;
+    if (reduced_ && !wasReduced)
+        skipped = 0;
+    auto next = Mode::compress;
+    if (reduced_) {
+        if (++skipped >= updateInterval)
+            skipped = 0;
+        else
+            next = Mode::hold;
+    } else if (wasReduced) {
+        next = Mode::resume;
+    }
+    mode.store(next, std::memory_order_release);
+    processor->feedbackCancelInput(input, output, chunkSize);
+}
+
+void ActivityGate::compressInput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    processor->compressInput(input, output, chunkSize);
+}
+
+void ActivityGate::compressChannel(
+    complex_signal_type input,
+    complex_signal_type output,
+    int chunkSize
+) {
+    gate(input, output, chunkSize, 0, channels(), [&] {
+        processor->compressChannel(input, output, chunkSize);
+    });
+}
+
+template<typename F>
+void ActivityGate::gate(
+    complex_signal_type input,
+    complex_signal_type output,
+    int chunkSize,
+    int first,
+    int n,
+    F &&compress
+) {
+    const auto current = mode.load(std::memory_order_acquire);
+    if (current == Mode::hold) {
+        applyHeldGains(input, output, chunkSize, first, n);
+        return;
+    }
+    std::copy(
+        input.data() + 2 * chunkSize * first,
+        input.data() + 2 * chunkSize * (first + n),
+        held.data() + 2 * chunkSize * first
+    );
+    compress();
+    remeasure(output, chunkSize, first, n, current == Mode::resume);
+}
+
+static real_type bandPower(const real_type *x, int chunkSize) {
+    real_type sum = 0;
+    for (int i = 0; i < 2 * chunkSize; ++i)
+        sum += x[i] * x[i];
+    return sum;
+}
+
+// Remeasures each band gain from the power ratio across the decorated
+// compression. When resuming from reduced mode the output fades from
+// the held gains to the compressed result over the fragment so the
+// switch does not click.
+void ActivityGate::remeasure(
+    complex_signal_type output,
+    int chunkSize,
+    int first,
+    int n,
+    bool resuming
+) {
+    for (int k = first; k < first + n; ++k) {
+        const auto x = held.data() + 2 * chunkSize * k;
+        const auto y = output.data() + 2 * chunkSize * k;
+        const auto previous = gains[k];
+        const auto in = bandPower(x, chunkSize);
+        if (in > 0)
+            gains[k] = std::sqrt(bandPower(y, chunkSize) / in);
+        if (!resuming)
+            continue;
+        for (int i = 0; i < chunkSize; ++i) {
+            const auto w = real_type(i + 1) / chunkSize;
+            y[2 * i] = (1 - w) * previous * x[2 * i] + w * y[2 * i];
+            y[2 * i + 1] =
+                (1 - w) * previous * x[2 * i + 1] + w * y[2 * i + 1];
+        }
+    }
+}
+
+void ActivityGate::applyHeldGains(
+    complex_signal_type input,
+    complex_signal_type output,
+    int chunkSize,
+    int first,
+    int n
+) {
+    for (int k = first; k < first + n; ++k) {
+        const auto offset = 2 * chunkSize * k;
+        for (int i = 0; i < 2 * chunkSize; ++i)
+            output[offset + i] = gains[k] * input[offset + i];
+    }
+}
+
+void ActivityGate::compressOutput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    processor->compressOutput(input, output, chunkSize);
+}
+
+void ActivityGate::feedbackCancelOutput(real_signal_type input, int chunkSize) {
+    processor->feedbackCancelOutput(input, chunkSize);
+}
+
+int ActivityGate::chunkSize() {
+    return processor->chunkSize();
+}
+
+int ActivityGate::channels() {
+    return gsl::narrow_cast<int>(gains.size());
+}
+}
@@ -1,4 +1,5 @@
 #include "AfcHearingAid.h"
+#include <cmath>
 
 namespace hearing_aid {
 AfcHearingAid::AfcHearingAid(
@@ -6,9 +7,29 @@ AfcHearingAid::AfcHearingAid(
     std::shared_ptr<Filter> filter
 ) :
     buffer(2 * processor->chunkSize() * processor->channels()),
+    compressed(buffer.size()),
+    levels(processor->channels()),
     processor{std::move(processor)},
     filter{std::move(filter)} {}
 
+static void measure(
+    const std::vector<complex_type> &bands,
+    std::vector<real_type> &levels,
+    int chunkSize,
+    real_type fullScaleLevel
+) {
+    constexpr auto floor = real_type{1e-20F};
+    auto band = bands.data();
+    for (auto &level : levels) {
+        real_type sum = 0;
+        for (int i = 0; i < 2 * chunkSize; ++i)
+            sum += band[i] * band[i];
+        const auto power = chunkSize > 0 ? sum / chunkSize : 0;
+        level = 10 * std::log10(power > floor ? power : floor) + fullScaleLevel;
+        band += 2 * chunkSize;
+    }
+}
+
 void AfcHearingAid::process(real_signal_type signal)  {
     const auto chunkSize = processor->chunkSize();
     if (signal.size() != chunkSize)
@@ -16,9 +37,24 @@ void AfcHearingAid::process(real_signal_type signal)  {
     processor->feedbackCancelInput(signal, signal, chunkSize);
     processor->compressInput(signal, signal, chunkSize);
     filter->filterbankAnalyze(signal, buffer, chunkSize);
-    processor->compressChannel(buffer, buffer, chunkSize);
-    filter->filterbankSynthesize(buffer, signal, chunkSize);
+    if (measureLevels)
+        measure(buffer, levels, chunkSize, fullScaleLevel);
+    processor->compressChannel(buffer, compressed, chunkSize);
+    filter->filterbankSynthesize(compressed, signal, chunkSize);
     processor->compressOutput(signal, signal, chunkSize);
     processor->feedbackCancelOutput(signal, chunkSize);
 }
+
+complex_signal_type AfcHearingAid::bands() {
+    return buffer;
+}
+
+real_signal_type AfcHearingAid::bandLevels() {
+    return levels;
+}
+
+void AfcHearingAid::measureBandLevels(double fullScaleLevel_) {
+    fullScaleLevel = static_cast<real_type>(fullScaleLevel_);
+    measureLevels = true;
+}
 }
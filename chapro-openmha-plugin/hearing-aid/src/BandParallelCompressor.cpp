@@ -0,0 +1,90 @@
+#include "BandParallelCompressor.h"
+
+namespace hearing_aid {
+BandParallelCompressor::BandParallelCompressor(
+    std::shared_ptr<SuperSignalProcessor> processor_,
+    const Parameters &p
+) :
+    processor{std::move(processor_)},
+    bandCompressor{std::dynamic_pointer_cast<BandCompressor>(processor)},
+    pool{
+        bandCompressor ? p.threads : 1,
+        p.cores,
+        p.flushDenormals,
+        p.spin
+    },
+    threshold{p.threshold} {}
+
+bool BandParallelCompressor::parallel(int chunkSize) {
+    return bandCompressor && pool.threads() > 1 &&
+        chunkSize * channels() >= threshold;
+}
+
+void BandParallelCompressor::compressChannel(
+    complex_signal_type input,
+    complex_signal_type output,
+    int chunkSize
+) {
+    if (parallel(chunkSize))
+        compressChannels(input, output, chunkSize, 0, channels());
+    else
+        processor->compressChannel(input, output, chunkSize);
+}
+
+void BandParallelCompressor::compressChannels(
+    complex_signal_type input,
+    complex_signal_type output,
+    int chunkSize,
+    int firstChannel,
+    int channelCount
+) {
+    pool.run(channelCount, [&](int band) {
+        bandCompressor->compressChannels(
+            input,
+            output,
+            chunkSize,
+            firstChannel + band,
+            1
+        );
+    });
+}
+
+void BandParallelCompressor::feedbackCancelInput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    processor->feedbackCancelInput(input, output, chunkSize);
+}
+
+void BandParallelCompressor::compressInput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    processor->compressInput(input, output, chunkSize);
+}
+
+void BandParallelCompressor::compressOutput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    processor->compressOutput(input, output, chunkSize);
+}
+
+void BandParallelCompressor::feedbackCancelOutput(
+    real_signal_type input,
+    int chunkSize
+) {
+    processor->feedbackCancelOutput(input, chunkSize);
+}
+
+int BandParallelCompressor::chunkSize() {
+    return processor->chunkSize();
+}
+
+int BandParallelCompressor::channels() {
+    return processor->channels();
+}
+}
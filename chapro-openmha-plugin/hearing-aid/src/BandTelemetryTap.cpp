@@ -0,0 +1,189 @@
+#include "BandTelemetryTap.h"
+#include <algorithm>
+#include <cmath>
+
+namespace hearing_aid {
+namespace {
+class BandCompressorTelemetryTap :
+    public BandTelemetryTap,
+    public BandCompressor
+{
+    BandCompressor *bandCompressor;
+public:
+    BandCompressorTelemetryTap(
+        std::shared_ptr<SuperSignalProcessor> processor,
+        BandCompressor *bandCompressor,
+        const Parameters &p
+    ) :
+        BandTelemetryTap{std::move(processor), p},
+        bandCompressor{bandCompressor} {}
+
+    void compressChannels(
+        complex_signal_type input,
+        complex_signal_type output,
+        int chunkSize,
+        int firstChannel,
+        int channelCount
+    ) override {
+        beforeCompressing(input.data(), chunkSize, firstChannel, channelCount);
+        bandCompressor->compressChannels(
+            input,
+            output,
+            chunkSize,
+            firstChannel,
+            channelCount
+        );
+        afterCompressing(output.data(), chunkSize, firstChannel, channelCount);
+    }
+};
+}
+
+std::shared_ptr<BandTelemetryTap> BandTelemetryTap::make(
+    std::shared_ptr<SuperSignalProcessor> processor,
+    const Parameters &p
+) {
+    if (const auto bandCompressor =
+            dynamic_cast<BandCompressor *>(processor.get()))
+        return std::make_shared<BandCompressorTelemetryTap>(
+            std::move(processor),
+            bandCompressor,
+            p
+        );
+    return std::make_shared<BandTelemetryTap>(std::move(processor), p);
+}
+
+BandTelemetryTap::BandTelemetryTap(
+    std::shared_ptr<SuperSignalProcessor> processor_,
+    const Parameters &p
+) :
+    processor{std::move(processor_)},
+    slots(gsl::narrow<std::size_t>(processor->channels())),
+    fullScaleLevel{static_cast<real_type>(p.fullScaleLevel)},
+    interval{std::max(p.interval, 1)}
+{
+    for (auto &slot : slots)
+        slot.countdown = interval;
+}
+
+static real_type power(const complex_type *band, int chunkSize) {
+    real_type sum = 0;
+    for (int i = 0; i < 2 * chunkSize; ++i)
+        sum += band[i] * band[i];
+    return chunkSize > 0 ? sum / chunkSize : 0;
+}
+
+void BandTelemetryTap::beforeCompressing(
+    const complex_type *bands,
+    int chunkSize,
+    int first,
+    int n
+) {
+    for (int c = first; c < first + n; ++c) {
+        auto &slot = slots[c];
+        slot.measuring = --slot.countdown == 0;
+        if (!slot.measuring)
+            continue;
+        slot.countdown = interval;
+        slot.inputPower = power(bands + 2 * chunkSize * c, chunkSize);
+    }
+}
+
+void BandTelemetryTap::afterCompressing(
+    const complex_type *bands,
+    int chunkSize,
+    int first,
+    int n
+) {
+    constexpr auto floor = real_type{1e-20F};
+    for (int c = first; c < first + n; ++c) {
+        auto &slot = slots[c];
+        if (!slot.measuring)
+            continue;
+        const auto input = slot.inputPower;
+        const auto output = power(bands + 2 * chunkSize * c, chunkSize);
+        publish(
+            slot,
+            10 * std::log10(std::max(input, floor)) + fullScaleLevel,
+            input > floor
+                ? 10 * std::log10(std::max(output, floor) / input)
+                : slot.gain.load(std::memory_order_relaxed)
+        );
+    }
+}
+
+void BandTelemetryTap::publish(Slot &slot, real_type level, real_type gain) {
+    const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.level.store(level, std::memory_order_relaxed);
+    slot.gain.store(gain, std::memory_order_relaxed);
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+std::vector<BandTelemetryTap::Band> BandTelemetryTap::read() const {
+    std::vector<Band> bands;
+    for (const auto &slot : slots)
+        for (;;) {
+            const auto sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence % 2 != 0)
+                continue;
+            const auto level = slot.level.load(std::memory_order_relaxed);
+            const auto gain = slot.gain.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+                bands.push_back({level, gain, sequence / 2});
+                break;
+            }
+        }
+    return bands;
+}
+
+void BandTelemetryTap::compressChannel(
+    complex_signal_type input,
+    complex_signal_type output,
+    int chunkSize
+) {
+    beforeCompressing(input.data(), chunkSize, 0, channels());
+    processor->compressChannel(input, output, chunkSize);
+    afterCompressing(output.data(), chunkSize, 0, channels());
+}
+
+void BandTelemetryTap::feedbackCancelInput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    processor->feedbackCancelInput(input, output, chunkSize);
+}
+
+void BandTelemetryTap::compressInput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    processor->compressInput(input, output, chunkSize);
+}
+
+void BandTelemetryTap::compressOutput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    processor->compressOutput(input, output, chunkSize);
+}
+
+void BandTelemetryTap::feedbackCancelOutput(
+    real_signal_type input,
+    int chunkSize
+) {
+    processor->feedbackCancelOutput(input, chunkSize);
+}
+
+int BandTelemetryTap::chunkSize() {
+    return processor->chunkSize();
+}
+
+int BandTelemetryTap::channels() {
+    return gsl::narrow_cast<int>(slots.size());
+}
+}
@@ -0,0 +1,20 @@
+#include "CompressionCurve.h"
+
+namespace hearing_aid {
+double gainDecibels(const CompressionCurve &curve, double level) {
+    const auto ratio =
+        curve.compressionRatio > 0 ? curve.compressionRatio : 1;
+    auto kneepoint = curve.kneepoint;
+    const auto limit = curve.broadbandOutputLimitingThreshold;
+    if (kneepoint + curve.kneepointGain > limit)
+        kneepoint = limit - curve.kneepointGain;
+    const auto kneepointOutput =
+        curve.kneepointGain + kneepoint * (1 - 1 / ratio);
+    const auto limitingInput = ratio * (limit - kneepointOutput);
+    if (level < kneepoint)
+        return curve.kneepointGain;
+    if (level > limitingInput)
+        return limit + (level - limitingInput) / 10 - level;
+    return (1 / ratio - 1) * level + kneepointOutput;
+}
+}
@@ -0,0 +1,197 @@
+#include "ControlRateCompressor.h"
+#include "Kernels.h"
+#include <algorithm>
+#include <cmath>
+
+namespace hearing_aid {
+static double smoothingCoefficient(
+    double milliseconds,
+    double sampleRate,
+    int interval
+) {
+    const auto samples = milliseconds * sampleRate / 1000;
+    return samples > 0 ? std::exp(-interval / samples) : 0;
+}
+
+static real_type amplitude(double decibels) {
+    return std::pow(10., decibels / 20);
+}
+
+GainTrajectory::GainTrajectory(const Parameters &p) :
+    curve{p.curve},
+    attackCoefficient{
+        smoothingCoefficient(p.attack, p.sampleRate, p.controlInterval)
+    },
+    releaseCoefficient{
+        smoothingCoefficient(p.release, p.sampleRate, p.controlInterval)
+    },
+    fullScaleLevel{p.fullScaleLevel},
+    gain_{amplitude(p.curve.kneepointGain)},
+    interval{p.controlInterval > 0 ? p.controlInterval : 1},
+    remaining{interval} {}
+
+real_type GainTrajectory::levelDecibels() const {
+    constexpr auto floor = 1e-20;
+    return 10 * std::log10(envelope > floor ? envelope : floor) +
+        fullScaleLevel;
+}
+
+void GainTrajectory::update() {
+    const auto coefficient =
+        peak > envelope ? attackCoefficient : releaseCoefficient;
+    envelope = coefficient * envelope + (1 - coefficient) * peak;
+    const auto target = amplitude(gainDecibels(curve, levelDecibels()));
+    step = (target - gain_) / interval;
+    peak = 0;
+    remaining = interval;
+}
+
+template<typename Ramp, typename Sample>
+void GainTrajectory::apply(
+    Ramp ramp,
+    const Sample *in,
+    Sample *out,
+    int count,
+    int stride
+) {
+    while (count > 0) {
+        const auto n = std::min(count, remaining);
+        peak = std::max(peak, ramp(in, out, n, gain_, step));
+        gain_ += static_cast<real_type>(n) * step;
+        in += stride * n;
+        out += stride * n;
+        count -= n;
+        remaining -= n;
+        if (remaining == 0)
+            update();
+    }
+}
+
+void GainTrajectory::applyToBand(
+    const complex_type *in,
+    complex_type *out,
+    int count
+) {
+    apply(kernels().rampBand, in, out, count, 2);
+}
+
+void GainTrajectory::applyToSignal(
+    const real_type *in,
+    real_type *out,
+    int count
+) {
+    apply(kernels().rampSignal, in, out, count, 1);
+}
+
+static double at(const std::vector<double> &v, int i) {
+    using size_type = std::vector<double>::size_type;
+    const auto n = gsl::narrow<size_type>(i);
+    return n < v.size() ? v[n] : 0;
+}
+
+static GainTrajectory::Parameters broadbandParameters(
+    const ControlRateCompressor::Parameters &p
+) {
+    GainTrajectory::Parameters broadband;
+    broadband.curve = p.broadband;
+    broadband.attack = p.broadbandAttack;
+    broadband.release = p.broadbandRelease;
+    broadband.sampleRate = p.sampleRate;
+    broadband.fullScaleLevel = p.fullScaleLevel;
+    broadband.controlInterval = p.controlInterval;
+    return broadband;
+}
+
+GainTrajectory::Parameters channelTrajectory(
+    const ControlRateCompressor::Parameters &p,
+    int channel
+) {
+    GainTrajectory::Parameters c;
+    c.curve.compressionRatio = at(p.compressionRatios, channel);
+    c.curve.kneepoint = at(p.kneepoints, channel);
+    c.curve.kneepointGain = at(p.kneepointGains, channel);
+    c.curve.broadbandOutputLimitingThreshold =
+        at(p.broadbandOutputLimitingThresholds, channel);
+    c.attack = p.attack;
+    c.release = p.release;
+    c.sampleRate = p.sampleRate;
+    c.fullScaleLevel = p.fullScaleLevel;
+    c.controlInterval = p.controlInterval;
+    return c;
+}
+
+ControlRateCompressor::ControlRateCompressor(
+    std::shared_ptr<SuperSignalProcessor> processor_,
+    const Parameters &p
+) :
+    inputGain{broadbandParameters(p)},
+    outputGain{broadbandParameters(p)},
+    processor{std::move(processor_)}
+{
+    for (int i = 0; i < processor->channels(); ++i)
+        channelGains.emplace_back(channelTrajectory(p, i));
+}
+
+void ControlRateCompressor::compressInput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    inputGain.applyToSignal(input.data(), output.data(), chunkSize);
+}
+
+void ControlRateCompressor::compressChannel(
+    complex_signal_type input,
+    complex_signal_type output,
+    int chunkSize
+) {
+    compressChannels(input, output, chunkSize, 0, channels());
+}
+
+void ControlRateCompressor::compressChannels(
+    complex_signal_type input,
+    complex_signal_type output,
+    int chunkSize,
+    int firstChannel,
+    int channelCount
+) {
+    auto in = input.data() + 2 * chunkSize * firstChannel;
+    auto out = output.data() + 2 * chunkSize * firstChannel;
+    for (int c = firstChannel; c < firstChannel + channelCount; ++c) {
+        channelGains[c].applyToBand(in, out, chunkSize);
+        in += 2 * chunkSize;
+        out += 2 * chunkSize;
+    }
+}
+
+void ControlRateCompressor::compressOutput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    outputGain.applyToSignal(input.data(), output.data(), chunkSize);
+}
+
+void ControlRateCompressor::feedbackCancelInput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    processor->feedbackCancelInput(input, output, chunkSize);
+}
+
+void ControlRateCompressor::feedbackCancelOutput(
+    real_signal_type input,
+    int chunkSize
+) {
+    processor->feedbackCancelOutput(input, chunkSize);
+}
+
+int ControlRateCompressor::chunkSize() {
+    return processor->chunkSize();
+}
+
+int ControlRateCompressor::channels() {
+    return processor->channels();
+}
+}
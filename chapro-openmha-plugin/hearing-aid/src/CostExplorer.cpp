@@ -0,0 +1,195 @@
+#include "CostExplorer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+
+namespace hearing_aid {
+CostExplorer::CostExplorer(SweepBackend *backend, const Parameters &p) :
+    p{p},
+    backend{backend} {}
+
+static void repeatFirst(std::vector<double> &v, int n) {
+    if (!v.empty())
+        v.assign(n, v.front());
+}
+
+HearingAidBuilder::Parameters CostExplorer::withBands(
+    HearingAidBuilder::Parameters fitting,
+    int bands
+) {
+    constexpr auto lowest = 250.;
+    const auto highest = fitting.sampleRate / 4;
+    fitting.crossFrequencies.clear();
+    for (int k = 0; k + 1 < bands; ++k)
+        fitting.crossFrequencies.push_back(
+            lowest * std::pow(highest / lowest, k / std::max(bands - 2., 1.))
+        );
+    repeatFirst(fitting.compressionRatios, bands);
+    repeatFirst(fitting.kneepoints, bands);
+    repeatFirst(fitting.kneepointGains, bands);
+    repeatFirst(fitting.broadbandOutputLimitingThresholds, bands);
+    return fitting;
+}
+
+CostExplorer::Result CostExplorer::evaluate(
+    const HearingAidBuilder::Parameters &fitting
+) {
+    const auto chunkSize = fitting.chunkSize;
+    if (chunkSize < 1 || fitting.sampleRate <= 0)
+        throw std::invalid_argument{
+            "chunk size and sample rate must be positive"
+        };
+    Result result{fitting, {}, 0};
+    const auto fragments = std::max(
+        gsl::narrow_cast<int>(
+            std::lround(p.seconds * fitting.sampleRate / chunkSize)
+        ),
+        1
+    );
+    // Uniform noise with the level's RMS.
+    const auto amplitude = std::sqrt(3.) *
+        std::pow(10., (p.level - fitting.fullScaleLevel) / 20);
+    std::uint32_t state = 1;
+    auto pipeline = backend->make(fitting);
+    std::vector<real_type> x(chunkSize);
+    for (int n = 0; n < fragments; ++n) {
+        for (auto &sample : x) {
+            state = state * 1664525U + 1013904223U;
+            sample = gsl::narrow_cast<real_type>(
+                amplitude * (state / 2147483648. - 1)
+            );
+        }
+        const auto start = std::chrono::steady_clock::now();
+        pipeline->process(x);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        if (n >= fragments / 10)
+            result.cost.record(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    elapsed
+                ).count()
+            );
+    }
+    result.load = result.cost.percentile(0.99) /
+        (1e9 * chunkSize / fitting.sampleRate);
+    return result;
+}
+
+namespace {
+using Fitting = HearingAidBuilder::Parameters;
+
+struct Dimension {
+    std::size_t candidates;
+    std::function<void(Fitting &, std::size_t)> set;
+};
+
+template<typename T>
+Dimension dimension(
+    const std::vector<T> &candidates,
+    std::function<void(Fitting &, const T &)> set
+) {
+    return {
+        candidates.size(),
+        [=](Fitting &fitting, std::size_t i) { set(fitting, candidates[i]); }
+    };
+}
+
+using Key = std::tuple<std::size_t, int, int, int, int, int, std::string>;
+
+Key key(const Fitting &f) {
+    return {
+        f.crossFrequencies.size(),
+        f.windowSize,
+        f.adaptiveFeedbackFilterLength,
+        f.signalWhiteningFilterLength,
+        f.persistentFeedbackFilterLength,
+        f.chunkSize,
+        f.filterType
+    };
+}
+}
+
+std::vector<CostExplorer::Result> CostExplorer::explore(
+    const HearingAidBuilder::Parameters &fitting,
+    const Space &space
+) {
+    const std::vector<Dimension> dimensions{
+        dimension<int>(space.bands, [](Fitting &f, const int &n) {
+            f = withBands(f, n);
+        }),
+        dimension<int>(space.windowSizes, [](Fitting &f, const int &n) {
+            f.windowSize = n;
+        }),
+        dimension<int>(
+            space.adaptiveFeedbackFilterLengths,
+            [](Fitting &f, const int &n) {
+                f.adaptiveFeedbackFilterLength = n;
+            }
+        ),
+        dimension<int>(
+            space.signalWhiteningFilterLengths,
+            [](Fitting &f, const int &n) {
+                f.signalWhiteningFilterLength = n;
+            }
+        ),
+        dimension<int>(
+            space.persistentFeedbackFilterLengths,
+            [](Fitting &f, const int &n) {
+                f.persistentFeedbackFilterLength = n;
+            }
+        ),
+        dimension<int>(space.chunkSizes, [](Fitting &f, const int &n) {
+            f.chunkSize = n;
+        }),
+        dimension<std::string>(
+            space.filterTypes,
+            [](Fitting &f, const std::string &t) { f.filterType = t; }
+        )
+    };
+    std::map<Key, Result> evaluated;
+    // The load of the fitting, evaluating it once; negative when it
+    // cannot be built.
+    const auto load = [&](const Fitting &f) {
+        const auto k = key(f);
+        const auto found = evaluated.find(k);
+        if (found != evaluated.end())
+            return found->second.load;
+        try {
+            return evaluated.emplace(k, evaluate(f)).first->second.load;
+        } catch (const std::exception &) {
+            return -1.;
+        }
+    };
+    auto worst = fitting;
+    auto worstLoad = load(worst);
+    for (int round = 0; round < p.rounds; ++round) {
+        auto changed = false;
+        for (const auto &d : dimensions)
+            for (std::size_t i = 0; i < d.candidates; ++i) {
+                auto candidate = worst;
+                d.set(candidate, i);
+                const auto candidateLoad = load(candidate);
+                if (candidateLoad > worstLoad) {
+                    worst = candidate;
+                    worstLoad = candidateLoad;
+                    changed = true;
+                }
+            }
+        if (!changed)
+            break;
+    }
+    std::vector<Result> ranked;
+    for (auto &entry : evaluated)
+        ranked.push_back(std::move(entry.second));
+    std::stable_sort(
+        ranked.begin(),
+        ranked.end(),
+        [](const Result &a, const Result &b) { return a.load > b.load; }
+    );
+    return ranked;
+}
+}
@@ -0,0 +1,122 @@
+#include "DenormalProtection.h"
+#if defined(__SSE__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#endif
+
+namespace hearing_aid {
+namespace {
+#if defined(__SSE__) || defined(__x86_64__)
+constexpr std::uintptr_t flushToZero = 0x8000;
+constexpr std::uintptr_t denormalsAreZero = 0x0040;
+
+std::uintptr_t mode() {
+    return _mm_getcsr();
+}
+
+void setMode(std::uintptr_t m) {
+    _mm_setcsr(static_cast<unsigned int>(m));
+}
+
+std::uintptr_t flushing(std::uintptr_t m) {
+    return m | flushToZero | denormalsAreZero;
+}
+
+constexpr auto hardwareFlush = true;
+#elif defined(__aarch64__)
+constexpr std::uintptr_t flushToZero = std::uintptr_t{1} << 24;
+
+std::uintptr_t mode() {
+    std::uintptr_t m;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(m));
+    return m;
+}
+
+void setMode(std::uintptr_t m) {
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(m));
+}
+
+std::uintptr_t flushing(std::uintptr_t m) {
+    return m | flushToZero;
+}
+
+constexpr auto hardwareFlush = true;
+#elif defined(__arm__) && defined(__ARM_FP)
+constexpr std::uintptr_t flushToZero = std::uintptr_t{1} << 24;
+
+std::uintptr_t mode() {
+    std::uintptr_t m;
+    __asm__ __volatile__("vmrs %0, fpscr" : "=r"(m));
+    return m;
+}
+
+void setMode(std::uintptr_t m) {
+    __asm__ __volatile__("vmsr fpscr, %0" : : "r"(m));
+}
+
+std::uintptr_t flushing(std::uintptr_t m) {
+    return m | flushToZero;
+}
+
+constexpr auto hardwareFlush = true;
+#else
+std::uintptr_t mode() {
+    return 0;
+}
+
+void setMode(std::uintptr_t) {}
+
+std::uintptr_t flushing(std::uintptr_t m) {
+    return m;
+}
+
+constexpr auto hardwareFlush = false;
+#endif
+
+constexpr real_type ditherLevel = 1e-15F;
+}
+
+FlushDenormalsToZero::FlushDenormalsToZero() : previous{mode()} {
+    setMode(flushing(previous));
+}
+
+FlushDenormalsToZero::~FlushDenormalsToZero() {
+    setMode(previous);
+}
+
+bool FlushDenormalsToZero::supported() {
+    return hardwareFlush;
+}
+
+DenormalProtectedHearingAid::DenormalProtectedHearingAid(
+    std::unique_ptr<SignalProcessor> processor_,
+    Mode mode
+) :
+    processor{std::move(processor_)},
+    mode_{mode} {}
+
+DenormalProtectedHearingAid::DenormalProtectedHearingAid(
+    std::unique_ptr<SignalProcessor> processor_
+) :
+    DenormalProtectedHearingAid{
+        std::move(processor_),
+        FlushDenormalsToZero::supported() ? Mode::flush : Mode::dither
+    } {}
+
+void DenormalProtectedHearingAid::process(real_signal_type signal) {
+    if (mode_ == Mode::flush) {
+        FlushDenormalsToZero guard;
+        processor->process(signal);
+        return;
+    }
+    for (auto &x : signal) {
+        state = 1664525 * state + 1013904223;
+        x += ditherLevel *
+            (static_cast<real_type>(state >> 8) / (1 << 23) - 1);
+    }
+    processor->process(signal);
+}
+
+DenormalProtectedHearingAid::Mode DenormalProtectedHearingAid::mode() const {
+    return mode_;
+}
+}
@@ -0,0 +1,229 @@
+#include "FeedbackLoopHost.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace hearing_aid {
+FeedbackLoopHost::FeedbackLoopHost(
+    SweepBackend *backend,
+    const Parameters &p
+) :
+    p{p},
+    backend{backend} {}
+
+static std::vector<real_type> pathAt(
+    const FeedbackLoopHost::Path &path,
+    int fragment
+) {
+    if (path.changedImpulseResponse.empty() || fragment < path.changeFragment)
+        return path.impulseResponse;
+    const auto progress = path.changeFragments > 0 ?
+        std::min(
+            1.,
+            (fragment - path.changeFragment + 1.) / path.changeFragments
+        ) :
+        1.;
+    const auto a = gsl::narrow_cast<real_type>(progress);
+    std::vector<real_type> h(
+        std::max(
+            path.impulseResponse.size(),
+            path.changedImpulseResponse.size()
+        )
+    );
+    for (std::vector<real_type>::size_type i = 0; i < h.size(); ++i) {
+        const auto before = i < path.impulseResponse.size() ?
+            path.impulseResponse[i] : 0;
+        const auto after = i < path.changedImpulseResponse.size() ?
+            path.changedImpulseResponse[i] : 0;
+        h[i] = (1 - a) * before + a * after;
+    }
+    return h;
+}
+
+static std::vector<real_type> loop(
+    SweepPipeline &pipeline,
+    const FeedbackLoopHost::Path *path,
+    const std::vector<real_type> &input,
+    int chunkSize,
+    double gain,
+    LatencyHistogram *cost
+) {
+    const auto fragments = chunkSize > 0 ?
+        gsl::narrow<int>(input.size()) / chunkSize : 0;
+    const auto forward = gsl::narrow_cast<real_type>(std::pow(10., gain / 20));
+    std::vector<real_type> output(
+        input.begin(),
+        input.begin() + fragments * chunkSize
+    );
+    std::vector<real_type> played(output.size());
+    std::vector<real_type> h;
+    for (int n = 0; n < fragments; ++n) {
+        const auto first = n * chunkSize;
+        if (path) {
+            h = pathAt(*path, n);
+            const auto delay = chunkSize + path->hardwareDelay;
+            for (int i = first; i < first + chunkSize; ++i) {
+                real_type feedback = 0;
+                const auto taps = std::min(
+                    gsl::narrow<int>(h.size()),
+                    i - delay + 1
+                );
+                for (int j = 0; j < taps; ++j)
+                    feedback += h[j] * played[i - delay - j];
+                output[i] += feedback;
+            }
+        }
+        const auto start = std::chrono::steady_clock::now();
+        pipeline.process({output.data() + first, chunkSize});
+        if (cost)
+            cost->record(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start
+                ).count()
+            );
+        for (int i = first; i < first + chunkSize; ++i)
+            played[i] = forward * output[i];
+    }
+    return output;
+}
+
+std::vector<real_type> FeedbackLoopHost::run(
+    const HearingAidBuilder::Parameters &fitting,
+    const std::vector<real_type> &input,
+    double gain,
+    LatencyHistogram *cost
+) {
+    return loop(
+        *backend->make(fitting),
+        &p.path,
+        input,
+        fitting.chunkSize,
+        gain,
+        cost
+    );
+}
+
+static double energy(
+    const std::vector<real_type> &x,
+    std::vector<real_type>::size_type first,
+    std::vector<real_type>::size_type last
+) {
+    double sum = 0;
+    for (auto i = first; i < last; ++i)
+        sum += double{x[i]} * x[i];
+    return sum;
+}
+
+static double decibels(double x) {
+    constexpr auto floor = 1e-20;
+    return 10 * std::log10(std::max(x, floor));
+}
+
+bool FeedbackLoopHost::stable(
+    const std::vector<real_type> &closed,
+    const std::vector<real_type> &open
+) const {
+    for (auto x : closed)
+        if (!std::isfinite(x))
+            return false;
+    const auto first = closed.size() - closed.size() / 4;
+    return decibels(energy(closed, first, closed.size())) -
+        decibels(energy(open, first, open.size())) <= p.howlMargin;
+}
+
+int FeedbackLoopHost::converged(
+    const std::vector<real_type> &closed,
+    const std::vector<real_type> &open,
+    int chunkSize,
+    int first,
+    int last
+) const {
+    const auto window = std::max(p.convergenceWindow, 1);
+    auto since = -1;
+    for (auto n = first; n + window <= last; n += window) {
+        double difference = 0;
+        for (auto i = n * chunkSize; i < (n + window) * chunkSize; ++i) {
+            const auto d = double{closed[i]} - open[i];
+            difference += d * d;
+        }
+        const auto reference = energy(
+            open,
+            gsl::narrow<std::vector<real_type>::size_type>(n * chunkSize),
+            gsl::narrow<std::vector<real_type>::size_type>(
+                (n + window) * chunkSize
+            )
+        );
+        const auto below = std::isfinite(difference) &&
+            decibels(difference) - decibels(reference) <
+                p.convergenceThreshold;
+        if (!below)
+            since = -1;
+        else if (since < 0)
+            since = n;
+    }
+    return since;
+}
+
+FeedbackLoopHost::Result FeedbackLoopHost::evaluate(
+    const HearingAidBuilder::Parameters &fitting,
+    const std::vector<real_type> &input
+) {
+    Result result{};
+    const auto chunkSize = fitting.chunkSize;
+    const auto fragments = chunkSize > 0 ?
+        gsl::narrow<int>(input.size()) / chunkSize : 0;
+    auto withoutFeedback = fitting;
+    withoutFeedback.feedback = name(Feedback::off);
+    const auto open = loop(
+        *backend->make(withoutFeedback),
+        nullptr,
+        input,
+        chunkSize,
+        0,
+        nullptr
+    );
+    const auto closed = run(fitting, input, 0, &result.cost);
+    result.stable = stable(closed, open);
+    const auto changes = !p.path.changedImpulseResponse.empty() &&
+        p.path.changeFragment < fragments;
+    result.convergence = converged(
+        closed,
+        open,
+        chunkSize,
+        0,
+        changes ? p.path.changeFragment : fragments
+    );
+    result.reconvergence = -1;
+    if (changes) {
+        const auto n = converged(
+            closed,
+            open,
+            chunkSize,
+            p.path.changeFragment,
+            fragments
+        );
+        if (n >= 0)
+            result.reconvergence = n - p.path.changeFragment;
+    }
+
+    auto low = p.minimumGain;
+    auto high = p.maximumGain;
+    if (!stable(run(fitting, input, low), open))
+        result.maximumStableGain = std::numeric_limits<double>::quiet_NaN();
+    else if (stable(run(fitting, input, high), open))
+        result.maximumStableGain = high;
+    else {
+        const auto resolution = std::max(p.gainResolution, 1e-3);
+        while (high - low > resolution) {
+            const auto middle = (low + high) / 2;
+            if (stable(run(fitting, input, middle), open))
+                low = middle;
+            else
+                high = middle;
+        }
+        result.maximumStableGain = low;
+    }
+    return result;
+}
+}
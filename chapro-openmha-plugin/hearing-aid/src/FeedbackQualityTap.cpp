@@ -0,0 +1,67 @@
+#include "FeedbackQualityTap.h"
+
+namespace hearing_aid {
+FeedbackQualityTap::FeedbackQualityTap(
+    std::shared_ptr<SuperSignalProcessor> processor,
+    std::shared_ptr<FeedbackMonitor> monitor,
+    int capacity
+) :
+    ring(gsl::narrow<std::size_t>(capacity)),
+    processor{std::move(processor)},
+    monitor{std::move(monitor)} {}
+
+void FeedbackQualityTap::feedbackCancelInput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    processor->feedbackCancelInput(input, output, chunkSize);
+}
+
+void FeedbackQualityTap::compressInput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    processor->compressInput(input, output, chunkSize);
+}
+
+void FeedbackQualityTap::compressChannel(
+    complex_signal_type input,
+    complex_signal_type output,
+    int chunkSize
+) {
+    processor->compressChannel(input, output, chunkSize);
+}
+
+void FeedbackQualityTap::compressOutput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    processor->compressOutput(input, output, chunkSize);
+}
+
+void FeedbackQualityTap::feedbackCancelOutput(
+    real_signal_type input,
+    int chunkSize
+) {
+    processor->feedbackCancelOutput(input, chunkSize);
+    auto quality = monitor->feedbackQuality();
+    quality.fragment = fragment++;
+    if (!ring.push(quality))
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+int FeedbackQualityTap::chunkSize() {
+    return processor->chunkSize();
+}
+
+int FeedbackQualityTap::channels() {
+    return processor->channels();
+}
+
+int FeedbackQualityTap::dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+}
+}
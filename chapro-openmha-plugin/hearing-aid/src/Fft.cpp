@@ -0,0 +1,97 @@
+#include "Fft.h"
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace hearing_aid {
+bool isPowerOfTwo(int n) {
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+static spectrum_type rootOfUnity(int k, int n) {
+    const auto pi = std::acos(-1.);
+    const auto phase = -2 * pi * k / n;
+    return {
+        static_cast<real_type>(std::cos(phase)),
+        static_cast<real_type>(std::sin(phase))
+    };
+}
+
+Fft::Fft(int size) : size_{size} {
+    if (!isPowerOfTwo(size) || size < 2)
+        throw std::invalid_argument{"FFT size must be a power of two"};
+    const auto half = size / 2;
+    for (int k = 0; k < half / 2; ++k)
+        halfTwiddles.push_back(rootOfUnity(k, half));
+    for (int k = 0; k <= half; ++k)
+        twiddles.push_back(rootOfUnity(k, size));
+    work.resize(half);
+    bitReversed.resize(half);
+    int bits = 0;
+    while ((1 << bits) < half)
+        ++bits;
+    for (int i = 0; i < half; ++i) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b)
+            if (i & (1 << b))
+                reversed |= 1 << (bits - 1 - b);
+        bitReversed[i] = reversed;
+    }
+}
+
+void Fft::transform(bool inverse_) {
+    const auto n = static_cast<int>(work.size());
+    for (int i = 0; i < n; ++i)
+        if (i < bitReversed[i])
+            std::swap(work[i], work[bitReversed[i]]);
+    for (int length = 2; length <= n; length *= 2) {
+        const auto stride = n / length;
+        for (int start = 0; start < n; start += length)
+            for (int k = 0; k < length / 2; ++k) {
+                auto w = halfTwiddles[k * stride];
+                if (inverse_)
+                    w = std::conj(w);
+                const auto even = work[start + k];
+                const auto odd = multiply(w, work[start + k + length / 2]);
+                work[start + k] = even + odd;
+                work[start + k + length / 2] = even - odd;
+            }
+    }
+}
+
+void Fft::forward(real_signal_type input, spectrum_signal_type output) {
+    const auto half = size_ / 2;
+    for (int i = 0; i < half; ++i)
+        work[i] = {input[2 * i], input[2 * i + 1]};
+    transform(false);
+    for (int k = 0; k <= half; ++k) {
+        const auto z = work[k % half];
+        const auto zc = std::conj(work[(half - k) % half]);
+        const auto even = real_type{0.5} * (z + zc);
+        const auto difference = z - zc;
+        const spectrum_type odd{
+            real_type{0.5} * difference.imag(),
+            real_type{-0.5} * difference.real()
+        };
+        output[k] = even + multiply(twiddles[k], odd);
+    }
+}
+
+void Fft::inverse(spectrum_signal_type input, real_signal_type output) {
+    const auto half = size_ / 2;
+    for (int k = 0; k < half; ++k) {
+        const auto x = input[k];
+        const auto xc = std::conj(input[half - k]);
+        const auto even = real_type{0.5} * (x + xc);
+        const auto odd =
+            multiplyConjugate(twiddles[k], real_type{0.5} * (x - xc));
+        work[k] = even + spectrum_type{-odd.imag(), odd.real()};
+    }
+    transform(true);
+    const auto scale = real_type{1} / half;
+    for (int i = 0; i < half; ++i) {
+        output[2 * i] = work[i].real() * scale;
+        output[2 * i + 1] = work[i].imag() * scale;
+    }
+}
+}
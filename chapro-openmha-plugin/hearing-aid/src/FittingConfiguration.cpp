@@ -0,0 +1,99 @@
+#include "FittingConfiguration.h"
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace hearing_aid {
+namespace {
+std::string trimmed(const std::string &s) {
+    const auto first = s.find_first_not_of(" \t\r");
+    if (first == std::string::npos)
+        return {};
+    return s.substr(first, s.find_last_not_of(" \t\r") - first + 1);
+}
+
+std::vector<double> numbers(std::string s) {
+    for (auto &c : s)
+        if (c == '[' || c == ']' || c == ',')
+            c = ' ';
+    std::istringstream stream{s};
+    std::vector<double> v;
+    double x;
+    while (stream >> x)
+        v.push_back(x);
+    return v;
+}
+
+class Configuration {
+    std::map<std::string, std::string> v;
+public:
+    explicit Configuration(std::istream &in) {
+        std::string line;
+        while (std::getline(in, line)) {
+            const auto equals = line.find('=');
+            if (line.empty() || line[0] == '#' || equals == std::string::npos)
+                continue;
+            const auto key = trimmed(line.substr(0, equals));
+            v[key.substr(key.rfind('.') + 1)] =
+                trimmed(line.substr(equals + 1));
+        }
+    }
+
+    std::string text(const std::string &key, const std::string &fallback) {
+        const auto found = v.find(key);
+        return found == v.end() ? fallback : found->second;
+    }
+
+    double number(const std::string &key, double fallback) {
+        const auto x = numbers(text(key, ""));
+        return x.empty() ? fallback : x.front();
+    }
+
+    int integer(const std::string &key, int fallback) {
+        return static_cast<int>(number(key, fallback));
+    }
+
+    std::vector<double> list(const std::string &key) {
+        return numbers(text(key, ""));
+    }
+};
+}
+
+HearingAidBuilder::Parameters readFitting(std::istream &in) {
+    Configuration c{in};
+    HearingAidBuilder::Parameters p{};
+    p.sampleRate = c.number("srate", 44100);
+    p.chunkSize = c.integer("fragsize", 64);
+    p.crossFrequencies = c.list("cross_freq");
+    p.compressionRatios = c.list("cr");
+    p.kneepoints = c.list("tk");
+    p.kneepointGains = c.list("tkgain");
+    p.broadbandOutputLimitingThresholds = c.list("bolt");
+    p.filterType = c.text("filter_type", "IIR");
+    p.feedback = c.text("feedback_management", "yes");
+    p.feedbackEngine = c.text("afc_engine", "time");
+    p.attack = c.number("attack", 0);
+    p.release = c.number("release", 0);
+    p.fullScaleLevel = c.number("maxdB", 0);
+    p.filterEstimationStepSize = c.number("mu", 0);
+    p.filterEstimationForgettingFactor = c.number("rho", 0);
+    p.filterEstimationPowerThreshold = c.number("eps", 0);
+    p.feedbackGain = c.number("fbg", 0);
+    p.adaptiveFeedbackFilterLength = c.integer("afl", 0);
+    p.signalWhiteningFilterLength = c.integer("wfl", 0);
+    p.persistentFeedbackFilterLength = c.integer("pfl", 0);
+    p.hardwareLatency = c.integer("hdel", 0);
+    p.windowSize = c.integer("nw", 0);
+    p.controlInterval = c.integer("agc_interval", 0);
+    return p;
+}
+
+HearingAidBuilder::Parameters readFitting(const std::string &path) {
+    std::ifstream file{path};
+    if (!file)
+        throw std::runtime_error{"cannot read " + path};
+    return readFitting(file);
+}
+}
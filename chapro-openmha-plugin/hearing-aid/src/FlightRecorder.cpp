@@ -0,0 +1,353 @@
+#include "FlightRecorder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace hearing_aid {
+const char *name(Stage s) {
+    switch (s) {
+        case Stage::feedbackCancelInput:
+            return "feedbackCancelInput";
+        case Stage::compressInput:
+            return "compressInput";
+        case Stage::filterbankAnalyze:
+            return "filterbankAnalyze";
+        case Stage::compressChannel:
+            return "compressChannel";
+        case Stage::filterbankSynthesize:
+            return "filterbankSynthesize";
+        case Stage::compressOutput:
+            return "compressOutput";
+        case Stage::feedbackCancelOutput:
+            return "feedbackCancelOutput";
+    }
+    return "";
+}
+
+static std::int64_t nanoseconds(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+StageTimer::StageTimer(
+    std::shared_ptr<SuperSignalProcessor> processor,
+    std::shared_ptr<Filter> filter
+) :
+    processor{std::move(processor)},
+    filter{std::move(filter)} {}
+
+template<typename F>
+void StageTimer::time(Stage s, F &&f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    elapsed[static_cast<int>(s)] +=
+        nanoseconds(std::chrono::steady_clock::now() - start);
+}
+
+void StageTimer::feedbackCancelInput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    time(Stage::feedbackCancelInput, [&] {
+        processor->feedbackCancelInput(input, output, chunkSize);
+    });
+}
+
+void StageTimer::compressInput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    time(Stage::compressInput, [&] {
+        processor->compressInput(input, output, chunkSize);
+    });
+}
+
+void StageTimer::filterbankAnalyze(
+    real_signal_type input,
+    complex_signal_type output,
+    int chunkSize
+) {
+    time(Stage::filterbankAnalyze, [&] {
+        filter->filterbankAnalyze(input, output, chunkSize);
+    });
+}
+
+void StageTimer::compressChannel(
+    complex_signal_type input,
+    complex_signal_type output,
+    int chunkSize
+) {
+    time(Stage::compressChannel, [&] {
+        processor->compressChannel(input, output, chunkSize);
+    });
+}
+
+void StageTimer::filterbankSynthesize(
+    complex_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    time(Stage::filterbankSynthesize, [&] {
+        filter->filterbankSynthesize(input, output, chunkSize);
+    });
+}
+
+void StageTimer::compressOutput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    time(Stage::compressOutput, [&] {
+        processor->compressOutput(input, output, chunkSize);
+    });
+}
+
+void StageTimer::feedbackCancelOutput(real_signal_type input, int chunkSize) {
+    time(Stage::feedbackCancelOutput, [&] {
+        processor->feedbackCancelOutput(input, chunkSize);
+    });
+}
+
+int StageTimer::chunkSize() {
+    return processor->chunkSize();
+}
+
+int StageTimer::channels() {
+    return processor->channels();
+}
+
+StageTimer::Durations StageTimer::take() {
+    const auto d = elapsed;
+    elapsed = {};
+    return d;
+}
+
+static int fragmentsIn(const FlightRecorder::Parameters &p) {
+    const auto chunkSize = std::max(p.chunkSize, 1);
+    return std::max(
+        gsl::narrow_cast<int>(std::ceil(p.seconds * p.sampleRate / chunkSize)),
+        1
+    );
+}
+
+// Twice the history, so the fragments being dumped are not overwritten
+// while the dumper copies them.
+FlightRecorder::FlightRecorder(
+    std::unique_ptr<SignalProcessor> processor,
+    std::shared_ptr<StageTimer> stageTimer,
+    const Parameters &p
+) :
+    p{p},
+    history{fragmentsIn(p)},
+    capacity{2 * history},
+    inputs(gsl::narrow<std::size_t>(capacity * std::max(p.chunkSize, 0))),
+    outputs(inputs.size()),
+    fragments(gsl::narrow<std::size_t>(capacity)),
+    processor{std::move(processor)},
+    stageTimer{std::move(stageTimer)},
+    origin{std::chrono::steady_clock::now()},
+    deadline{
+        static_cast<std::int64_t>(
+            1e9 * p.deadline * p.chunkSize / p.sampleRate
+        )
+    },
+    dumper{[this] { dumpWhenTriggered(); }} {}
+
+FlightRecorder::~FlightRecorder() {
+    stopping.store(true, std::memory_order_release);
+    dumper.join();
+}
+
+static bool finite(const real_type *x, int n) {
+    for (int i = 0; i < n; ++i)
+        if (!std::isfinite(x[i]))
+            return false;
+    return true;
+}
+
+static bool clipped(const real_type *x, int n, real_type level) {
+    for (int i = 0; i < n; ++i)
+        if (std::abs(x[i]) >= level)
+            return true;
+    return false;
+}
+
+void FlightRecorder::process(real_signal_type signal) {
+    const auto chunkSize = p.chunkSize;
+    if (signal.size() != chunkSize) {
+        processor->process(signal);
+        return;
+    }
+    const auto index = written.load(std::memory_order_relaxed);
+    const auto slot = gsl::narrow_cast<int>(index % capacity);
+    const auto input = inputs.data() + slot * chunkSize;
+    const auto output = outputs.data() + slot * chunkSize;
+    std::copy(signal.begin(), signal.end(), input);
+    const auto start = std::chrono::steady_clock::now();
+    processor->process(signal);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    std::copy(signal.begin(), signal.end(), output);
+    auto &fragment = fragments[slot];
+    fragment.stages = stageTimer ? stageTimer->take() : StageTimer::Durations{};
+    fragment.index = index;
+    fragment.start = nanoseconds(start - origin);
+    fragment.elapsed = nanoseconds(elapsed);
+    fragment.events = 0;
+    if (fragment.elapsed > deadline)
+        fragment.events |= overrun;
+    if (!finite(input, chunkSize) || !finite(output, chunkSize))
+        fragment.events |= notFinite;
+    if (clipped(output, chunkSize, p.clippingLevel))
+        fragment.events |= clipping;
+    written.store(index + 1, std::memory_order_release);
+    if (fragment.events != 0) {
+        events_.fetch_add(1, std::memory_order_relaxed);
+        std::int64_t idle = -1;
+        if (index >= holdoffEnd && triggers < p.maxDumps &&
+            trigger.compare_exchange_strong(idle, index)) {
+            holdoffEnd = index + history;
+            ++triggers;
+        } else {
+            suppressed_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void FlightRecorder::dumpWhenTriggered() {
+    while (!stopping.load(std::memory_order_acquire)) {
+        const auto last = trigger.load(std::memory_order_acquire);
+        if (last < 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+            continue;
+        }
+        dump(last);
+        trigger.store(-1, std::memory_order_release);
+    }
+}
+
+static void writeBytes(std::ofstream &file, std::uint32_t x, int bytes) {
+    for (int i = 0; i < bytes; ++i)
+        file.put(static_cast<char>((x >> (8 * i)) & 0xFF));
+}
+
+// Two-channel IEEE float WAV, interleaved.
+static void writeWav(
+    const std::string &path,
+    const std::vector<real_type> &left,
+    const std::vector<real_type> &right,
+    double sampleRate
+) {
+    std::ofstream file{path, std::ios::binary};
+    const auto samples = gsl::narrow<std::uint32_t>(2 * left.size());
+    const auto dataBytes = 4 * samples;
+    const auto rate = static_cast<std::uint32_t>(std::lround(sampleRate));
+    file.write("RIFF", 4);
+    writeBytes(file, 36 + dataBytes, 4);
+    file.write("WAVEfmt ", 8);
+    writeBytes(file, 16, 4);
+    writeBytes(file, 3, 2);
+    writeBytes(file, 2, 2);
+    writeBytes(file, rate, 4);
+    writeBytes(file, 8 * rate, 4);
+    writeBytes(file, 8, 2);
+    writeBytes(file, 32, 2);
+    file.write("data", 4);
+    writeBytes(file, dataBytes, 4);
+    static_assert(sizeof(real_type) == sizeof(std::uint32_t));
+    for (std::size_t i = 0; i < left.size(); ++i)
+        for (auto x : {left[i], right[i]}) {
+            std::uint32_t bits;
+            std::memcpy(&bits, &x, sizeof bits);
+            writeBytes(file, bits, 4);
+        }
+}
+
+static std::string eventNames(unsigned events) {
+    std::string names;
+    const std::pair<unsigned, const char *> all[]{
+        {FlightRecorder::overrun, "overrun"},
+        {FlightRecorder::notFinite, "notFinite"},
+        {FlightRecorder::clipping, "clipping"}
+    };
+    for (auto [event, eventName] : all)
+        if (events & event)
+            names += (names.empty() ? "" : "|") + std::string{eventName};
+    return names;
+}
+
+void FlightRecorder::dump(std::int64_t last) {
+    const auto chunkSize = p.chunkSize;
+    const auto first = std::max(last - history + 1, std::int64_t{0});
+    std::vector<Fragment> copied;
+    std::vector<real_type> input;
+    std::vector<real_type> output;
+    for (auto index = first; index <= last; ++index) {
+        const auto slot = gsl::narrow_cast<int>(index % capacity);
+        copied.push_back(fragments[slot]);
+        input.insert(
+            input.end(),
+            inputs.begin() + slot * chunkSize,
+            inputs.begin() + (slot + 1) * chunkSize
+        );
+        output.insert(
+            output.end(),
+            outputs.begin() + slot * chunkSize,
+            outputs.begin() + (slot + 1) * chunkSize
+        );
+    }
+    // Drops whatever the audio thread overwrote, or may have been
+    // overwriting, during the copy.
+    const auto valid = written.load(std::memory_order_acquire) - capacity + 1;
+    if (valid > first) {
+        const auto stale = gsl::narrow<std::size_t>(
+            std::min(valid, last + 1) - first
+        );
+        copied.erase(copied.begin(), copied.begin() + stale);
+        input.erase(input.begin(), input.begin() + stale * chunkSize);
+        output.erase(output.begin(), output.begin() + stale * chunkSize);
+    }
+
+    const auto path = p.path + std::to_string(dumps_.load() + 1);
+    writeWav(path + ".wav", input, output, p.sampleRate);
+    std::ofstream csv{path + ".csv"};
+    csv << "fragment,start_ns,elapsed_ns";
+    for (int s = 0; s < stageCount; ++s)
+        csv << ',' << name(static_cast<Stage>(s)) << "_ns";
+    csv << ",events\n";
+    for (const auto &fragment : copied) {
+        csv << fragment.index << ',' << fragment.start << ','
+            << fragment.elapsed;
+        for (auto d : fragment.stages)
+            csv << ',' << d;
+        csv << ',' << eventNames(fragment.events) << '\n';
+    }
+    {
+        std::lock_guard<std::mutex> lock{lastDumpMutex};
+        lastDump_ = path;
+    }
+    dumps_.fetch_add(1, std::memory_order_release);
+}
+
+int FlightRecorder::historyFragments() const {
+    return history;
+}
+
+int FlightRecorder::suppressed() const {
+    return suppressed_.load(std::memory_order_relaxed);
+}
+
+int FlightRecorder::dumps() const {
+    return dumps_.load(std::memory_order_acquire);
+}
+
+int FlightRecorder::events() const {
+    return events_.load(std::memory_order_relaxed);
+}
+
+std::string FlightRecorder::lastDump() const {
+    std::lock_guard<std::mutex> lock{lastDumpMutex};
+    return lastDump_;
+}
+}
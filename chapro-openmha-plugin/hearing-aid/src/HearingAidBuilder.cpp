@@ -1,20 +1,96 @@
 #include "HearingAidBuilder.h"
+#include <cmath>
+#include <tuple>
 
 namespace hearing_aid {
+static auto filterInputs(const HearingAidBuilder::Parameters &p) {
+    return std::tie(
+        p.filterType,
+        p.crossFrequencies,
+        p.sampleRate,
+        p.windowSize,
+        p.chunkSize
+    );
+}
+
+// CHAPRO's feedback management and AGC use the chunk size and sample
+// rate the filterbank was initialized with, so they are inputs of all
+// three components.
+static auto feedbackInputs(const HearingAidBuilder::Parameters &p) {
+    return std::tie(
+        p.sampleRate,
+        p.chunkSize,
+        p.feedback,
+        p.feedbackEngine,
+        p.feedbackGain,
+        p.filterEstimationForgettingFactor,
+        p.filterEstimationPowerThreshold,
+        p.filterEstimationStepSize,
+        p.adaptiveFeedbackFilterLength,
+        p.signalWhiteningFilterLength,
+        p.persistentFeedbackFilterLength,
+        p.hardwareLatency,
+        p.saveQualityMetric,
+        p.qualityMetricLength
+    );
+}
+
+static auto automaticGainControlInputs(
+    const HearingAidBuilder::Parameters &p
+) {
+    return std::tie(
+        p.crossFrequencies,
+        p.compressionRatios,
+        p.kneepoints,
+        p.kneepointGains,
+        p.broadbandOutputLimitingThresholds,
+        p.attack,
+        p.release,
+        p.sampleRate,
+        p.chunkSize,
+        p.fullScaleLevel
+    );
+}
+
 void HearingAidBuilder::build(const Parameters &p) {
-    prepareFilter(p);
-    prepareFeedbackManagement(p);
-    prepareAutomaticGainControl(p);
+    const auto changed = [&](auto inputs) {
+        return !built || inputs(*built) != inputs(p);
+    };
+    const auto filterChanged = changed(filterInputs);
+    const auto feedbackChanged = changed(feedbackInputs);
+    const auto automaticGainControlChanged =
+        changed(automaticGainControlInputs);
+    if (built) {
+        if (automaticGainControlChanged)
+            initializer->releaseAutomaticGainControl();
+        if (feedbackChanged)
+            initializer->releaseFeedbackManagement();
+        if (filterChanged)
+            initializer->releaseFilter();
+    }
+    if (filterChanged)
+        prepareFilter(p);
+    prepareFeedbackManagement(p, feedbackChanged);
+    prepareAutomaticGainControl(p, automaticGainControlChanged);
+    prepareControlRateCompressor(p);
+    prepareActivityGate(p);
+    built = p;
+}
+
+void HearingAidBuilder::invalidate() {
+    built.reset();
 }
 
 void HearingAidBuilder::prepareFilter(const Parameters &p) {
     if (p.filterType == name(FilterType::fir))
         buildFirFilter(p);
+    else if (p.filterType == name(FilterType::minimumPhaseFir))
+        buildMinimumPhaseFirFilter(p);
     else
         buildIirFilter(p);
 }
 
-void HearingAidBuilder::buildFirFilter(const Parameters &p) {
+void HearingAidBuilder::initializeFirFilter(const Parameters &p) {
     HearingAidInitializer::FirParameters firParameters;
     firParameters.crossFrequencies = p.crossFrequencies;
     firParameters.channels = channels(p);
@@ -22,9 +98,24 @@ void HearingAidBuilder::buildFirFilter(const Parameters &p) {
     firParameters.windowSize = p.windowSize;
     firParameters.chunkSize = p.chunkSize;
     initializer->initializeFirFilter(firParameters);
+}
+
+void HearingAidBuilder::buildFirFilter(const Parameters &p) {
+    initializeFirFilter(p);
     filter_ = filterFactory->makeFir();
 }
 
+// Analysis and synthesis both run in this tree, so the backend's FIR
+// filterbank is not initialized.
+void HearingAidBuilder::buildMinimumPhaseFirFilter(const Parameters &p) {
+    MinimumPhaseFilterbank::Parameters filterbank;
+    filterbank.crossFrequencies = p.crossFrequencies;
+    filterbank.sampleRate = p.sampleRate;
+    filterbank.windowSize = p.windowSize;
+    filterbank.chunkSize = p.chunkSize;
+    filter_ = std::make_shared<MinimumPhaseFilterbank>(filterbank);
+}
+
 int HearingAidBuilder::channels(const Parameters &p) {
     return p.crossFrequencies.size() + 1;
 }
@@ -39,7 +130,10 @@ void HearingAidBuilder::buildIirFilter(const Parameters &p) {
     filter_ = filterFactory->makeIir();
 }
 
-void HearingAidBuilder::prepareFeedbackManagement(const Parameters &p) {
+void HearingAidBuilder::prepareFeedbackManagement(
+    const Parameters &p,
+    bool initialize
+) {
     HearingAidInitializer::FeedbackManagement feedbackManagement;
     feedbackManagement.filterEstimationForgettingFactor =
         p.filterEstimationForgettingFactor;
@@ -52,19 +146,43 @@ void HearingAidBuilder::prepareFeedbackManagement(const Parameters &p) {
         p.persistentFeedbackFilterLength;
     feedbackManagement.hardwareLatency = p.hardwareLatency;
     feedbackManagement.saveQualityMetric = p.saveQualityMetric;
-    if (p.feedback == name(Feedback::on)) {
+    feedbackManagement.qualityMetricLength = p.qualityMetricLength;
+    feedbackCanceller.adaptiveFilterLength = 0;
+    if (p.feedback != name(Feedback::on)) {
+        feedbackManagement.gain = 0;
+        feedbackManagement.adaptiveFilterLength = 0;
+    } else if (p.feedbackEngine == name(FeedbackEngine::frequencyDomain)) {
+        feedbackManagement.gain = 0;
+        feedbackManagement.adaptiveFilterLength = 0;
+        prepareFrequencyDomainFeedbackCanceller(p);
+    } else {
         feedbackManagement.gain = p.feedbackGain;
         feedbackManagement.adaptiveFilterLength =
             p.adaptiveFeedbackFilterLength;
-    } else {
-        feedbackManagement.gain = 0;
-        feedbackManagement.adaptiveFilterLength = 0;
     }
 
-    initializer->initializeFeedbackManagement(feedbackManagement);
+    if (initialize)
+        initializer->initializeFeedbackManagement(feedbackManagement);
 }
 
-void HearingAidBuilder::prepareAutomaticGainControl(const Parameters &p) {
+void HearingAidBuilder::prepareFrequencyDomainFeedbackCanceller(
+    const Parameters &p
+) {
+    feedbackCanceller.filterEstimationForgettingFactor =
+        p.filterEstimationForgettingFactor;
+    feedbackCanceller.filterEstimationPowerThreshold =
+        p.filterEstimationPowerThreshold;
+    feedbackCanceller.filterEstimationStepSize = p.filterEstimationStepSize;
+    feedbackCanceller.adaptiveFilterLength = p.adaptiveFeedbackFilterLength;
+    feedbackCanceller.hardwareLatency = p.hardwareLatency;
+}
+
+void HearingAidBuilder::prepareAutomaticGainControl(
+    const Parameters &p,
+    bool initialize
+) {
+    if (!initialize)
+        return;
     HearingAidInitializer::AutomaticGainControl automaticGainControl;
     automaticGainControl.crossFrequencies = p.crossFrequencies;
     automaticGainControl.channels = channels(p);
@@ -80,7 +198,51 @@ void HearingAidBuilder::prepareAutomaticGainControl(const Parameters &p) {
     initializer->initializeAutomaticGainControl(automaticGainControl);
 }
 
+void HearingAidBuilder::prepareControlRateCompressor(const Parameters &p) {
+    compressor.compressionRatios = p.compressionRatios;
+    compressor.kneepoints = p.kneepoints;
+    compressor.kneepointGains = p.kneepointGains;
+    compressor.broadbandOutputLimitingThresholds =
+        p.broadbandOutputLimitingThresholds;
+    compressor.broadband.kneepointGain = 0;
+    compressor.broadband.kneepoint = 105;
+    compressor.broadband.compressionRatio = 10;
+    compressor.broadband.broadbandOutputLimitingThreshold = 105;
+    compressor.attack = p.attack;
+    compressor.release = p.release;
+    compressor.broadbandAttack = 1;
+    compressor.broadbandRelease = 50;
+    compressor.sampleRate = p.sampleRate;
+    compressor.fullScaleLevel = p.fullScaleLevel;
+    compressor.controlInterval = p.controlInterval;
+}
+
+void HearingAidBuilder::prepareActivityGate(const Parameters &p) {
+    activityGate.silenceLevel = p.silenceLevel;
+    activityGate.fullScaleLevel = p.fullScaleLevel;
+    const auto fragmentMilliseconds = 1000. * p.chunkSize / p.sampleRate;
+    activityGate.holdFragments = fragmentMilliseconds > 0
+        ? static_cast<int>(std::ceil(p.silenceHold / fragmentMilliseconds))
+        : 1;
+    activityGate.updateInterval = p.silenceUpdateInterval;
+}
+
 std::shared_ptr<Filter> HearingAidBuilder::filter() {
     return filter_;
 }
+
+std::shared_ptr<SuperSignalProcessor> HearingAidBuilder::processor(
+    std::shared_ptr<SuperSignalProcessor> p
+) {
+    if (feedbackCanceller.adaptiveFilterLength > 0)
+        p = std::make_shared<PartitionedBlockFeedbackCanceller>(
+            std::move(p),
+            feedbackCanceller
+        );
+    if (compressor.controlInterval > 0)
+        p = std::make_shared<ControlRateCompressor>(std::move(p), compressor);
+    if (activityGate.silenceLevel > 0)
+        p = ActivityGate::make(std::move(p), activityGate);
+    return p;
+}
 }
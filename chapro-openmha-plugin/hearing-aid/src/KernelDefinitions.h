@@ -0,0 +1,135 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_SRC_KERNELDEFINITIONS_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_SRC_KERNELDEFINITIONS_H_
+
+#include "KernelLevels.h"
+
+// Included by one translation unit per instruction-set level, each built
+// with that level's target flags. The loops are written for the
+// compiler's vectorizer; the definitions have internal linkage so every
+// level keeps its own copy.
+namespace hearing_aid { namespace {
+// std::complex arrays may be accessed as interleaved real arrays.
+const real_type *interleaved(const spectrum_type *x) {
+    return reinterpret_cast<const real_type *>(x);
+}
+
+real_type *interleaved(spectrum_type *x) {
+    return reinterpret_cast<real_type *>(x);
+}
+
+void multiplyAccumulate(
+    const spectrum_type *a_,
+    const spectrum_type *b_,
+    spectrum_type *sum_,
+    int n
+) {
+    const auto a = interleaved(a_);
+    const auto b = interleaved(b_);
+    const auto sum = interleaved(sum_);
+#pragma omp simd
+    for (int k = 0; k < n; ++k) {
+        const auto ar = a[2 * k];
+        const auto ai = a[2 * k + 1];
+        const auto br = b[2 * k];
+        const auto bi = b[2 * k + 1];
+        sum[2 * k] += ar * br - ai * bi;
+        sum[2 * k + 1] += ar * bi + ai * br;
+    }
+}
+
+void normalizedCorrelation(
+    const spectrum_type *x_,
+    const spectrum_type *e_,
+    const real_type *power,
+    real_type threshold,
+    spectrum_type *g_,
+    int n
+) {
+    const auto x = interleaved(x_);
+    const auto e = interleaved(e_);
+    const auto g = interleaved(g_);
+#pragma omp simd
+    for (int k = 0; k < n; ++k) {
+        const auto xr = x[2 * k];
+        const auto xi = x[2 * k + 1];
+        const auto er = e[2 * k];
+        const auto ei = e[2 * k + 1];
+        const auto scale = 1 / (power[k] + threshold);
+        g[2 * k] = (xr * er + xi * ei) * scale;
+        g[2 * k + 1] = (xr * ei - xi * er) * scale;
+    }
+}
+
+void scaledAccumulate(
+    const spectrum_type *g_,
+    real_type scale,
+    spectrum_type *w_,
+    int n
+) {
+    const auto g = interleaved(g_);
+    const auto w = interleaved(w_);
+#pragma omp simd
+    for (int i = 0; i < 2 * n; ++i)
+        w[i] += scale * g[i];
+}
+
+real_type rampBand(
+    const complex_type *in,
+    complex_type *out,
+    int n,
+    real_type gain,
+    real_type step
+) {
+    real_type peak = 0;
+#pragma omp simd reduction(max : peak)
+    for (int i = 0; i < n; ++i) {
+        const auto real = in[2 * i];
+        const auto imaginary = in[2 * i + 1];
+        const auto power = real * real + imaginary * imaginary;
+        peak = power > peak ? power : peak;
+        const auto g = gain + static_cast<real_type>(i + 1) * step;
+        out[2 * i] = real * g;
+        out[2 * i + 1] = imaginary * g;
+    }
+    return peak;
+}
+
+real_type rampSignal(
+    const real_type *in,
+    real_type *out,
+    int n,
+    real_type gain,
+    real_type step
+) {
+    real_type peak = 0;
+#pragma omp simd reduction(max : peak)
+    for (int i = 0; i < n; ++i) {
+        const auto x = in[i];
+        peak = x * x > peak ? x * x : peak;
+        out[i] = x * (gain + static_cast<real_type>(i + 1) * step);
+    }
+    return peak;
+}
+
+real_type dotProduct(const real_type *a, const real_type *b, int n) {
+    real_type sum = 0;
+#pragma omp simd reduction(+ : sum)
+    for (int i = 0; i < n; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+constexpr Kernels definitions(const char *level) {
+    return {
+        level,
+        multiplyAccumulate,
+        normalizedCorrelation,
+        scaledAccumulate,
+        rampBand,
+        rampSignal,
+        dotProduct
+    };
+}
+}}
+
+#endif
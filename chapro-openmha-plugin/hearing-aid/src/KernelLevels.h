@@ -0,0 +1,15 @@
+#ifndef CHAPRO_OPENMHA_PLUGIN_HEARING_AID_SRC_KERNELLEVELS_H_
+#define CHAPRO_OPENMHA_PLUGIN_HEARING_AID_SRC_KERNELLEVELS_H_
+
+#include "Kernels.h"
+
+// Defined by the Kernels<Level>.cpp files the build compiles for the
+// target processor.
+namespace hearing_aid {
+extern const Kernels genericKernels;
+extern const Kernels avx2FmaKernels;
+extern const Kernels avx512fKernels;
+extern const Kernels neonKernels;
+}
+
+#endif
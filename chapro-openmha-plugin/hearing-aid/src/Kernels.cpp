@@ -0,0 +1,50 @@
+#include "Kernels.h"
+#include "KernelLevels.h"
+#include <cstdlib>
+#include <cstring>
+#if defined(HEARING_AID_KERNELS_NEON)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+namespace hearing_aid {
+static std::vector<const Kernels *> supported() {
+    std::vector<const Kernels *> levels;
+#if defined(HEARING_AID_KERNELS_AVX512F) || \
+    defined(HEARING_AID_KERNELS_AVX2_FMA)
+    __builtin_cpu_init();
+#endif
+#if defined(HEARING_AID_KERNELS_AVX512F)
+    if (__builtin_cpu_supports("avx512f"))
+        levels.push_back(&avx512fKernels);
+#endif
+#if defined(HEARING_AID_KERNELS_AVX2_FMA)
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        levels.push_back(&avx2FmaKernels);
+#endif
+#if defined(HEARING_AID_KERNELS_NEON)
+    if (getauxval(AT_HWCAP) & HWCAP_NEON)
+        levels.push_back(&neonKernels);
+#endif
+    levels.push_back(&genericKernels);
+    return levels;
+}
+
+static const Kernels &selected() {
+    const auto levels = supported();
+    if (const auto forced = std::getenv("HEARING_AID_KERNELS"))
+        for (auto level : levels)
+            if (std::strcmp(level->level, forced) == 0)
+                return *level;
+    return *levels.front();
+}
+
+const Kernels &kernels() {
+    static const Kernels &k = selected();
+    return k;
+}
+
+std::vector<const Kernels *> supportedKernels() {
+    return supported();
+}
+}
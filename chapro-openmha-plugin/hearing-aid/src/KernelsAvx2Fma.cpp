@@ -0,0 +1,5 @@
+#include "KernelDefinitions.h"
+
+namespace hearing_aid {
+const Kernels avx2FmaKernels = definitions("avx2-fma");
+}
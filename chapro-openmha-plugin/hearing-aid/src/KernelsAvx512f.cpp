@@ -0,0 +1,5 @@
+#include "KernelDefinitions.h"
+
+namespace hearing_aid {
+const Kernels avx512fKernels = definitions("avx512f");
+}
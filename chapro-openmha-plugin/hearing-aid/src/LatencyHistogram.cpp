@@ -0,0 +1,89 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace hearing_aid {
+namespace {
+constexpr auto subBucketBits = 5;
+constexpr auto subBuckets = 1 << subBucketBits;
+constexpr auto exactBuckets = 2 * subBuckets;
+constexpr auto bucketCount = exactBuckets + (64 - subBucketBits - 1) * subBuckets;
+
+int mostSignificantBit(std::uint64_t value) {
+    auto bit = 0;
+    while (value >>= 1)
+        ++bit;
+    return bit;
+}
+
+// Values below 64 have a bucket each; above, each power of two is split
+// into 32 buckets.
+int bucket(std::uint64_t value) {
+    if (value < exactBuckets)
+        return static_cast<int>(value);
+    const auto shift = mostSignificantBit(value) - subBucketBits;
+    return exactBuckets + (shift - 1) * subBuckets +
+        static_cast<int>((value >> shift) - subBuckets);
+}
+
+std::uint64_t upperBound(int index) {
+    if (index < exactBuckets)
+        return static_cast<std::uint64_t>(index);
+    const auto shift = (index - exactBuckets) / subBuckets + 1;
+    const auto sub = (index - exactBuckets) % subBuckets + subBuckets;
+    return ((static_cast<std::uint64_t>(sub) + 1) << shift) - 1;
+}
+}
+
+LatencyHistogram::LatencyHistogram() : buckets(bucketCount) {}
+
+void LatencyHistogram::record(std::uint64_t value) {
+    ++buckets[bucket(value)];
+    ++count_;
+    max_ = std::max(max_, value);
+    sum += static_cast<double>(value);
+}
+
+std::uint64_t LatencyHistogram::percentile(double p) const {
+    if (count_ == 0)
+        return 0;
+    const auto rank = std::max<std::uint64_t>(
+        1,
+        static_cast<std::uint64_t>(std::ceil(p * static_cast<double>(count_)))
+    );
+    std::uint64_t seen = 0;
+    for (int i = 0; i < bucketCount; ++i) {
+        seen += buckets[i];
+        if (seen >= rank)
+            return std::min(upperBound(i), max_);
+    }
+    return max_;
+}
+
+std::uint64_t LatencyHistogram::max() const {
+    return max_;
+}
+
+std::uint64_t LatencyHistogram::count() const {
+    return count_;
+}
+
+double LatencyHistogram::mean() const {
+    return count_ == 0 ? 0 : sum / static_cast<double>(count_);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+    for (int i = 0; i < bucketCount; ++i)
+        buckets[i] += other.buckets[i];
+    count_ += other.count_;
+    max_ = std::max(max_, other.max_);
+    sum += other.sum;
+}
+
+void LatencyHistogram::clear() {
+    std::fill(buckets.begin(), buckets.end(), 0);
+    count_ = 0;
+    max_ = 0;
+    sum = 0;
+}
+}
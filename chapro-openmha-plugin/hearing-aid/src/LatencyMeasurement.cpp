@@ -0,0 +1,130 @@
+#include "LatencyMeasurement.h"
+#include "Fft.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+namespace hearing_aid {
+LatencyMeasurement::LatencyMeasurement(
+    SweepBackend *backend,
+    const Parameters &p
+) :
+    p{p},
+    backend{backend} {}
+
+std::vector<double> LatencyMeasurement::bandCenters(
+    const std::vector<double> &crossFrequencies,
+    double sampleRate
+) {
+    std::vector<double> upper{crossFrequencies};
+    upper.push_back(sampleRate / 2);
+    std::vector<double> centers{upper.front() / 2};
+    for (std::vector<double>::size_type k = 1; k < upper.size(); ++k)
+        centers.push_back(std::sqrt(upper[k - 1] * upper[k]));
+    return centers;
+}
+
+static std::vector<real_type> processed(
+    SweepPipeline &pipeline,
+    std::vector<real_type> x,
+    int chunkSize
+) {
+    for (std::vector<real_type>::size_type n = 0; n < x.size(); n += chunkSize)
+        pipeline.process({x.data() + n, chunkSize});
+    return x;
+}
+
+static int roundedUp(int n, int multiple) {
+    return (n + multiple - 1) / multiple * multiple;
+}
+
+// Logarithmic sweep from 20 Hz to 0.45 times the sample rate.
+static std::vector<real_type> chirp(int length, double sampleRate, double a) {
+    constexpr auto pi = 3.14159265358979323846;
+    const auto first = 20 / sampleRate;
+    const auto last = 0.45;
+    const auto rate = std::log(last / first);
+    std::vector<real_type> x(length);
+    for (int n = 0; n < length; ++n)
+        x[n] = gsl::narrow_cast<real_type>(
+            a * std::sin(
+                2 * pi * first * length / rate *
+                    (std::exp(rate * n / length) - 1)
+            )
+        );
+    return x;
+}
+
+// -phase derivative of h's frequency response at f (cycles per sample),
+// as Re(DTFT(n h[n]) / DTFT(h[n])).
+static double groupDelay(const std::vector<real_type> &h, double f) {
+    constexpr auto pi = 3.14159265358979323846;
+    std::complex<double> weighted;
+    std::complex<double> plain;
+    for (std::vector<real_type>::size_type n = 0; n < h.size(); ++n) {
+        const auto e = std::polar(1., -2 * pi * f * n);
+        plain += double{h[n]} * e;
+        weighted += static_cast<double>(n) * h[n] * e;
+    }
+    return std::abs(plain) > 0 ? (weighted / plain).real() : 0;
+}
+
+LatencyMeasurement::Result LatencyMeasurement::measure(
+    const HearingAidBuilder::Parameters &fitting
+) {
+    Result result{};
+    const auto chunkSize = fitting.chunkSize;
+    result.fragment = 2 * chunkSize;
+    if (chunkSize < 1)
+        return result;
+    const auto amplitude =
+        std::pow(10., (p.level - fitting.fullScaleLevel) / 20);
+    const auto length = roundedUp(std::max(p.length, 1), chunkSize);
+
+    std::vector<real_type> impulse(length);
+    impulse.front() = gsl::narrow_cast<real_type>(amplitude);
+    const auto y = processed(*backend->make(fitting), impulse, chunkSize);
+    const auto peak = std::max_element(
+        y.begin(),
+        y.end(),
+        [](real_type a, real_type b) { return std::abs(a) < std::abs(b); }
+    );
+    result.peak = gsl::narrow<int>(peak - y.begin());
+    const auto threshold = std::abs(*peak) / 10;
+    result.onset = gsl::narrow<int>(
+        std::find_if(
+            y.begin(),
+            y.end(),
+            [&](real_type x) { return std::abs(x) >= threshold; }
+        ) - y.begin()
+    );
+
+    auto x = chirp(length, fitting.sampleRate, amplitude);
+    x.resize(2 * length);
+    const auto response = processed(*backend->make(fitting), x, chunkSize);
+    auto size = 2;
+    while (size < 2 * length)
+        size *= 2;
+    Fft fft{size};
+    x.resize(size);
+    auto padded = response;
+    padded.resize(size);
+    std::vector<spectrum_type> input(fft.bins());
+    std::vector<spectrum_type> output(fft.bins());
+    fft.forward(x, input);
+    fft.forward(padded, output);
+    real_type strongest = 0;
+    for (auto bin : input)
+        strongest = std::max(strongest, std::norm(bin));
+    // Regularized so bins outside the sweep do not blow up.
+    const auto floor = real_type{1e-6F} * strongest;
+    for (int k = 0; k < fft.bins(); ++k)
+        output[k] = multiplyConjugate(input[k], output[k]) /
+            (std::norm(input[k]) + floor);
+    fft.inverse(output, padded);
+    padded.resize(length);
+    for (auto f : bandCenters(fitting.crossFrequencies, fitting.sampleRate))
+        result.bands.push_back({f, groupDelay(padded, f / fitting.sampleRate)});
+    return result;
+}
+}
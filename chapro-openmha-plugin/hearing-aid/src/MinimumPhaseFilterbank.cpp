@@ -0,0 +1,315 @@
+#include "MinimumPhaseFilterbank.h"
+#include "Kernels.h"
+#include "SharedDesigns.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <tuple>
+
+namespace hearing_aid {
+static double sinc(double x) {
+    constexpr auto pi = 3.14159265358979323846;
+    return x == 0 ? 1 : std::sin(pi * x) / (pi * x);
+}
+
+// Ideal lowpass with cutoff f, t samples from the center.
+static double lowpass(double f, double sampleRate, double t) {
+    const auto bandwidth = 2 * f / sampleRate;
+    return bandwidth * sinc(bandwidth * t);
+}
+
+std::vector<std::vector<real_type>> linearPhaseBands(
+    const MinimumPhaseFilterbank::Parameters &p
+) {
+    constexpr auto pi = 3.14159265358979323846;
+    std::vector<double> edges{0};
+    edges.insert(
+        edges.end(),
+        p.crossFrequencies.begin(),
+        p.crossFrequencies.end()
+    );
+    edges.push_back(p.sampleRate / 2);
+    const auto taps = p.windowSize;
+    const auto center = (taps - 1) / 2.;
+    std::vector<std::vector<real_type>> bands;
+    for (std::vector<double>::size_type k = 0; k + 1 < edges.size(); ++k) {
+        std::vector<real_type> h(taps);
+        for (int n = 0; n < taps; ++n) {
+            const auto window = taps > 1 ?
+                0.54 - 0.46 * std::cos(2 * pi * n / (taps - 1)) :
+                1;
+            const auto t = n - center;
+            h[n] = gsl::narrow_cast<real_type>(
+                window * (
+                    lowpass(edges[k + 1], p.sampleRate, t) -
+                    lowpass(edges[k], p.sampleRate, t)
+                )
+            );
+        }
+        bands.push_back(std::move(h));
+    }
+    return bands;
+}
+
+std::vector<real_type> minimumPhase(const std::vector<real_type> &h) {
+    const auto n = gsl::narrow<int>(h.size());
+    // Long enough that the cepstrum's time aliasing is negligible.
+    auto size = 64;
+    while (size < 32 * n)
+        size *= 2;
+    Fft fft{size};
+    std::vector<real_type> x(size);
+    std::copy(h.begin(), h.end(), x.begin());
+    std::vector<spectrum_type> spectrum(fft.bins());
+    fft.forward(x, spectrum);
+    real_type peak = 0;
+    for (auto bin : spectrum)
+        peak = std::max(peak, std::abs(bin));
+    // Stopband zeros would take the logarithm to minus infinity.
+    const auto floor = peak > 0 ? real_type{1e-5F} * peak : real_type{1e-20F};
+    for (auto &bin : spectrum)
+        bin = std::log(std::max(std::abs(bin), floor));
+    auto &cepstrum = x;
+    fft.inverse(spectrum, cepstrum);
+    for (int i = 1; i < size / 2; ++i)
+        cepstrum[i] *= 2;
+    std::fill(cepstrum.begin() + size / 2 + 1, cepstrum.end(), real_type{0});
+    fft.forward(cepstrum, spectrum);
+    for (auto &bin : spectrum)
+        bin = std::exp(bin);
+    fft.inverse(spectrum, x);
+    return {x.begin(), x.begin() + n};
+}
+
+// Where the bands' delay is smallest, less would start the all-pass
+// response's impulse response before the first tap.
+static double minimumDelay(const MinimumPhaseFilterbank::Parameters &p) {
+    return std::min(8., p.windowSize / 2.);
+}
+
+std::vector<AnalyticFilter> complementaryBands(
+    const MinimumPhaseFilterbank::Parameters &p
+) {
+    constexpr auto pi = 3.14159265358979323846;
+    const auto taps = p.windowSize;
+    auto size = 64;
+    while (size < 8 * taps)
+        size *= 2;
+    Fft fft{size};
+    const auto bins = fft.bins();
+    std::vector<real_type> x(size);
+    // Each minimum-phase band's response and that of n h[n], whose ratio
+    // gives its group delay.
+    std::vector<std::vector<spectrum_type>> responses;
+    std::vector<std::vector<spectrum_type>> rampResponses;
+    for (const auto &band : linearPhaseBands(p)) {
+        const auto h = minimumPhase(band);
+        std::fill(x.begin(), x.end(), real_type{0});
+        std::copy(h.begin(), h.end(), x.begin());
+        responses.emplace_back(bins);
+        fft.forward(x, responses.back());
+        for (int n = 0; n < taps; ++n)
+            x[n] *= gsl::narrow_cast<real_type>(n);
+        rampResponses.emplace_back(bins);
+        fft.forward(x, rampResponses.back());
+    }
+    std::vector<double> magnitude(bins);
+    std::vector<spectrum_type> common(bins);
+    double phase = 0;
+    double lastDelay = 0;
+    for (int i = 0; i < bins; ++i) {
+        double power = 0;
+        double weightedDelay = 0;
+        for (std::size_t k = 0; k < responses.size(); ++k) {
+            magnitude[i] += std::abs(responses[k][i]);
+            power += std::norm(responses[k][i]);
+            weightedDelay +=
+                (rampResponses[k][i] * std::conj(responses[k][i])).real();
+        }
+        // Longer delays only come from the bands' zeros: the even-length
+        // bands all vanish at the Nyquist frequency.
+        const auto delay = std::min(
+            std::max(
+                power > 0 ? weightedDelay / power : 0,
+                minimumDelay(p)
+            ),
+            taps / 2.
+        );
+        if (i > 0)
+            phase -= (lastDelay + delay) / 2 * 2 * pi / size;
+        lastDelay = delay;
+        common[i] = std::polar(
+            real_type{1},
+            gsl::narrow_cast<real_type>(phase)
+        );
+    }
+    // The Nyquist bin of a real filter is real: delay by up to one more
+    // sample for a whole number of half cycles there.
+    const auto extra = std::ceil(-phase / pi) + phase / pi;
+    for (int i = 0; i < bins; ++i)
+        common[i] *= std::polar(
+            real_type{1},
+            gsl::narrow_cast<real_type>(-extra * pi * i / (bins - 1))
+        );
+    common.back() = common.back().real();
+    std::vector<AnalyticFilter> bands;
+    std::vector<spectrum_type> real(bins);
+    std::vector<spectrum_type> imaginary(bins);
+    for (const auto &response : responses) {
+        for (int i = 0; i < bins; ++i) {
+            const auto share = magnitude[i] > 0 ?
+                gsl::narrow_cast<real_type>(
+                    std::abs(response[i]) / magnitude[i]
+                ) :
+                real_type{0};
+            real[i] = share * common[i];
+            imaginary[i] = i == 0 || i == bins - 1 ?
+                spectrum_type{0} :
+                spectrum_type{0, -1} * real[i];
+        }
+        AnalyticFilter band;
+        fft.inverse(real, x);
+        band.real.assign(x.begin(), x.begin() + taps);
+        fft.inverse(imaginary, x);
+        band.imaginary.assign(x.begin(), x.begin() + taps);
+        bands.push_back(std::move(band));
+    }
+    return bands;
+}
+
+static std::vector<std::vector<spectrum_type>> partitionSpectra(
+    const std::vector<real_type> &h,
+    int partitions,
+    Fft &fft
+) {
+    const auto blockSize = fft.size() / 2;
+    std::vector<real_type> block(fft.size());
+    std::vector<std::vector<spectrum_type>> spectra;
+    for (int partition = 0; partition < partitions; ++partition) {
+        std::fill(block.begin(), block.end(), real_type{0});
+        const auto first = partition * blockSize;
+        const auto last = std::min(
+            first + blockSize,
+            gsl::narrow<int>(h.size())
+        );
+        std::copy(h.begin() + first, h.begin() + last, block.begin());
+        spectra.emplace_back(fft.bins());
+        fft.forward(block, spectra.back());
+    }
+    return spectra;
+}
+
+static MinimumPhaseDesign design(const MinimumPhaseFilterbank::Parameters &p) {
+    const auto blockSize = p.chunkSize;
+    MinimumPhaseDesign d;
+    d.partitions = (p.windowSize + blockSize - 1) / blockSize;
+    Fft fft{2 * blockSize};
+    for (const auto &band : complementaryBands(p)) {
+        for (auto &spectrum : partitionSpectra(band.real, d.partitions, fft))
+            d.spectra.push_back(std::move(spectrum));
+        for (auto &spectrum :
+                partitionSpectra(band.imaginary, d.partitions, fft))
+            d.quadratureSpectra.push_back(std::move(spectrum));
+    }
+    return d;
+}
+
+using DesignKey = std::tuple<std::vector<double>, double, int, int>;
+
+static SharedDesigns<DesignKey, MinimumPhaseDesign> &designs() {
+    static SharedDesigns<DesignKey, MinimumPhaseDesign> designs;
+    return designs;
+}
+
+static const MinimumPhaseFilterbank::Parameters &validated(
+    const MinimumPhaseFilterbank::Parameters &p
+) {
+    if (p.windowSize < 1)
+        throw std::invalid_argument{"filterbank window size must be positive"};
+    return p;
+}
+
+MinimumPhaseFilterbank::MinimumPhaseFilterbank(const Parameters &p) :
+    fft{2 * validated(p).chunkSize},
+    accumulator(fft.bins()),
+    frame(fft.size()),
+    result(fft.size()),
+    bands{gsl::narrow<int>(p.crossFrequencies.size()) + 1},
+    blockSize{p.chunkSize}
+{
+    design = designs().acquire(
+        DesignKey{p.crossFrequencies, p.sampleRate, p.windowSize, p.chunkSize},
+        [&] { return hearing_aid::design(p); }
+    );
+    inputSpectra.assign(
+        design->partitions,
+        std::vector<spectrum_type>(fft.bins())
+    );
+}
+
+int MinimumPhaseFilterbank::partitions() const {
+    return design->partitions;
+}
+
+void MinimumPhaseFilterbank::filterbankAnalyze(
+    real_signal_type input,
+    complex_signal_type output,
+    int chunkSize
+) {
+    if (chunkSize != blockSize) {
+        std::fill(
+            output.begin(),
+            output.begin() + 2 * chunkSize * bands,
+            complex_type{0}
+        );
+        return;
+    }
+    std::copy(frame.begin() + blockSize, frame.end(), frame.begin());
+    std::copy(
+        input.begin(),
+        input.begin() + blockSize,
+        frame.begin() + blockSize
+    );
+    newest = (newest + partitions() - 1) % partitions();
+    fft.forward(frame, inputSpectra[newest]);
+    for (int k = 0; k < bands; ++k) {
+        auto out = output.data() + 2 * blockSize * k;
+        convolve(design->spectra, k);
+        for (int i = 0; i < blockSize; ++i)
+            out[2 * i] = result[blockSize + i];
+        convolve(design->quadratureSpectra, k);
+        for (int i = 0; i < blockSize; ++i)
+            out[2 * i + 1] = result[blockSize + i];
+    }
+}
+
+// Leaves the newest block of band k's filter output in the second half of
+// result.
+void MinimumPhaseFilterbank::convolve(
+    const std::vector<std::vector<spectrum_type>> &spectra,
+    int k
+) {
+    std::fill(accumulator.begin(), accumulator.end(), spectrum_type{});
+    for (int p = 0; p < partitions(); ++p)
+        kernels().multiplyAccumulate(
+            spectra[k * partitions() + p].data(),
+            inputSpectra[(newest + p) % partitions()].data(),
+            accumulator.data(),
+            fft.bins()
+        );
+    fft.inverse(accumulator, result);
+}
+
+void MinimumPhaseFilterbank::filterbankSynthesize(
+    complex_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    for (int i = 0; i < chunkSize; ++i) {
+        real_type sum = 0;
+        for (int k = 0; k < bands; ++k)
+            sum += input[2 * chunkSize * k + 2 * i];
+        output[i] = sum;
+    }
+}
+}
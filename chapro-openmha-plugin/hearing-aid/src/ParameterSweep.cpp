@@ -0,0 +1,132 @@
+#include "ParameterSweep.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace hearing_aid {
+ParameterSweep::ParameterSweep(SweepBackend *backend, int threads) :
+    pool{threads},
+    backend{backend} {}
+
+std::unique_ptr<SweepPipeline> ParameterSweep::make(
+    const HearingAidBuilder::Parameters &p
+) {
+    std::lock_guard<std::mutex> lock{making};
+    return backend->make(p);
+}
+
+static std::vector<std::vector<double>> candidates(
+    const std::vector<std::vector<double>> &v
+) {
+    return v.empty() ? std::vector<std::vector<double>>{{}} : v;
+}
+
+std::vector<ParameterSweep::Result> ParameterSweep::points(const Grid &grid) {
+    std::vector<Result> results;
+    for (const auto &cr : candidates(grid.compressionRatios))
+        for (const auto &tk : candidates(grid.kneepoints))
+            for (const auto &tkgain : candidates(grid.kneepointGains)) {
+                Result r{};
+                r.compressionRatios = cr;
+                r.kneepoints = tk;
+                r.kneepointGains = tkgain;
+                results.push_back(std::move(r));
+            }
+    return results;
+}
+
+static std::vector<real_type> processed(
+    SweepPipeline &pipeline,
+    std::vector<real_type> x,
+    int chunkSize
+) {
+    const auto fragments = chunkSize > 0 ?
+        gsl::narrow<int>(x.size()) / chunkSize : 0;
+    x.resize(fragments * chunkSize);
+    for (int n = 0; n < fragments; ++n)
+        pipeline.process({x.data() + n * chunkSize, chunkSize});
+    return x;
+}
+
+static double power(const std::vector<real_type> &x) {
+    double sum = 0;
+    for (auto sample : x)
+        sum += double{sample} * sample;
+    return x.empty() ? 0 : sum / x.size();
+}
+
+static double decibels(double x) {
+    constexpr auto floor = 1e-20;
+    return 10 * std::log10(std::max(x, floor));
+}
+
+static double secondHalfMean(const std::vector<real_type> &x) {
+    if (x.empty())
+        return std::numeric_limits<double>::quiet_NaN();
+    const auto first = x.size() / 2;
+    double sum = 0;
+    for (auto i = first; i < x.size(); ++i)
+        sum += x[i];
+    return sum / (x.size() - first);
+}
+
+std::vector<ParameterSweep::Result> ParameterSweep::run(
+    const HearingAidBuilder::Parameters &fitting,
+    const Grid &grid,
+    const Input &input,
+    const Metrics &metrics
+) {
+    const auto n = input.noise.empty() ?
+        input.signal.size() :
+        std::min(input.signal.size(), input.noise.size());
+    std::vector<real_type> mixture(n);
+    std::vector<real_type> inverted(n);
+    for (std::vector<real_type>::size_type i = 0; i < n; ++i) {
+        const auto noise = input.noise.empty() ? 0 : input.noise[i];
+        mixture[i] = input.signal[i] + noise;
+        inverted[i] = input.signal[i] - noise;
+    }
+    const auto measureSnr = metrics.snr && !input.noise.empty();
+    auto base = fitting;
+    if (metrics.feedbackQuality) {
+        base.saveQualityMetric = 1;
+        base.qualityMetricLength =
+            fitting.chunkSize > 0 ? gsl::narrow<int>(n) / fitting.chunkSize : 0;
+    }
+    auto results = points(grid);
+    constexpr auto nan = std::numeric_limits<double>::quiet_NaN();
+    pool.run(gsl::narrow<int>(results.size()), [&](int i) {
+        auto &r = results[i];
+        auto p = base;
+        if (!r.compressionRatios.empty())
+            p.compressionRatios = r.compressionRatios;
+        if (!r.kneepoints.empty())
+            p.kneepoints = r.kneepoints;
+        if (!r.kneepointGains.empty())
+            p.kneepointGains = r.kneepointGains;
+        r.compressionRatios = p.compressionRatios;
+        r.kneepoints = p.kneepoints;
+        r.kneepointGains = p.kneepointGains;
+        auto pipeline = make(p);
+        const auto a = processed(*pipeline, mixture, p.chunkSize);
+        r.level = metrics.level ? decibels(power(a)) + p.fullScaleLevel : nan;
+        r.feedbackQuality = metrics.feedbackQuality ?
+            secondHalfMean(pipeline->qualityMetric()) :
+            nan;
+        r.snr = nan;
+        if (measureSnr) {
+            const auto b = processed(*make(p), inverted, p.chunkSize);
+            double signal = 0;
+            double noise = 0;
+            for (std::vector<real_type>::size_type j = 0; j < a.size(); ++j) {
+                const auto s = (double{a[j]} + b[j]) / 2;
+                const auto d = (double{a[j]} - b[j]) / 2;
+                signal += s * s;
+                noise += d * d;
+            }
+            r.snr = decibels(signal) - decibels(noise);
+        }
+    });
+    return results;
+}
+}
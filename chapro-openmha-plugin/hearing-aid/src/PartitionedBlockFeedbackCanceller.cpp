@@ -0,0 +1,163 @@
+#include "PartitionedBlockFeedbackCanceller.h"
+#include "Kernels.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace hearing_aid {
+static int partitionCount(int filterLength, int blockSize) {
+    return (filterLength + blockSize - 1) / blockSize;
+}
+
+PartitionedBlockFeedbackCanceller::PartitionedBlockFeedbackCanceller(
+    std::shared_ptr<SuperSignalProcessor> processor_,
+    const Parameters &p
+) :
+    processor{std::move(processor_)},
+    fft{2 * processor->chunkSize()},
+    estimate(fft.bins()),
+    gradient(fft.bins()),
+    error(fft.bins()),
+    power(fft.bins()),
+    frame(fft.size()),
+    previous(processor->chunkSize()),
+    delayLine(processor->chunkSize() + std::max(p.hardwareLatency, 0)),
+    forgettingFactor{
+        static_cast<real_type>(p.filterEstimationForgettingFactor)
+    },
+    powerThreshold{static_cast<real_type>(p.filterEstimationPowerThreshold)},
+    stepSize{static_cast<real_type>(p.filterEstimationStepSize)},
+    blockSize{processor->chunkSize()}
+{
+    const auto count = partitionCount(p.adaptiveFilterLength, blockSize);
+    weights.assign(count, std::vector<spectrum_type>(fft.bins()));
+    references.assign(count, std::vector<spectrum_type>(fft.bins()));
+}
+
+int PartitionedBlockFeedbackCanceller::partitions() const {
+    return static_cast<int>(weights.size());
+}
+
+std::vector<spectrum_type> &PartitionedBlockFeedbackCanceller::reference(
+    int partition
+) {
+    return references[(newest + partition) % partitions()];
+}
+
+void PartitionedBlockFeedbackCanceller::feedbackCancelInput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    if (chunkSize != blockSize || partitions() == 0) {
+        std::copy(input.begin(), input.begin() + chunkSize, output.begin());
+        return;
+    }
+    pushReference();
+    std::fill(estimate.begin(), estimate.end(), spectrum_type{});
+    for (int p = 0; p < partitions(); ++p) {
+        kernels().multiplyAccumulate(
+            weights[p].data(),
+            reference(p).data(),
+            estimate.data(),
+            fft.bins()
+        );
+    }
+    fft.inverse(estimate, frame);
+    for (int i = 0; i < blockSize; ++i)
+        output[i] = input[i] - frame[blockSize + i];
+    adapt(output);
+}
+
+// Transforms the previous and the oldest delayed output chunk into the
+// newest reference partition.
+void PartitionedBlockFeedbackCanceller::pushReference() {
+    newest = (newest + partitions() - 1) % partitions();
+    const auto delay = static_cast<int>(delayLine.size());
+    for (int i = 0; i < blockSize; ++i) {
+        frame[i] = previous[i];
+        previous[i] = delayLine[(delayLineHead + i) % delay];
+        frame[blockSize + i] = previous[i];
+    }
+    auto &x = reference(0);
+    fft.forward(frame, x);
+    for (int k = 0; k < fft.bins(); ++k)
+        power[k] = forgettingFactor * power[k] +
+            (1 - forgettingFactor) * std::norm(x[k]);
+}
+
+void PartitionedBlockFeedbackCanceller::adapt(real_signal_type e) {
+    std::fill(frame.begin(), frame.begin() + blockSize, real_type{0});
+    std::copy(e.begin(), e.begin() + blockSize, frame.begin() + blockSize);
+    fft.forward(frame, error);
+    for (int p = 0; p < partitions(); ++p) {
+        kernels().normalizedCorrelation(
+            reference(p).data(),
+            error.data(),
+            power.data(),
+            powerThreshold,
+            gradient.data(),
+            fft.bins()
+        );
+        if (p == constrained)
+            constrain(gradient);
+        kernels().scaledAccumulate(
+            gradient.data(),
+            stepSize,
+            weights[p].data(),
+            fft.bins()
+        );
+    }
+    constrained = (constrained + 1) % partitions();
+}
+
+// Discards the circular-correlation half of a partition's gradient.
+void PartitionedBlockFeedbackCanceller::constrain(
+    std::vector<spectrum_type> &g
+) {
+    fft.inverse(g, frame);
+    std::fill(frame.begin() + blockSize, frame.end(), real_type{0});
+    fft.forward(frame, g);
+}
+
+void PartitionedBlockFeedbackCanceller::feedbackCancelOutput(
+    real_signal_type input,
+    int chunkSize
+) {
+    const auto delay = static_cast<int>(delayLine.size());
+    for (int i = 0; i < chunkSize; ++i)
+        delayLine[(delayLineHead + i) % delay] = input[i];
+    delayLineHead = (delayLineHead + chunkSize) % delay;
+}
+
+void PartitionedBlockFeedbackCanceller::compressInput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    processor->compressInput(input, output, chunkSize);
+}
+
+void PartitionedBlockFeedbackCanceller::compressChannel(
+    complex_signal_type input,
+    complex_signal_type output,
+    int chunkSize
+) {
+    processor->compressChannel(input, output, chunkSize);
+}
+
+void PartitionedBlockFeedbackCanceller::compressOutput(
+    real_signal_type input,
+    real_signal_type output,
+    int chunkSize
+) {
+    processor->compressOutput(input, output, chunkSize);
+}
+
+int PartitionedBlockFeedbackCanceller::chunkSize() {
+    return processor->chunkSize();
+}
+
+int PartitionedBlockFeedbackCanceller::channels() {
+    return processor->channels();
+}
+}
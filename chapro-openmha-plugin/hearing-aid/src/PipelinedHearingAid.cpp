@@ -0,0 +1,233 @@
+#include "PipelinedHearingAid.h"
+#include "DenormalProtection.h"
+#include "ThreadAffinity.h"
+#include <algorithm>
+
+namespace hearing_aid {
+namespace {
+constexpr auto depth = PipelinedHearingAid::latencyFragments() + 2;
+constexpr auto submissionsMask =
+    (1U << (PipelinedHearingAid::latencyFragments() + 1)) - 1;
+
+int popWhenAvailable(
+    SpscQueue<int> &queue,
+    Parking &parking,
+    const std::atomic<bool> &stopping
+) {
+    int item{-1};
+    parking.wait([&] {
+        return queue.pop(item) || stopping.load(std::memory_order_acquire);
+    });
+    return item;
+}
+
+void push(SpscQueue<int> &queue, Parking &parking, int item) {
+    queue.push(item);
+    parking.notify();
+}
+
+void pin(std::thread &thread, const std::vector<int> &cores, int i) {
+    using size_type = std::vector<int>::size_type;
+    if (gsl::narrow<size_type>(i) < cores.size())
+        pinToCore(thread, cores[i]);
+}
+
+std::vector<int> bandCores(const std::vector<int> &cores) {
+    if (cores.size() <= 2)
+        return {};
+    return {cores.begin() + 2, cores.end()};
+}
+
+int bandThreads(
+    const std::shared_ptr<BandCompressor> &bandCompressor,
+    const PipelinedHearingAid::Parameters &p,
+    int channels
+) {
+    if (!bandCompressor)
+        return 1;
+    return std::max(1, std::min(p.bandThreads, channels));
+}
+}
+
+PipelinedHearingAid::PipelinedHearingAid(
+    std::shared_ptr<SuperSignalProcessor> processor_,
+    std::shared_ptr<Filter> filter_,
+    const Parameters &p
+) :
+    fragments(depth),
+    available(depth),
+    submitted(depth),
+    compressed(depth),
+    synthesized(depth),
+    delivered(depth),
+    submittedParking{p.spin},
+    compressedParking{p.spin},
+    synthesizedParking{p.spin},
+    processor{std::move(processor_)},
+    filter{std::move(filter_)},
+    bandCompressor{std::dynamic_pointer_cast<BandCompressor>(processor)},
+    bandPool{
+        bandThreads(bandCompressor, p, processor->channels()),
+        bandCores(p.cores),
+        p.flushDenormals,
+        p.spin
+    },
+    chunkSize{processor->chunkSize()}
+{
+    const auto channels = processor->channels();
+    for (int i = 0; i < depth; ++i) {
+        fragments[i].signal.resize(chunkSize);
+        fragments[i].bands.resize(2 * chunkSize * channels);
+        available.push(i);
+    }
+    threads.emplace_back([this, flushDenormals = p.flushDenormals] {
+        const auto flush = flushDenormals ?
+            std::make_unique<FlushDenormalsToZero>() :
+            nullptr;
+        compressStage();
+    });
+    pin(threads.back(), p.cores, 0);
+    threads.emplace_back([this, flushDenormals = p.flushDenormals] {
+        const auto flush = flushDenormals ?
+            std::make_unique<FlushDenormalsToZero>() :
+            nullptr;
+        synthesizeStage();
+    });
+    pin(threads.back(), p.cores, 1);
+}
+
+PipelinedHearingAid::~PipelinedHearingAid() {
+    stopping.store(true, std::memory_order_release);
+    submittedParking.notify();
+    compressedParking.notify();
+    synthesizedParking.notify();
+    for (auto &thread : threads)
+        thread.join();
+}
+
+int PipelinedHearingAid::latencySamples() {
+    return latencyFragments() * chunkSize;
+}
+
+int PipelinedHearingAid::missedFragments() const {
+    return missed;
+}
+
+void PipelinedHearingAid::process(real_signal_type signal) {
+    if (signal.size() != chunkSize)
+        return;
+    retireLate();
+    submissions = (submissions << 1U | (submit(signal) ? 1U : 0U)) &
+        submissionsMask;
+    const auto due = (submissions >> latencyFragments() & 1U) != 0;
+    int done{};
+    if (due && late == 0 && delivered.pop(done)) {
+        const auto &output = fragments[done].signal;
+        std::copy(output.begin(), output.end(), signal.begin());
+        available.push(done);
+    } else {
+        std::fill(signal.begin(), signal.end(), real_type{0});
+        if (due) {
+            ++late;
+            ++missed;
+        }
+    }
+    processor->feedbackCancelOutput(signal, chunkSize);
+}
+
+// Fragments replaced by zeros are dropped when they arrive, so later
+// fragments keep their latency.
+void PipelinedHearingAid::retireLate() {
+    int slot{};
+    while (late > 0 && delivered.pop(slot)) {
+        available.push(slot);
+        --late;
+    }
+}
+
+bool PipelinedHearingAid::submit(real_signal_type signal) {
+    int slot{};
+    if (!available.pop(slot)) {
+        processor->feedbackCancelInput(signal, signal, chunkSize);
+        ++missed;
+        return false;
+    }
+    auto &fragment = fragments[slot];
+    std::copy(signal.begin(), signal.end(), fragment.signal.begin());
+    processor->feedbackCancelInput(
+        fragment.signal,
+        fragment.signal,
+        chunkSize
+    );
+    push(submitted, submittedParking, slot);
+    return true;
+}
+
+void PipelinedHearingAid::compressStage() {
+    auto synthesizing = 0;
+    for (;;) {
+        const auto slot = popWhenAvailable(
+            submitted,
+            submittedParking,
+            stopping
+        );
+        if (slot < 0)
+            return;
+        auto &fragment = fragments[slot];
+        processor->compressInput(fragment.signal, fragment.signal, chunkSize);
+        filter->filterbankAnalyze(
+            fragment.signal,
+            fragment.bands,
+            chunkSize
+        );
+        compress(slot);
+        push(compressed, compressedParking, slot);
+        if (++synthesizing < 2)
+            continue;
+        // The previous fragment was synthesized while this one was
+        // compressed; its output compressor runs here so that no two AGC
+        // stages overlap.
+        const auto previous = popWhenAvailable(
+            synthesized,
+            synthesizedParking,
+            stopping
+        );
+        if (previous < 0)
+            return;
+        auto &output = fragments[previous].signal;
+        processor->compressOutput(output, output, chunkSize);
+        delivered.push(previous);
+        --synthesizing;
+    }
+}
+
+void PipelinedHearingAid::compress(int slot) {
+    auto &bands = fragments[slot].bands;
+    if (!bandCompressor || bandPool.threads() == 1) {
+        processor->compressChannel(bands, bands, chunkSize);
+        return;
+    }
+    bandPool.run(processor->channels(), [&](int band) {
+        bandCompressor->compressChannels(bands, bands, chunkSize, band, 1);
+    });
+}
+
+void PipelinedHearingAid::synthesizeStage() {
+    for (;;) {
+        const auto slot = popWhenAvailable(
+            compressed,
+            compressedParking,
+            stopping
+        );
+        if (slot < 0)
+            return;
+        auto &fragment = fragments[slot];
+        filter->filterbankSynthesize(
+            fragment.bands,
+            fragment.signal,
+            chunkSize
+        );
+        push(synthesized, synthesizedParking, slot);
+    }
+}
+}
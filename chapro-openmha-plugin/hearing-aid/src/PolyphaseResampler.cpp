@@ -0,0 +1,134 @@
+#include "PolyphaseResampler.h"
+#include "Kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace hearing_aid {
+namespace {
+double besselI0(double x) {
+    auto sum = 1.;
+    auto term = 1.;
+    for (int k = 1; k < 50; ++k) {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+        if (term < 1e-12 * sum)
+            break;
+    }
+    return sum;
+}
+
+double sinc(double x) {
+    const auto pi = std::acos(-1.);
+    return x == 0 ? 1 : std::sin(pi * x) / (pi * x);
+}
+
+// Kaiser's estimates of the window shape and length for a stopband
+// attenuation in dB and a transition width in cycles per sample.
+double kaiserBeta(double attenuation) {
+    if (attenuation > 50)
+        return 0.1102 * (attenuation - 8.7);
+    if (attenuation >= 21)
+        return 0.5842 * std::pow(attenuation - 21, 0.4) +
+            0.07886 * (attenuation - 21);
+    return 0;
+}
+
+int kaiserLength(double attenuation, double transition) {
+    return static_cast<int>(
+        std::ceil((attenuation - 7.95) / (14.36 * transition))
+    ) + 1;
+}
+}
+
+PolyphaseResampler::PolyphaseResampler(const Parameters &p) {
+    if (p.inputRate <= 0 || p.outputRate <= 0)
+        throw std::invalid_argument{"resampler rates must be positive"};
+    if (p.passband <= 0 || p.passband >= 1)
+        throw std::invalid_argument{
+            "resampler passband must be within (0, 1)"
+        };
+    const auto divisor = std::gcd(p.inputRate, p.outputRate);
+    up = p.outputRate / divisor;
+    down = p.inputRate / divisor;
+    // Lowpass at the upsampled rate, from the passband edge to the lower
+    // of the two Nyquist frequencies, cut off halfway between them.
+    const auto nyquist = 0.5 / std::max(up, down);
+    const auto transition = (1 - p.passband) * nyquist;
+    taps_ = (kaiserLength(p.stopbandAttenuation, transition) + up - 1) / up;
+    const auto length = up * taps_;
+    const auto cutoff = (1 + p.passband) / 2 * nyquist;
+    const auto beta = kaiserBeta(p.stopbandAttenuation);
+    const auto center = (length - 1) / 2.;
+    std::vector<double> prototype(length);
+    for (int i = 0; i < length; ++i) {
+        const auto t = (i - center) / center;
+        const auto window =
+            besselI0(beta * std::sqrt(std::max(0., 1 - t * t))) /
+            besselI0(beta);
+        prototype[i] = 2 * cutoff * sinc(2 * cutoff * (i - center)) * window;
+    }
+    // Phase p holds prototype[p + up * k], reversed so it lines up with
+    // the oldest-first history and scaled to unity DC gain so that
+    // interpolated samples carry no ripple at the output rate.
+    coefficients.resize(length);
+    for (int phase_ = 0; phase_ < up; ++phase_) {
+        auto sum = 0.;
+        for (int k = 0; k < taps_; ++k)
+            sum += prototype[phase_ + up * k];
+        for (int k = 0; k < taps_; ++k)
+            coefficients[phase_ * taps_ + taps_ - 1 - k] =
+                static_cast<real_type>(prototype[phase_ + up * k] / sum);
+    }
+    history.resize(taps_ - 1 + p.maxInput);
+}
+
+int PolyphaseResampler::process(
+    real_signal_type input,
+    real_signal_type output
+) {
+    const auto n = static_cast<int>(input.size());
+    if (n > static_cast<int>(history.size()) - taps_ + 1)
+        return 0;
+    std::copy(input.begin(), input.end(), history.begin() + taps_ - 1);
+    int count = 0;
+    while (position < n) {
+        output[count++] = kernels().dotProduct(
+            coefficients.data() + phase * taps_,
+            history.data() + position,
+            taps_
+        );
+        phase += down;
+        position += phase / up;
+        phase %= up;
+    }
+    position -= n;
+    std::copy(
+        history.begin() + n,
+        history.begin() + n + taps_ - 1,
+        history.begin()
+    );
+    return count;
+}
+
+int PolyphaseResampler::maxOutput(int input) const {
+    return (input * up + down - 1) / down + 1;
+}
+
+double PolyphaseResampler::delay() const {
+    return (up * taps_ - 1) / 2. / down;
+}
+
+int PolyphaseResampler::taps() const {
+    return taps_;
+}
+
+int PolyphaseResampler::upsampling() const {
+    return up;
+}
+
+int PolyphaseResampler::downsampling() const {
+    return down;
+}
+}
@@ -0,0 +1,149 @@
+#include "ResamplingHearingAid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace hearing_aid {
+namespace {
+PolyphaseResampler::Parameters converter(
+    const ResamplingHearingAid::Parameters &r,
+    int inputRate,
+    int outputRate,
+    int maxInput
+) {
+    PolyphaseResampler::Parameters p;
+    p.inputRate = inputRate;
+    p.outputRate = outputRate;
+    p.passband = r.passband;
+    p.stopbandAttenuation = r.stopbandAttenuation;
+    p.maxInput = maxInput;
+    return p;
+}
+
+int ceilingDivide(long long a, long long b) {
+    return static_cast<int>((a + b - 1) / b);
+}
+
+// Zeros the output queue starts with. Downsampling an external fragment
+// yields at least its share of internal samples less one, and up to a
+// whole internal fragment may wait in the internal queue, so this many
+// external samples always precede what has been upsampled.
+int primedSamples(const ResamplingHearingAid::Parameters &p, int internalChunk) {
+    return ceilingDivide(
+        static_cast<long long>(internalChunk + 1) * p.externalRate,
+        p.internalRate
+    ) + 1;
+}
+
+double delay(
+    const ResamplingHearingAid::Parameters &p,
+    const PolyphaseResampler &down,
+    const PolyphaseResampler &up
+) {
+    return primedSamples(p, ResamplingHearingAid::internalChunkSize(p)) +
+        down.delay() * p.externalRate / p.internalRate +
+        up.delay();
+}
+}
+
+int ResamplingHearingAid::internalChunkSize(const Parameters &p) {
+    return ceilingDivide(
+        static_cast<long long>(p.externalChunkSize) * p.internalRate,
+        p.externalRate
+    );
+}
+
+ResamplingHearingAid::ResamplingHearingAid(
+    std::unique_ptr<SignalProcessor> processor_,
+    const Parameters &p
+) :
+    processor{std::move(processor_)},
+    down{converter(
+        p,
+        p.externalRate,
+        p.internalRate,
+        p.externalChunkSize
+    )},
+    up{converter(
+        p,
+        p.internalRate,
+        p.externalRate,
+        internalChunkSize(p)
+    )},
+    externalChunkSize{p.externalChunkSize},
+    internalChunkSize_{internalChunkSize(p)},
+    outputQueued{primedSamples(p, internalChunkSize(p))}
+{
+    downsampled.resize(down.maxOutput(externalChunkSize));
+    internalQueue.resize(internalChunkSize_ + downsampled.size());
+    const auto fragmentsPerCall =
+        ceilingDivide(internalQueue.size(), internalChunkSize_);
+    outputQueue.resize(
+        outputQueued + externalChunkSize +
+        fragmentsPerCall * up.maxOutput(internalChunkSize_)
+    );
+    latency = delay(p, down, up);
+}
+
+void ResamplingHearingAid::process(real_signal_type signal) {
+    if (signal.size() != externalChunkSize)
+        return;
+    const auto count = down.process(signal, downsampled);
+    std::copy(
+        downsampled.begin(),
+        downsampled.begin() + count,
+        internalQueue.begin() + internalQueued
+    );
+    internalQueued += count;
+    auto consumed = 0;
+    while (internalQueued - consumed >= internalChunkSize_) {
+        real_signal_type fragment{
+            internalQueue.data() + consumed,
+            internalChunkSize_
+        };
+        processor->process(fragment);
+        outputQueued += up.process(
+            fragment,
+            {
+                outputQueue.data() + outputQueued,
+                gsl::narrow<real_signal_type::index_type>(
+                    outputQueue.size() - outputQueued
+                )
+            }
+        );
+        consumed += internalChunkSize_;
+    }
+    std::copy(
+        internalQueue.begin() + consumed,
+        internalQueue.begin() + internalQueued,
+        internalQueue.begin()
+    );
+    internalQueued -= consumed;
+    const auto available = std::min(outputQueued, externalChunkSize);
+    std::copy(
+        outputQueue.begin(),
+        outputQueue.begin() + available,
+        signal.begin()
+    );
+    std::fill(signal.begin() + available, signal.end(), real_type{0});
+    std::copy(
+        outputQueue.begin() + available,
+        outputQueue.begin() + outputQueued,
+        outputQueue.begin()
+    );
+    outputQueued -= available;
+}
+
+int ResamplingHearingAid::latencySamples(const Parameters &p) {
+    const PolyphaseResampler down{
+        converter(p, p.externalRate, p.internalRate, p.externalChunkSize)
+    };
+    const PolyphaseResampler up{
+        converter(p, p.internalRate, p.externalRate, internalChunkSize(p))
+    };
+    return static_cast<int>(std::lround(delay(p, down, up)));
+}
+
+int ResamplingHearingAid::latencySamples() const {
+    return static_cast<int>(std::lround(latency));
+}
+}
@@ -0,0 +1,107 @@
+#include "SpectralCompressor.h"
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace hearing_aid {
+// By Parseval, the weighted bin power of a windowed sine of amplitude A
+// is fftLength * A^2 / 2 times the window's energy.
+static double windowPowerScale(const SpectralCompressor::Parameters &p) {
+    const auto energy = p.window.empty() ?
+        p.fftLength :
+        std::inner_product(
+            p.window.begin(),
+            p.window.end(),
+            p.window.begin(),
+            0.
+        );
+    return 2 / (p.fftLength * energy);
+}
+
+SpectralCompressor::SpectralCompressor(const Parameters &p) :
+    powerScale{windowPowerScale(p)},
+    bins_{p.fftLength / 2 + 1},
+    nyquist{p.fftLength % 2 == 0 ? bins_ - 1 : -1}
+{
+    const auto bands = gsl::narrow<int>(p.crossFrequencies.size()) + 1;
+    for (int k = 0; k < bands; ++k) {
+        auto trajectory = channelTrajectory(p.fitting, k);
+        trajectory.sampleRate = p.fitting.sampleRate / p.hopSize;
+        trajectory.controlInterval = 1;
+        bandGains.emplace_back(trajectory);
+    }
+    firstBins.push_back(0);
+    int bin = 0;
+    for (auto crossFrequency : p.crossFrequencies) {
+        while (bin < bins_ &&
+            bin * p.fitting.sampleRate / p.fftLength < crossFrequency)
+            ++bin;
+        firstBins.push_back(bin);
+    }
+    firstBins.push_back(bins_);
+}
+
+void SpectralCompressor::process(complex_signal_type frame) {
+    if (frame.size() != 2 * bins_)
+        return;
+    const auto x = frame.data();
+    for (int k = 0; k < bands(); ++k) {
+        double energy = 0;
+        for (int i = firstBins[k]; i < firstBins[k + 1]; ++i) {
+            // Bins other than DC and Nyquist stand for two.
+            const auto weight = i == 0 || i == nyquist ? 1 : 2;
+            energy += weight *
+                (double{x[2 * i]} * x[2 * i] +
+                    double{x[2 * i + 1]} * x[2 * i + 1]);
+        }
+        const auto gain = bandGains[k].next(
+            static_cast<real_type>(energy * powerScale)
+        );
+        for (int i = 2 * firstBins[k]; i < 2 * firstBins[k + 1]; ++i)
+            x[i] *= gain;
+    }
+}
+
+int SpectralCompressor::bins() const {
+    return bins_;
+}
+
+int SpectralCompressor::bands() const {
+    return gsl::narrow<int>(bandGains.size());
+}
+
+const std::vector<int> &SpectralCompressor::bandEdges() const {
+    return firstBins;
+}
+
+real_type SpectralCompressor::levelDecibels(int band) const {
+    return bandGains.at(band).levelDecibels();
+}
+
+std::vector<double> analysisWindow(
+    const std::string &type,
+    int length,
+    double exponent
+) {
+    const auto pi = std::acos(-1.);
+    std::vector<double> window(length);
+    for (int i = 0; i < length; ++i) {
+        const auto x = -1 + 2. * i / length;
+        double w;
+        if (type == "rect")
+            w = 1;
+        else if (type == "bartlett")
+            w = 1 - std::abs(x);
+        else if (type == "hanning")
+            w = 0.5 + 0.5 * std::cos(pi * x);
+        else if (type == "hamming")
+            w = 0.54 + 0.46 * std::cos(pi * x);
+        else if (type == "blackman")
+            w = 0.42 + 0.5 * std::cos(pi * x) + 0.08 * std::cos(2 * pi * x);
+        else
+            throw std::invalid_argument{"unknown window type " + type};
+        window[i] = std::pow(w, exponent);
+    }
+    return window;
+}
+}
@@ -0,0 +1,58 @@
+#include "StreamHost.h"
+#include <algorithm>
+
+namespace hearing_aid {
+StreamHost::StreamHost(const Parameters &p) :
+    pool{p.threads, p.cores} {}
+
+int StreamHost::add(
+    std::unique_ptr<SignalProcessor> processor,
+    duration_type deadline
+) {
+    streams_.push_back({std::move(processor), deadline, {}});
+    schedule.push_back(streams() - 1);
+    std::stable_sort(schedule.begin(), schedule.end(), [&](int a, int b) {
+        return streams_[a].deadline < streams_[b].deadline;
+    });
+    return streams() - 1;
+}
+
+void StreamHost::process(const std::vector<real_signal_type> &signals) {
+    if (signals.size() != streams_.size())
+        return;
+    const auto start = std::chrono::steady_clock::now();
+    next.store(0, std::memory_order_relaxed);
+    // One task per thread; each keeps taking the stream with the earliest
+    // deadline that nobody has started yet.
+    pool.run(pool.threads(), [&](int) { serve(signals, start); });
+}
+
+void StreamHost::serve(
+    const std::vector<real_signal_type> &signals,
+    std::chrono::steady_clock::time_point start
+) {
+    for (;;) {
+        const auto i = next.fetch_add(1, std::memory_order_relaxed);
+        if (i >= streams())
+            return;
+        auto &stream = streams_[schedule[i]];
+        stream.processor->process(signals[schedule[i]]);
+        const auto completion = std::chrono::duration_cast<duration_type>(
+            std::chrono::steady_clock::now() - start
+        );
+        auto &s = stream.statistics;
+        s.worstCompletion = std::max(s.worstCompletion, completion);
+        ++s.fragments;
+        if (completion > stream.deadline)
+            ++s.deadlineMisses;
+    }
+}
+
+StreamHost::Statistics StreamHost::statistics(int stream) const {
+    return streams_.at(stream).statistics;
+}
+
+int StreamHost::streams() const {
+    return static_cast<int>(streams_.size());
+}
+}
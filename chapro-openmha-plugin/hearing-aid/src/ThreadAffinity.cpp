@@ -0,0 +1,53 @@
+#include "ThreadAffinity.h"
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+namespace hearing_aid {
+#ifdef __linux__
+static bool pin(pthread_t thread, int core) {
+    if (core < 0 || core >= CPU_SETSIZE)
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return pthread_setaffinity_np(thread, sizeof set, &set) == 0;
+}
+
+bool pinToCore(std::thread &thread, int core) {
+    return pin(thread.native_handle(), core);
+}
+
+bool pinCurrentThreadToCore(int core) {
+    return pin(pthread_self(), core);
+}
+
+bool makeCurrentThreadRealtime(int priority) {
+    sched_param parameter{};
+    parameter.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameter) == 0;
+}
+
+bool lockMemory() {
+    return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+}
+#else
+bool pinToCore(std::thread &, int) {
+    return false;
+}
+
+bool pinCurrentThreadToCore(int) {
+    return false;
+}
+
+bool makeCurrentThreadRealtime(int) {
+    return false;
+}
+
+bool lockMemory() {
+    return false;
+}
+#endif
+}
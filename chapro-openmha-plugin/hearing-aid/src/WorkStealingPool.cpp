@@ -0,0 +1,98 @@
+#include "WorkStealingPool.h"
+#include "DenormalProtection.h"
+#include "ThreadAffinity.h"
+#include <gsl/gsl>
+#include <algorithm>
+
+namespace hearing_aid {
+WorkStealingPool::WorkStealingPool(
+    int threads,
+    const std::vector<int> &cores,
+    bool flushDenormals,
+    std::chrono::nanoseconds spin
+) :
+    shares{new Share[std::max(threads, 1)]},
+    parking{spin},
+    threads_{std::max(threads, 1)},
+    flushDenormals{flushDenormals}
+{
+    for (int i = 1; i < threads_; ++i) {
+        workers.emplace_back([this, i] { work(i); });
+        using size_type = std::vector<int>::size_type;
+        if (gsl::narrow<size_type>(i - 1) < cores.size())
+            pinToCore(workers.back(), cores[i - 1]);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    stopping.store(true, std::memory_order_release);
+    parking.notify();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+int WorkStealingPool::threads() const {
+    return threads_;
+}
+
+void WorkStealingPool::run(
+    int tasks,
+    void (*task_)(void *, int),
+    void *context_
+) {
+    if (threads_ == 1) {
+        for (int i = 0; i < tasks; ++i)
+            task_(context_, i);
+        return;
+    }
+    const auto helpers = threads_ - 1;
+    if (generation.load(std::memory_order_relaxed) > 0)
+        while (finished.load(std::memory_order_acquire) < helpers)
+            std::this_thread::yield();
+    task = task_;
+    context = context_;
+    for (int i = 0; i < threads_; ++i) {
+        shares[i].next.store(tasks * i / threads_, std::memory_order_relaxed);
+        shares[i].end = tasks * (i + 1) / threads_;
+    }
+    completed.store(0, std::memory_order_relaxed);
+    finished.store(0, std::memory_order_relaxed);
+    generation.fetch_add(1, std::memory_order_release);
+    parking.notify();
+    execute(0);
+    while (completed.load(std::memory_order_acquire) < tasks)
+        std::this_thread::yield();
+}
+
+void WorkStealingPool::work(int worker) {
+    const auto flush = flushDenormals ?
+        std::make_unique<FlushDenormalsToZero>() :
+        nullptr;
+    auto seen = 0;
+    for (;;) {
+        parking.wait([&] {
+            return stopping.load(std::memory_order_acquire) ||
+                generation.load(std::memory_order_acquire) != seen;
+        });
+        if (stopping.load(std::memory_order_acquire))
+            return;
+        seen = generation.load(std::memory_order_acquire);
+        execute(worker);
+        finished.fetch_add(1, std::memory_order_release);
+    }
+}
+
+// Drains the worker's own share, then steals from the others in turn.
+void WorkStealingPool::execute(int worker) {
+    for (int offset = 0; offset < threads_; ++offset) {
+        auto &share = shares[(worker + offset) % threads_];
+        for (;;) {
+            const auto i = share.next.fetch_add(1, std::memory_order_acq_rel);
+            if (i >= share.end)
+                break;
+            task(context, i);
+            completed.fetch_add(1, std::memory_order_release);
+        }
+    }
+}
+}
@@ -0,0 +1,113 @@
+#include <chapro-backend/ChaproSweep.h>
+#include <hearing-aid/FittingConfiguration.h>
+#include <hearing-aid/LatencyMeasurement.h>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Measures the latency of the CHAPRO pipeline for an openMHA
+// configuration (for example chapro.cfg) and prints it as JSON. The
+// algorithmic latency is the later of the impulse response's peak and
+// the largest band group delay; the total adds the fragment
+// contribution. With --max-latency-ms the exit status is 2 when the
+// total exceeds the limit, so the tool can gate configurations.
+namespace {
+using hearing_aid::HearingAidBuilder;
+
+std::string quoted(const std::string &s) {
+    std::string q{"\""};
+    for (auto c : s) {
+        if (c == '"' || c == '\\')
+            q += '\\';
+        q += c;
+    }
+    return q + '"';
+}
+
+double algorithmic(const hearing_aid::LatencyMeasurement::Result &r) {
+    double latency = r.peak;
+    for (const auto &band : r.bands)
+        latency = std::max(latency, band.groupDelay);
+    return latency;
+}
+
+double totalMilliseconds(
+    const HearingAidBuilder::Parameters &p,
+    const hearing_aid::LatencyMeasurement::Result &r
+) {
+    return 1e3 * (algorithmic(r) + r.fragment) / p.sampleRate;
+}
+
+void print(
+    const std::string &configuration,
+    const HearingAidBuilder::Parameters &p,
+    const hearing_aid::LatencyMeasurement::Result &r,
+    double limit
+) {
+    const auto milliseconds = [&](double samples) {
+        return 1e3 * samples / p.sampleRate;
+    };
+    std::cout << "{\n"
+        << "  \"configuration\": " << quoted(configuration) << ",\n"
+        << "  \"sampleRate\": " << p.sampleRate << ",\n"
+        << "  \"chunkSize\": " << p.chunkSize << ",\n"
+        << "  \"filterType\": " << quoted(p.filterType) << ",\n"
+        << "  \"onsetSamples\": " << r.onset << ",\n"
+        << "  \"peakSamples\": " << r.peak << ",\n"
+        << "  \"algorithmicSamples\": " << algorithmic(r) << ",\n"
+        << "  \"fragmentSamples\": " << r.fragment << ",\n"
+        << "  \"totalSamples\": " << algorithmic(r) + r.fragment << ",\n"
+        << "  \"totalMilliseconds\": " << totalMilliseconds(p, r) << ",\n"
+        << "  \"bands\": [";
+    for (std::size_t k = 0; k < r.bands.size(); ++k)
+        std::cout << (k ? ",\n" : "\n")
+            << "    {\"centerFrequency\": " << r.bands[k].centerFrequency
+            << ", \"groupDelaySamples\": " << r.bands[k].groupDelay
+            << ", \"groupDelayMilliseconds\": "
+            << milliseconds(r.bands[k].groupDelay) << "}";
+    std::cout << "\n  ]";
+    if (limit > 0)
+        std::cout << ",\n  \"maxLatencyMilliseconds\": " << limit
+            << ",\n  \"pass\": "
+            << (totalMilliseconds(p, r) <= limit ? "true" : "false");
+    std::cout << "\n}\n";
+}
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || argc % 2 != 0) {
+        std::cerr << "usage: latency-tool config.cfg [--level dB]"
+            " [--length samples] [--max-latency-ms ms]\n";
+        return 1;
+    }
+    hearing_aid::LatencyMeasurement::Parameters parameters{};
+    parameters.level = 65;
+    parameters.length = 16384;
+    double limit = 0;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        const std::string option{argv[i]};
+        if (option == "--level")
+            parameters.level = std::atof(argv[i + 1]);
+        else if (option == "--length")
+            parameters.length = std::atoi(argv[i + 1]);
+        else if (option == "--max-latency-ms")
+            limit = std::atof(argv[i + 1]);
+        else {
+            std::cerr << "unknown option: " << option << '\n';
+            return 1;
+        }
+    }
+    std::ifstream file{argv[1]};
+    if (!file) {
+        std::cerr << "cannot read " << argv[1] << '\n';
+        return 1;
+    }
+    const auto p = hearing_aid::readFitting(file);
+    ChaproSweepBackend backend;
+    hearing_aid::LatencyMeasurement measurement{&backend, parameters};
+    const auto result = measurement.measure(p);
+    print(argv[1], p, result, limit);
+    return limit > 0 && totalMilliseconds(p, result) > limit ? 2 : 0;
+}